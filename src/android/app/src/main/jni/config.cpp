@@ -131,6 +131,10 @@ void Config::ReadValues() {
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
+    ReadSetting("Core", Settings::values.parallel_cores);
+    ReadSetting("Core", Settings::values.rewind_interval);
+    ReadSetting("Core", Settings::values.rewind_buffer_size);
+    ReadSetting("Core", Settings::values.incremental_savestates);
 
     // Renderer
     Settings::values.use_gles = sdl2_config->GetBoolean("Renderer", "use_gles", true);
@@ -204,6 +208,8 @@ void Config::ReadValues() {
 
     // Data Storage
     ReadSetting("Data Storage", Settings::values.use_virtual_sd);
+    ReadSetting("Data Storage", Settings::values.romfs_cache_size);
+    ReadSetting("Data Storage", Settings::values.romfs_read_ahead);
 
     // System
     ReadSetting("System", Settings::values.is_new_3ds);
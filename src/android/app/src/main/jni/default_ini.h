@@ -97,6 +97,23 @@ use_cpu_jit =
 # Range is any positive integer (but we suspect 25 - 400 is a good idea) Default is 100
 cpu_clock_percentage =
 
+# Run the cores of the New 3DS on separate host threads. Experimental, only used with the JIT.
+# 0 (default): No, 1: Yes
+parallel_cores =
+
+# Amount of frames between the snapshots kept in memory for rewinding. Short intervals slow down
+# emulation, as every snapshot flushes the GPU caches.
+# 0 (default): Disabled, otherwise: Frames between snapshots
+rewind_interval =
+
+# Memory budget of the rewind snapshots in MiB, the oldest snapshots are dropped beyond it.
+# Default: 256
+rewind_buffer_size =
+
+# Save states after the first one of a slot only store the memory pages that changed since then.
+# 0 (default): No, 1: Yes
+incremental_savestates =
+
 [Renderer]
 # Whether to render using OpenGL
 # 1: OpenGL ES (default), 2: Vulkan
@@ -265,6 +282,14 @@ input_device =
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# Size of the cache of decrypted RomFS data in MiB, shared by the RomFS of the running title.
+# Default: 16
+romfs_cache_size =
+
+# Whether to read ahead the RomFS data following sequential reads on a background thread
+# 1 (default): Yes, 0: No
+romfs_read_ahead =
+
 [System]
 # The system model that Citra will try to emulate
 # 0: Old 3DS (default), 1: New 3DS
@@ -759,7 +759,10 @@ jobjectArray Java_org_citra_citra_1emu_NativeLibrary_getSavestateInfo(
 
 void Java_org_citra_citra_1emu_NativeLibrary_saveState([[maybe_unused]] JNIEnv* env,
                                                        [[maybe_unused]] jobject obj, jint slot) {
-    Core::System::GetInstance().SendSignal(Core::System::Signal::Save, slot);
+    const auto signal = Settings::values.incremental_savestates.GetValue()
+                            ? Core::System::Signal::SaveIncremental
+                            : Core::System::Signal::Save;
+    Core::System::GetInstance().SendSignal(signal, slot);
 }
 
 void Java_org_citra_citra_1emu_NativeLibrary_loadState([[maybe_unused]] JNIEnv* env,
@@ -2,7 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <cstring>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
@@ -13,9 +16,15 @@
 
 namespace AudioCore {
 
-DspInterface::DspInterface(Core::System& system_) : system(system_) {}
+DspInterface::DspInterface(Core::System& system_)
+    : system(system_), input_buffer(fifo.Capacity() * 2),
+      output_buffer(output_ring.Capacity() * 2) {}
 
-DspInterface::~DspInterface() = default;
+DspInterface::~DspInterface() {
+    sink.reset();
+    output_thread.request_stop();
+    output_event.Set();
+}
 
 void DspInterface::SetSink(AudioCore::SinkType sink_type, std::string_view audio_device) {
     // Dispose of the current sink first to avoid contention.
@@ -24,7 +33,14 @@ void DspInterface::SetSink(AudioCore::SinkType sink_type, std::string_view audio
     sink = AudioCore::GetSinkDetails(sink_type).create_sink(audio_device);
     sink->SetCallback(
         [this](s16* buffer, std::size_t num_frames) { OutputCallback(buffer, num_frames); });
-    time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
+    pending_sample_rate = sink->GetNativeSampleRate();
+
+    // Nothing is output without a sink, so the output thread waits for the first one
+    if (!output_thread.joinable()) {
+        output_thread =
+            std::jthread([this](std::stop_token stop_token) { OutputThread(stop_token); });
+    }
+    output_event.Set();
 }
 
 Sink& DspInterface::GetSink() {
@@ -36,12 +52,23 @@ void DspInterface::EnableStretching(bool enable) {
     enable_time_stretching = enable;
 }
 
+void DspInterface::SetEmulationSpeed(double speed) {
+    emulation_speed = speed;
+}
+
+Core::PerfStats::AudioCounters DspInterface::GetOutputCounters() const {
+    return {underrun_count.load(), overrun_count.load()};
+}
+
 void DspInterface::OutputFrame(StereoFrame16 frame) {
     if (!sink) {
         return;
     }
 
-    fifo.Push(frame.data(), frame.size());
+    if (fifo.Push(frame.data(), frame.size()) < frame.size()) {
+        ++overrun_count;
+    }
+    output_event.Set();
 
     auto video_dumper = system.GetVideoDumper();
     if (video_dumper && video_dumper->IsDumping()) {
@@ -54,7 +81,14 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
         return;
     }
 
-    fifo.Push(&sample, 1);
+    if (fifo.Push(&sample, 1) == 0) {
+        ++overrun_count;
+    }
+    // Samples come in one at a time, only wake the output thread once a frame's worth is ready
+    if (++samples_since_wakeup >= samples_per_frame) {
+        samples_since_wakeup = 0;
+        output_event.Set();
+    }
 
     auto video_dumper = system.GetVideoDumper();
     if (video_dumper && video_dumper->IsDumping()) {
@@ -62,33 +96,70 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
     }
 }
 
-void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
+void DspInterface::OutputThread(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("AudioOutput");
+    while (!stop_token.stop_requested()) {
+        // New samples wake the thread up, the timeout keeps the stretcher fed when they are slow
+        output_event.WaitFor(std::chrono::milliseconds(5));
+        ProcessOutput();
+    }
+}
+
+void DspInterface::ProcessOutput() {
+    if (const unsigned int sample_rate = pending_sample_rate.exchange(0)) {
+        time_stretcher.SetOutputSampleRate(sample_rate);
+    }
+
     // Determine if we should stretch based on the current emulation speed.
-    const auto perf_stats = system.GetLastPerfStats();
-    const auto should_stretch = enable_time_stretching && perf_stats.emulation_speed <= 95;
+    const auto should_stretch = enable_time_stretching && emulation_speed <= 95;
     if (performing_time_stretching && !should_stretch) {
         // If we just stopped stretching, flush the stretcher before returning to normal output.
-        flushing_time_stretcher = true;
+        time_stretcher.Flush();
+        const std::size_t free_frames = output_ring.Capacity() - output_ring.Size();
+        PushOutput(output_buffer.data(),
+                   time_stretcher.Process(nullptr, 0, output_buffer.data(), free_frames));
+
+        // Make sure any frames that did not fit are cleared from the time stretcher,
+        // so that they do not bleed into the next time the stretcher is enabled.
+        time_stretcher.Clear();
     }
     performing_time_stretching = should_stretch;
 
-    std::size_t frames_written = 0;
-    if (performing_time_stretching) {
-        const std::vector<s16> in{fifo.Pop()};
-        const std::size_t num_in{in.size() / 2};
-        frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
-    } else {
-        if (flushing_time_stretcher) {
-            time_stretcher.Flush();
-            frames_written = time_stretcher.Process(nullptr, 0, buffer, num_frames);
-            flushing_time_stretcher = false;
-
-            // Make sure any frames that did not fit are cleared from the time stretcher,
-            // so that they do not bleed into the next time the stretcher is enabled.
-            time_stretcher.Clear();
-        }
-        frames_written += fifo.Pop(buffer, num_frames - frames_written);
+    if (!performing_time_stretching) {
+        // Samples that do not fit are left behind, the fifo counts them when it overflows
+        const std::size_t free_frames = output_ring.Capacity() - output_ring.Size();
+        PushOutput(output_buffer.data(), fifo.Pop(output_buffer.data(), free_frames));
+        return;
+    }
+
+    // Keep two callbacks worth of stretched audio ready. The stretcher adapts its ratio to how
+    // many frames the DSP produced while the sink consumed the ones it is asked to replace.
+    const std::size_t target = std::min(2 * callback_frames.load(), output_ring.Capacity());
+    const std::size_t queued = output_ring.Size();
+    if (queued >= target) {
+        return;
+    }
+    const std::size_t num_in = fifo.Pop(input_buffer.data(), fifo.Capacity());
+    PushOutput(output_buffer.data(), time_stretcher.Process(input_buffer.data(), num_in,
+                                                            output_buffer.data(), target - queued));
+}
+
+void DspInterface::PushOutput(const s16* frames, std::size_t num_frames) {
+    if (output_ring.Push(frames, num_frames) < num_frames) {
+        ++overrun_count;
+    }
+}
+
+void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
+    callback_frames = num_frames;
+    const std::size_t frames_written = output_ring.Pop(buffer, num_frames);
+
+    // Count each time the output runs dry once, not every callback until samples come back
+    const bool starved = frames_written < num_frames;
+    if (starved && !output_starved) {
+        ++underrun_count;
     }
+    output_starved = starved;
 
     if (frames_written > 0) {
         std::memcpy(&last_frame[0], buffer + 2 * (frames_written - 1), 2 * sizeof(s16));
@@ -4,14 +4,19 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <span>
+#include <thread>
+#include <vector>
 #include <boost/serialization/access.hpp>
 #include "audio_core/audio_types.h"
 #include "audio_core/time_stretch.h"
 #include "common/common_types.h"
 #include "common/ring_buffer.h"
+#include "common/thread.h"
 #include "core/memory.h"
+#include "core/perf_stats.h"
 
 namespace Core {
 class System;
@@ -105,23 +110,53 @@ public:
     Sink& GetSink();
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
+    /// Sets the emulation speed in percent the decision to stretch audio is based on.
+    void SetEmulationSpeed(double speed);
+    /// Returns the number of underruns and overruns of the audio output so far.
+    Core::PerfStats::AudioCounters GetOutputCounters() const;
 
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
+    /// Fills the buffer of the sink with num_frames frames of output.
+    void OutputCallback(s16* buffer, std::size_t num_frames);
 
 private:
-    void FlushResidualStretcherAudio();
-    void OutputCallback(s16* buffer, std::size_t num_frames);
+    void OutputThread(std::stop_token stop_token);
+    void ProcessOutput();
+    void PushOutput(const s16* frames, std::size_t num_frames);
 
     Core::System& system;
 
+    /*
+     * Samples travel from the DSP to the sink through two single producer single consumer rings.
+     * The output thread moves them from the first to the second, time stretching them when
+     * needed, so that the audio callback only has to copy samples out of the second.
+     */
+    Common::RingBuffer<s16, 0x800, 2> fifo;
+    Common::RingBuffer<s16, 0x2000, 2> output_ring;
+    std::atomic<u64> underrun_count = 0;
+    std::atomic<u64> overrun_count = 0;
     std::atomic<bool> enable_time_stretching = false;
-    std::atomic<bool> performing_time_stretching = false;
-    std::atomic<bool> flushing_time_stretcher = false;
-    Common::RingBuffer<s16, 0x2000, 2> fifo;
-    std::array<s16, 2> last_frame{};
+    std::atomic<unsigned int> pending_sample_rate = 0;
+    std::atomic<double> emulation_speed = 0.0;
+
+    // Owned by the thread running the DSP
+    int samples_since_wakeup = 0;
+
+    // Owned by the output thread
+    bool performing_time_stretching = false;
     TimeStretcher time_stretcher;
+    std::vector<s16> input_buffer;
+    std::vector<s16> output_buffer;
+
+    // Written by the audio callback
+    std::atomic<std::size_t> callback_frames = 0;
+    bool output_starved = true;
+    std::array<s16, 2> last_frame{};
+
+    Common::Event output_event;
+    std::jthread output_thread;
     std::unique_ptr<Sink> sink;
 
     template <class Archive>
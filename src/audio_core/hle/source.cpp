@@ -8,6 +8,7 @@
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
+#include "audio_core/sample_kernels.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
@@ -25,17 +26,18 @@ SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
     return GetCurrentStatus();
 }
 
-void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
+void Source::MixInto(std::array<QuadFrame32, 3>& dest) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+    for (std::size_t mix = 0; mix < dest.size(); mix++) {
+        const std::array<float, 4>& gains = state.gain[mix];
+        // Most sources only feed the first mix, a silent mix would add nothing
+        if (std::ranges::all_of(gains, [](float gain) { return gain == 0.0f; })) {
+            continue;
+        }
         // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
+        Kernels::MixStereoIntoQuad(dest[mix], current_frame, gains);
     }
 }
 
@@ -193,19 +195,18 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
                 // TODO(xperia64): This may just work fine like PCM16, but I haven't tested and
                 // couldn't find any test case games
                 UNIMPLEMENTED_MSG("{} not handled for partial buffer updates", "PCM8");
-                // state.current_buffer = Codec::DecodePCM8(num_channels, memory, config.length);
+                // Codec::DecodePCM8(num_channels, memory, config.length, state.current_buffer);
                 break;
             case Format::PCM16:
-                state.current_buffer = Codec::DecodePCM16(num_channels, memory, config.length);
+                Codec::DecodePCM16(num_channels, memory, config.length, state.current_buffer);
                 valid = true;
                 break;
             case Format::ADPCM:
                 // TODO(xperia64): Are partial embedded buffer updates even valid for ADPCM? What
                 // about the adpcm state?
                 UNIMPLEMENTED_MSG("{} not handled for partial buffer updates", "ADPCM");
-                /* state.current_buffer =
-                    Codec::DecodeADPCM(memory, config.length, state.adpcm_coeffs,
-                   state.adpcm_state); */
+                /* Codec::DecodeADPCM(memory, config.length, state.adpcm_coeffs,
+                   state.adpcm_state, state.current_buffer); */
                 break;
             default:
                 UNIMPLEMENTED();
@@ -224,9 +225,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
                 if (state.current_buffer.size() < state.current_sample_number) {
                     state.current_sample_number = 0;
                 } else {
-                    state.current_buffer.erase(
-                        state.current_buffer.begin(),
-                        std::next(state.current_buffer.begin(), state.current_sample_number));
+                    state.current_buffer.Consume(state.current_sample_number);
                 }
             }
         }
@@ -349,9 +348,8 @@ void Source::GenerateFrame() {
                                 current_frame, frame_position);
             break;
         case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
+            AudioInterp::Polyphase(state.interp_state, state.current_buffer,
+                                   state.rate_multiplier, current_frame, frame_position);
             break;
         default:
             UNIMPLEMENTED();
@@ -387,15 +385,15 @@ bool Source::DequeueBuffer() {
         const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
         switch (buf.format) {
         case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
+            Codec::DecodePCM8(num_channels, memory, buf.length, state.current_buffer);
             break;
         case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
+            Codec::DecodePCM16(num_channels, memory, buf.length, state.current_buffer);
             break;
         case Format::ADPCM:
             DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
+            Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state,
+                               state.current_buffer);
             break;
         default:
             UNIMPLEMENTED();
@@ -423,9 +421,7 @@ bool Source::DequeueBuffer() {
 
     // Because our interpolation consumes samples instead of using an index,
     // let's just consume the samples up to the current sample number.
-    state.current_buffer.erase(
-        state.current_buffer.begin(),
-        std::next(state.current_buffer.begin(), state.current_sample_number));
+    state.current_buffer.Consume(state.current_sample_number);
 
     LOG_TRACE(Audio_DSP,
               "source_id={} buffer_id={} from_queue={} current_buffer.size()={}, "
@@ -7,7 +7,6 @@
 #include <array>
 #include <vector>
 #include <boost/serialization/array.hpp>
-#include <boost/serialization/deque.hpp>
 #include <boost/serialization/priority_queue.hpp>
 #include <boost/serialization/vector.hpp>
 #include <queue>
@@ -16,6 +15,7 @@
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/filter.h"
 #include "audio_core/interpolate.h"
+#include "audio_core/stereo_buffer.h"
 #include "common/common_types.h"
 
 namespace Memory {
@@ -57,12 +57,11 @@ public:
                               const s16_le (&adpcm_coeffs)[16]);
 
     /**
-     * Mix this source's output into dest, using the gains for the `intermediate_mix_id`-th
+     * Mix this source's output into each of the intermediate mixes, using the gains for that
      * intermediate mixer.
-     * @param dest The QuadFrame32 to mix into.
-     * @param intermediate_mix_id The id of the intermediate mix whose gains we are using.
+     * @param dest The QuadFrame32 of each intermediate mix to mix into.
      */
-    void MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const;
+    void MixInto(std::array<QuadFrame32, 3>& dest) const;
 
 private:
     const std::size_t source_id;
@@ -137,7 +136,7 @@ private:
 
         u32 current_sample_number = 0;
         PAddr current_buffer_physical_address = 0;
-        AudioInterp::StereoBuffer16 current_buffer = {};
+        StereoBuffer16 current_buffer = {};
 
         // buffer_id state
 
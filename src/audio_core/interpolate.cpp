@@ -3,19 +3,91 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <numbers>
 #include "audio_core/interpolate.h"
+#include "audio_core/sample_kernels.h"
 #include "common/assert.h"
 
 namespace AudioCore::AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
 // (This is not verified. This was chosen for minimal error.)
-constexpr u64 scale_factor = 1 << 24;
-constexpr u64 scale_mask = scale_factor - 1;
+constexpr s64 scale_factor = 1 << 24;
+
+/// Positions are relative to x[n-2], which follows the older history samples.
+constexpr s64 origin = StereoBuffer16::HistorySize - 2;
+
+/// Polyphase filter banks are designed for the highest rate of a bucket, the buckets are a quarter
+/// of an octave wide. Rates up to 1.0 share the first bucket, rates past the last are clamped.
+constexpr std::size_t num_rate_buckets = 13;
+
+using FilterBank = std::array<s16, Kernels::polyphase_taps * Kernels::polyphase_phases>;
+
+/// Designs a Blackman windowed sinc filter bank with the cutoff relative to the input Nyquist
+/// frequency.
+static std::unique_ptr<FilterBank> DesignFilterBank(double cutoff) {
+    constexpr std::size_t taps = Kernels::polyphase_taps;
+    constexpr double half_width = taps / 2;
+    constexpr double pi = std::numbers::pi;
+    constexpr s32 unity = 1 << 14;
+
+    auto bank = std::make_unique<FilterBank>();
+    for (std::size_t phase = 0; phase < Kernels::polyphase_phases; phase++) {
+        const double fraction = static_cast<double>(phase) / Kernels::polyphase_phases;
+        std::array<double, taps> response;
+        double sum = 0.0;
+        for (std::size_t j = 0; j < taps; j++) {
+            // Distance of the tap from the interpolated position
+            const double t = static_cast<double>(j) - (half_width - 1) - fraction;
+            const double x = cutoff * t;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+            const double window = 0.42 + 0.5 * std::cos(pi * t / half_width) +
+                                  0.08 * std::cos(2 * pi * t / half_width);
+            response[j] = sinc * window;
+            sum += response[j];
+        }
+
+        // Normalize to unity gain at DC, the rounding error goes to the largest tap
+        s16* coefficients = bank->data() + phase * taps;
+        s32 total = 0;
+        std::size_t largest = 0;
+        for (std::size_t j = 0; j < taps; j++) {
+            coefficients[j] = static_cast<s16>(std::lround(response[j] / sum * unity));
+            total += coefficients[j];
+            if (std::abs(coefficients[j]) > std::abs(coefficients[largest])) {
+                largest = j;
+            }
+        }
+        coefficients[largest] = static_cast<s16>(coefficients[largest] + unity - total);
+    }
+    return bank;
+}
+
+/// Returns the filter bank for a rate, designing it on first use.
+static const FilterBank& GetFilterBank(float rate) {
+    static std::array<std::unique_ptr<FilterBank>, num_rate_buckets> banks;
+    static std::mutex mutex;
+
+    const double octaves = rate > 1.0f ? std::log2(rate) : 0.0;
+    const std::size_t bucket =
+        std::min(static_cast<std::size_t>(std::ceil(octaves * 4)), num_rate_buckets - 1);
+
+    std::scoped_lock lock{mutex};
+    std::unique_ptr<FilterBank>& bank = banks[bucket];
+    if (!bank) {
+        bank = DesignFilterBank(std::exp2(-static_cast<double>(bucket) / 4));
+    }
+    return *bank;
+}
 
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
+/// fn produces the outputs for a run of positions, lookahead samples following each position are
+/// available to it. It is given positions relative to the oldest history sample.
+template <std::size_t lookahead, typename Function>
 static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
                             std::size_t& outputi, Function fn) {
     ASSERT(rate > 0);
@@ -23,54 +95,75 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    const auto samples = input.WithHistory(state.history);
+    const s64 input_size = static_cast<s64>(input.size());
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
-    u64 fposition = state.fposition;
-    std::size_t inputi = 0;
-
-    while (outputi < output.size()) {
-        inputi = static_cast<std::size_t>(fposition / scale_factor);
-
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
-            break;
-        }
-
-        u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+    s64 fposition = state.fposition;
+
+    // Every position before end has lookahead samples following it available
+    const s64 end = (input_size + 2 - static_cast<s64>(lookahead)) * scale_factor;
+    std::size_t count = output.size() - outputi;
+    if (fposition >= end) {
+        count = 0;
+    } else if (step_size != 0) {
+        const u64 distance = static_cast<u64>(end - fposition);
+        count = std::min<std::size_t>(count, (distance + step_size - 1) / step_size);
+    }
 
-        fposition += step_size;
+    fn(samples.data(), static_cast<u64>(fposition + origin * scale_factor), step_size,
+       output.data() + outputi, count);
+    outputi += count;
+
+    s64 inputi = 0;
+    if (outputi < output.size()) {
+        // We ran out of input
+        inputi = input_size;
+    } else if (count != 0) {
+        // Keep the samples of the last output as history
+        const s64 last = fposition + static_cast<s64>((count - 1) * step_size);
+        inputi = std::clamp<s64>(last / scale_factor, 0, input_size);
     }
+    fposition += static_cast<s64>(count * step_size);
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
+    std::copy_n(samples.begin() + inputi, state.history.size(), state.history.begin());
     state.fposition = fposition - inputi * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    input.Consume(static_cast<std::size_t>(inputi));
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    StepOverSamples<2>(state, input, rate, output, outputi,
+                       [](const StereoBuffer16::Sample* input, u64 fposition, u64 step,
+                          StereoBuffer16::Sample* output, std::size_t count) {
+                           for (std::size_t n = 0; n < count; n++) {
+                               output[n] = input[fposition / scale_factor];
+                               fposition += step;
+                           }
+                       });
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
-    // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
-                    });
+    StepOverSamples<2>(state, input, rate, output, outputi, Kernels::InterpolateLinear);
+}
+
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    constexpr std::size_t lookahead = Kernels::polyphase_taps / 2;
+    // A position waiting for input can be lookahead - 2 samples back, the filter reads
+    // polyphase_taps / 2 - 1 samples before it.
+    static_assert(lookahead - 2 + Kernels::polyphase_taps / 2 - 1 <= origin);
+
+    const s16* coefficients = GetFilterBank(rate).data();
+    StepOverSamples<lookahead>(state, input, rate, output, outputi,
+                               [coefficients](const StereoBuffer16::Sample* input, u64 fposition,
+                                              u64 step, StereoBuffer16::Sample* output,
+                                              std::size_t count) {
+                                   Kernels::InterpolatePolyphase(input, fposition, step, output,
+                                                                 count, coefficients);
+                               });
 }
 
 } // namespace AudioCore::AudioInterp
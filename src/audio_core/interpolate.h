@@ -5,21 +5,18 @@
 #pragma once
 
 #include <array>
-#include <deque>
 #include "audio_core/audio_types.h"
+#include "audio_core/stereo_buffer.h"
 #include "common/common_types.h"
 
 namespace AudioCore::AudioInterp {
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
-
 struct State {
-    /// Two historical samples.
-    std::array<s16, 2> xn1 = {}; ///< x[n-1]
-    std::array<s16, 2> xn2 = {}; ///< x[n-2]
-    /// Current fractional position.
-    u64 fposition = 0;
+    /// Historical samples, the last two are x[n-2] and x[n-1].
+    std::array<std::array<s16, 2>, StereoBuffer16::HistorySize> history = {};
+    /// Current fractional position, relative to x[n-2]. Polyphase reads further ahead than the
+    /// other modes, its position moves back into the history while it waits for more input.
+    s64 fposition = 0;
 };
 
 /**
@@ -46,4 +43,18 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi);
 
+/**
+ * Polyphase interpolation with a windowed sinc filter. Decimation lowers the cutoff of the filter
+ * to the new Nyquist frequency. There is a two-sample predelay, at a rate of 1.0 the input is
+ * passed through unchanged.
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi);
+
 } // namespace AudioCore::AudioInterp
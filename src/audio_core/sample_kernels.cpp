@@ -0,0 +1,692 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <utility>
+#include "audio_core/sample_kernels.h"
+#include "common/arch.h"
+
+#if CITRA_ARCH(x86_64)
+#include <smmintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+namespace AudioCore::Kernels {
+
+namespace {
+
+// Interpolation positions are fixed point with 24 fractional bits.
+constexpr u32 fraction_bits = 24;
+constexpr u64 fraction_mask = (u64{1} << fraction_bits) - 1;
+
+// Polyphase coefficients are fixed point with 14 fractional bits.
+constexpr u32 coefficient_bits = 14;
+constexpr u32 phase_shift = fraction_bits - std::countr_zero(polyphase_phases);
+static_assert(std::has_single_bit(polyphase_phases));
+
+s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+Sample AddAndClampToS16(const Sample& a, const Sample& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+s16 DecodePCM8Sample(u8 sample) {
+    return static_cast<s16>(static_cast<u16>(sample) << 8);
+}
+
+void ExpandPCM8Scalar(unsigned num_channels, const u8* data, Sample* out, std::size_t count) {
+    if (num_channels == 1) {
+        for (std::size_t i = 0; i < count; i++) {
+            out[i].fill(DecodePCM8Sample(data[i]));
+        }
+    } else {
+        for (std::size_t i = 0; i < count; i++) {
+            out[i][0] = DecodePCM8Sample(data[i * 2 + 0]);
+            out[i][1] = DecodePCM8Sample(data[i * 2 + 1]);
+        }
+    }
+}
+
+void ExpandPCM16MonoScalar(const u8* data, Sample* out, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        s16 sample;
+        std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
+        out[i].fill(sample);
+    }
+}
+
+Sample InterpolateLinearSample(u64 fraction, const Sample& x0, const Sample& x1) {
+    // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
+    // This is a saturated subtraction. (Verified by black-box fuzzing.)
+    s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+    s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+    return Sample{
+        static_cast<s16>(x0[0] + fraction * delta0 / (u64{1} << fraction_bits)),
+        static_cast<s16>(x0[1] + fraction * delta1 / (u64{1} << fraction_bits)),
+    };
+}
+
+void InterpolateLinearScalar(const Sample* input, u64 fposition, u64 step, Sample* output,
+                             std::size_t count) {
+    for (std::size_t n = 0; n < count; n++) {
+        const Sample* x = input + (fposition >> fraction_bits);
+        output[n] = InterpolateLinearSample(fposition & fraction_mask, x[0], x[1]);
+        fposition += step;
+    }
+}
+
+/// Returns the first input sample and the coefficients of a polyphase output.
+std::pair<const Sample*, const s16*> PolyphaseTaps(const Sample* input, u64 position,
+                                                   const s16* coefficients) {
+    const u64 phase = (position & fraction_mask) >> phase_shift;
+    return {input + (position >> fraction_bits) - (polyphase_taps / 2 - 1),
+            coefficients + phase * polyphase_taps};
+}
+
+s16 RoundPolyphaseSum(s32 sum) {
+    return ClampToS16((sum + (1 << (coefficient_bits - 1))) >> coefficient_bits);
+}
+
+void InterpolatePolyphaseScalar(const Sample* input, u64 fposition, u64 step, Sample* output,
+                                std::size_t count, const s16* coefficients) {
+    for (std::size_t n = 0; n < count; n++) {
+        const auto [x, c] = PolyphaseTaps(input, fposition, coefficients);
+        s32 left = 0;
+        s32 right = 0;
+        for (std::size_t j = 0; j < polyphase_taps; j++) {
+            left += x[j][0] * c[j];
+            right += x[j][1] * c[j];
+        }
+        output[n] = {RoundPolyphaseSum(left), RoundPolyphaseSum(right)};
+        fposition += step;
+    }
+}
+
+void MixStereoIntoQuadScalar(QuadFrame32& dest, const StereoFrame16& samples,
+                             const std::array<float, 4>& gains) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        dest[samplei][0] += static_cast<s32>(gains[0] * samples[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * samples[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * samples[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * samples[samplei][1]);
+    }
+}
+
+void DownmixStereoIntoScalar(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    std::transform(dest.begin(), dest.end(), samples.begin(), dest.begin(),
+                   [gain](const Sample& accumulator, const std::array<s32, 4>& sample) {
+                       s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+                       s16 right =
+                           ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+                       return AddAndClampToS16(accumulator, {left, right});
+                   });
+}
+
+void DownmixMonoIntoScalar(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    std::transform(dest.begin(), dest.end(), samples.begin(), dest.begin(),
+                   [gain](const Sample& accumulator, const std::array<s32, 4>& sample) {
+                       s16 mono = ClampToS16(static_cast<s32>(
+                           (gain * sample[0] + gain * sample[1] + gain * sample[2] +
+                            gain * sample[3]) /
+                           2));
+                       return AddAndClampToS16(accumulator, {mono, mono});
+                   });
+}
+
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+
+// The kernels below are written against a handful of 128-bit operations so the same code serves
+// both SSE4.1 and NEON. An integer vector holds four 32-bit or eight 16-bit lanes.
+#if CITRA_ARCH(x86_64)
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET __attribute__((target("sse4.1")))
+#else
+#define SIMD_TARGET
+#endif
+
+using VecI = __m128i;
+using VecF = __m128;
+
+SIMD_TARGET inline VecI Load(const void* src) {
+    return _mm_loadu_si128(static_cast<const __m128i*>(src));
+}
+
+SIMD_TARGET inline VecI Load64(const void* src) {
+    return _mm_loadl_epi64(static_cast<const __m128i*>(src));
+}
+
+SIMD_TARGET inline void Store(void* dest, VecI v) {
+    _mm_storeu_si128(static_cast<__m128i*>(dest), v);
+}
+
+SIMD_TARGET inline VecI SetLanes(u32 a, u32 b, u32 c, u32 d) {
+    return _mm_setr_epi32(static_cast<s32>(a), static_cast<s32>(b), static_cast<s32>(c),
+                          static_cast<s32>(d));
+}
+
+SIMD_TARGET inline VecI Splat(u32 value) {
+    return _mm_set1_epi32(static_cast<s32>(value));
+}
+
+SIMD_TARGET inline VecI And(VecI a, VecI b) {
+    return _mm_and_si128(a, b);
+}
+
+SIMD_TARGET inline VecI Add32(VecI a, VecI b) {
+    return _mm_add_epi32(a, b);
+}
+
+/// Multiplies the 32-bit lanes, keeping the low half of the products.
+SIMD_TARGET inline VecI Mul32(VecI a, VecI b) {
+    return _mm_mullo_epi32(a, b);
+}
+
+template <int shift>
+SIMD_TARGET inline VecI ShiftRight(VecI v) {
+    return _mm_srli_epi32(v, shift);
+}
+
+template <int shift>
+SIMD_TARGET inline VecI ShiftRightArithmetic(VecI v) {
+    return _mm_srai_epi32(v, shift);
+}
+
+/// Sign extends the four low 16-bit lanes to 32 bits.
+SIMD_TARGET inline VecI Widen16(VecI v) {
+    return _mm_cvtepi16_epi32(v);
+}
+
+/// Packs the 32-bit lanes of a then b to 16 bits with saturation.
+SIMD_TARGET inline VecI NarrowSaturate(VecI a, VecI b) {
+    return _mm_packs_epi32(a, b);
+}
+
+SIMD_TARGET inline VecI AddSaturate16(VecI a, VecI b) {
+    return _mm_adds_epi16(a, b);
+}
+
+SIMD_TARGET inline VecI SubSaturate16(VecI a, VecI b) {
+    return _mm_subs_epi16(a, b);
+}
+
+/// Interleaves the low eight bytes of a and b, starting with a.
+SIMD_TARGET inline VecI InterleaveLow8(VecI a, VecI b) {
+    return _mm_unpacklo_epi8(a, b);
+}
+
+/// Interleaves the high eight bytes of a and b, starting with a.
+SIMD_TARGET inline VecI InterleaveHigh8(VecI a, VecI b) {
+    return _mm_unpackhi_epi8(a, b);
+}
+
+/// Interleaves the four low 16-bit lanes of a and b, starting with a.
+SIMD_TARGET inline VecI InterleaveLow16(VecI a, VecI b) {
+    return _mm_unpacklo_epi16(a, b);
+}
+
+/// Interleaves the four high 16-bit lanes of a and b, starting with a.
+SIMD_TARGET inline VecI InterleaveHigh16(VecI a, VecI b) {
+    return _mm_unpackhi_epi16(a, b);
+}
+
+/// Returns the low halves of a and b concatenated.
+SIMD_TARGET inline VecI CombineLow(VecI a, VecI b) {
+    return _mm_unpacklo_epi64(a, b);
+}
+
+/// Moves the high half of v to the low half.
+SIMD_TARGET inline VecI HighHalf(VecI v) {
+    return _mm_unpackhi_epi64(v, v);
+}
+
+/// Swaps the two middle 32-bit lanes.
+SIMD_TARGET inline VecI SwapMiddle(VecI v) {
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+SIMD_TARGET inline VecF LoadFloat(const float* src) {
+    return _mm_loadu_ps(src);
+}
+
+SIMD_TARGET inline VecF SplatFloat(float value) {
+    return _mm_set1_ps(value);
+}
+
+SIMD_TARGET inline VecF ToFloat(VecI v) {
+    return _mm_cvtepi32_ps(v);
+}
+
+/// Converts to 32-bit integers, rounding towards zero.
+SIMD_TARGET inline VecI Truncate(VecF v) {
+    return _mm_cvttps_epi32(v);
+}
+
+SIMD_TARGET inline VecF Add(VecF a, VecF b) {
+    return _mm_add_ps(a, b);
+}
+
+SIMD_TARGET inline VecF Mul(VecF a, VecF b) {
+    return _mm_mul_ps(a, b);
+}
+
+/// Returns the low halves of a and b concatenated.
+SIMD_TARGET inline VecF CombineLow(VecF a, VecF b) {
+    return _mm_movelh_ps(a, b);
+}
+
+/// Returns the high halves of a and b concatenated.
+SIMD_TARGET inline VecF CombineHigh(VecF a, VecF b) {
+    return _mm_movehl_ps(b, a);
+}
+
+/// Swaps the low and high halves.
+SIMD_TARGET inline VecF SwapHalves(VecF v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+/// Transposes the 4x4 matrix whose rows are r0 to r3.
+SIMD_TARGET inline void Transpose(VecF& r0, VecF& r1, VecF& r2, VecF& r3) {
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+/// Returns the dot products of the left and right channels of x with c, as {left, right} twice.
+SIMD_TARGET inline VecI PolyphaseSum(const Sample* x, const s16* c) {
+    VecI sum = _mm_setzero_si128();
+    for (std::size_t j = 0; j < polyphase_taps; j += 4) {
+        // Pairs of samples of the same channel meet a pair of coefficients:
+        // {l0, l1, r0, r1, l2, l3, r2, r3} * {c0, c1, c0, c1, c2, c3, c2, c3}
+        VecI samples = Load(x + j);
+        samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+        samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+        const VecI coefficients = Load64(c + j);
+        sum = Add32(sum, _mm_madd_epi16(samples, _mm_unpacklo_epi32(coefficients, coefficients)));
+    }
+    return Add32(sum, HighHalf(sum));
+}
+
+#elif CITRA_ARCH(arm64)
+#define SIMD_TARGET
+
+using VecI = int32x4_t;
+using VecF = float32x4_t;
+
+inline VecI Load(const void* src) {
+    return vreinterpretq_s32_u8(vld1q_u8(static_cast<const u8*>(src)));
+}
+
+inline VecI Load64(const void* src) {
+    return vcombine_s32(vreinterpret_s32_u8(vld1_u8(static_cast<const u8*>(src))),
+                        vdup_n_s32(0));
+}
+
+inline void Store(void* dest, VecI v) {
+    vst1q_u8(static_cast<u8*>(dest), vreinterpretq_u8_s32(v));
+}
+
+inline VecI SetLanes(u32 a, u32 b, u32 c, u32 d) {
+    const std::array<u32, 4> lanes = {a, b, c, d};
+    return vreinterpretq_s32_u32(vld1q_u32(lanes.data()));
+}
+
+inline VecI Splat(u32 value) {
+    return vreinterpretq_s32_u32(vdupq_n_u32(value));
+}
+
+inline VecI And(VecI a, VecI b) {
+    return vandq_s32(a, b);
+}
+
+inline VecI Add32(VecI a, VecI b) {
+    return vaddq_s32(a, b);
+}
+
+/// Multiplies the 32-bit lanes, keeping the low half of the products.
+inline VecI Mul32(VecI a, VecI b) {
+    return vmulq_s32(a, b);
+}
+
+template <int shift>
+inline VecI ShiftRight(VecI v) {
+    return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(v), shift));
+}
+
+template <int shift>
+inline VecI ShiftRightArithmetic(VecI v) {
+    return vshrq_n_s32(v, shift);
+}
+
+/// Sign extends the four low 16-bit lanes to 32 bits.
+inline VecI Widen16(VecI v) {
+    return vmovl_s16(vget_low_s16(vreinterpretq_s16_s32(v)));
+}
+
+/// Packs the 32-bit lanes of a then b to 16 bits with saturation.
+inline VecI NarrowSaturate(VecI a, VecI b) {
+    return vreinterpretq_s32_s16(vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+}
+
+inline VecI AddSaturate16(VecI a, VecI b) {
+    return vreinterpretq_s32_s16(vqaddq_s16(vreinterpretq_s16_s32(a), vreinterpretq_s16_s32(b)));
+}
+
+inline VecI SubSaturate16(VecI a, VecI b) {
+    return vreinterpretq_s32_s16(vqsubq_s16(vreinterpretq_s16_s32(a), vreinterpretq_s16_s32(b)));
+}
+
+/// Interleaves the low eight bytes of a and b, starting with a.
+inline VecI InterleaveLow8(VecI a, VecI b) {
+    return vreinterpretq_s32_u8(vzip1q_u8(vreinterpretq_u8_s32(a), vreinterpretq_u8_s32(b)));
+}
+
+/// Interleaves the high eight bytes of a and b, starting with a.
+inline VecI InterleaveHigh8(VecI a, VecI b) {
+    return vreinterpretq_s32_u8(vzip2q_u8(vreinterpretq_u8_s32(a), vreinterpretq_u8_s32(b)));
+}
+
+/// Interleaves the four low 16-bit lanes of a and b, starting with a.
+inline VecI InterleaveLow16(VecI a, VecI b) {
+    return vreinterpretq_s32_s16(vzip1q_s16(vreinterpretq_s16_s32(a), vreinterpretq_s16_s32(b)));
+}
+
+/// Interleaves the four high 16-bit lanes of a and b, starting with a.
+inline VecI InterleaveHigh16(VecI a, VecI b) {
+    return vreinterpretq_s32_s16(vzip2q_s16(vreinterpretq_s16_s32(a), vreinterpretq_s16_s32(b)));
+}
+
+/// Returns the low halves of a and b concatenated.
+inline VecI CombineLow(VecI a, VecI b) {
+    return vcombine_s32(vget_low_s32(a), vget_low_s32(b));
+}
+
+/// Moves the high half of v to the low half.
+inline VecI HighHalf(VecI v) {
+    return vcombine_s32(vget_high_s32(v), vget_high_s32(v));
+}
+
+/// Swaps the two middle 32-bit lanes.
+inline VecI SwapMiddle(VecI v) {
+    const int32x2_t even = vget_low_s32(vuzp1q_s32(v, v));
+    const int32x2_t odd = vget_low_s32(vuzp2q_s32(v, v));
+    return vcombine_s32(even, odd);
+}
+
+inline VecF LoadFloat(const float* src) {
+    return vld1q_f32(src);
+}
+
+inline VecF SplatFloat(float value) {
+    return vdupq_n_f32(value);
+}
+
+inline VecF ToFloat(VecI v) {
+    return vcvtq_f32_s32(v);
+}
+
+/// Converts to 32-bit integers, rounding towards zero.
+inline VecI Truncate(VecF v) {
+    return vcvtq_s32_f32(v);
+}
+
+inline VecF Add(VecF a, VecF b) {
+    return vaddq_f32(a, b);
+}
+
+inline VecF Mul(VecF a, VecF b) {
+    return vmulq_f32(a, b);
+}
+
+/// Returns the low halves of a and b concatenated.
+inline VecF CombineLow(VecF a, VecF b) {
+    return vcombine_f32(vget_low_f32(a), vget_low_f32(b));
+}
+
+/// Returns the high halves of a and b concatenated.
+inline VecF CombineHigh(VecF a, VecF b) {
+    return vcombine_f32(vget_high_f32(a), vget_high_f32(b));
+}
+
+/// Swaps the low and high halves.
+inline VecF SwapHalves(VecF v) {
+    return vextq_f32(v, v, 2);
+}
+
+/// Transposes the 4x4 matrix whose rows are r0 to r3.
+inline void Transpose(VecF& r0, VecF& r1, VecF& r2, VecF& r3) {
+    const float32x4x2_t t01 = vtrnq_f32(r0, r1);
+    const float32x4x2_t t23 = vtrnq_f32(r2, r3);
+    r0 = CombineLow(t01.val[0], t23.val[0]);
+    r1 = CombineLow(t01.val[1], t23.val[1]);
+    r2 = CombineHigh(t01.val[0], t23.val[0]);
+    r3 = CombineHigh(t01.val[1], t23.val[1]);
+}
+
+/// Returns the dot products of the left and right channels of x with c, as {left, right} twice.
+inline VecI PolyphaseSum(const Sample* x, const s16* c) {
+    int32x4_t left = vdupq_n_s32(0);
+    int32x4_t right = vdupq_n_s32(0);
+    for (std::size_t j = 0; j < polyphase_taps; j += 8) {
+        const int16x8x2_t samples = vld2q_s16(x[j].data());
+        const int16x8_t coefficients = vld1q_s16(c + j);
+        left = vmlal_s16(left, vget_low_s16(samples.val[0]), vget_low_s16(coefficients));
+        left = vmlal_high_s16(left, samples.val[0], coefficients);
+        right = vmlal_s16(right, vget_low_s16(samples.val[1]), vget_low_s16(coefficients));
+        right = vmlal_high_s16(right, samples.val[1], coefficients);
+    }
+    const int32x4_t pairs = vpaddq_s32(left, right);
+    return vpaddq_s32(pairs, pairs);
+}
+#endif
+
+SIMD_TARGET void ExpandPCM8SIMD(unsigned num_channels, const u8* data, Sample* out,
+                                std::size_t count) {
+    // Placing each byte in the high half of a 16-bit lane converts it to PCM16.
+    const VecI zero = Splat(0);
+    std::size_t i = 0;
+    if (num_channels == 1) {
+        for (; i + 16 <= count; i += 16) {
+            const VecI bytes = Load(data + i);
+            const VecI low = InterleaveLow8(zero, bytes);
+            const VecI high = InterleaveHigh8(zero, bytes);
+            Store(out + i, InterleaveLow16(low, low));
+            Store(out + i + 4, InterleaveHigh16(low, low));
+            Store(out + i + 8, InterleaveLow16(high, high));
+            Store(out + i + 12, InterleaveHigh16(high, high));
+        }
+    } else {
+        for (; i + 8 <= count; i += 8) {
+            const VecI bytes = Load(data + i * 2);
+            Store(out + i, InterleaveLow8(zero, bytes));
+            Store(out + i + 4, InterleaveHigh8(zero, bytes));
+        }
+    }
+    ExpandPCM8Scalar(num_channels, data + i * num_channels, out + i, count - i);
+}
+
+SIMD_TARGET void ExpandPCM16MonoSIMD(const u8* data, Sample* out, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const VecI samples = Load(data + i * sizeof(s16));
+        Store(out + i, InterleaveLow16(samples, samples));
+        Store(out + i + 4, InterleaveHigh16(samples, samples));
+    }
+    ExpandPCM16MonoScalar(data + i * sizeof(s16), out + i, count - i);
+}
+
+/**
+ * Interpolates the outputs at two positions. The product of the 24-bit fraction and the 16-bit
+ * delta does not fit 32 bits, so the fraction is split in its high 16 and low 8 bits:
+ * (hi * delta + ((lo * delta) >> 8)) >> 16 rounds down exactly like (fraction * delta) >> 24.
+ */
+SIMD_TARGET inline VecI InterpolateLinearPair(const Sample* input, u64 position_a,
+                                              u64 position_b) {
+    // Lanes hold stereo samples: x0 of a, x0 of b, x1 of a, x1 of b
+    const VecI x = SwapMiddle(CombineLow(Load64(input + (position_a >> fraction_bits)),
+                                         Load64(input + (position_b >> fraction_bits))));
+    const VecI x0 = Widen16(x);
+    const VecI delta = Widen16(SubSaturate16(HighHalf(x), x));
+
+    const u32 fraction_a = static_cast<u32>(position_a & fraction_mask);
+    const u32 fraction_b = static_cast<u32>(position_b & fraction_mask);
+    const VecI fraction = SetLanes(fraction_a, fraction_a, fraction_b, fraction_b);
+    const VecI high = Mul32(ShiftRight<8>(fraction), delta);
+    const VecI low = Mul32(And(fraction, Splat(0xFF)), delta);
+    const VecI scaled = Add32(high, ShiftRightArithmetic<8>(low));
+    return Add32(x0, ShiftRightArithmetic<16>(scaled));
+}
+
+SIMD_TARGET void InterpolateLinearSIMD(const Sample* input, u64 fposition, u64 step,
+                                       Sample* output, std::size_t count) {
+    std::size_t n = 0;
+    for (; n + 4 <= count; n += 4) {
+        const VecI first = InterpolateLinearPair(input, fposition, fposition + step);
+        const VecI second =
+            InterpolateLinearPair(input, fposition + 2 * step, fposition + 3 * step);
+        // The results are within the range of the two input samples, the saturation is a no-op
+        Store(output + n, NarrowSaturate(first, second));
+        fposition += 4 * step;
+    }
+    InterpolateLinearScalar(input, fposition, step, output + n, count - n);
+}
+
+SIMD_TARGET inline VecI InterpolatePolyphasePair(const Sample* input, u64 position_a,
+                                                 u64 position_b, const s16* coefficients) {
+    const auto [x_a, c_a] = PolyphaseTaps(input, position_a, coefficients);
+    const auto [x_b, c_b] = PolyphaseTaps(input, position_b, coefficients);
+    const VecI sum = CombineLow(PolyphaseSum(x_a, c_a), PolyphaseSum(x_b, c_b));
+    return ShiftRightArithmetic<coefficient_bits>(
+        Add32(sum, Splat(1 << (coefficient_bits - 1))));
+}
+
+SIMD_TARGET void InterpolatePolyphaseSIMD(const Sample* input, u64 fposition, u64 step,
+                                          Sample* output, std::size_t count,
+                                          const s16* coefficients) {
+    std::size_t n = 0;
+    for (; n + 4 <= count; n += 4) {
+        const VecI first =
+            InterpolatePolyphasePair(input, fposition, fposition + step, coefficients);
+        const VecI second = InterpolatePolyphasePair(input, fposition + 2 * step,
+                                                     fposition + 3 * step, coefficients);
+        Store(output + n, NarrowSaturate(first, second));
+        fposition += 4 * step;
+    }
+    InterpolatePolyphaseScalar(input, fposition, step, output + n, count - n, coefficients);
+}
+
+SIMD_TARGET void MixStereoIntoQuadSIMD(QuadFrame32& dest, const StereoFrame16& samples,
+                                       const std::array<float, 4>& gains) {
+    static_assert(samples_per_frame % 2 == 0);
+    const VecF gain = LoadFloat(gains.data());
+    for (std::size_t i = 0; i < samples_per_frame; i += 2) {
+        const VecF pair = ToFloat(Widen16(Load64(&samples[i])));
+        const VecI first = Truncate(Mul(CombineLow(pair, pair), gain));
+        const VecI second = Truncate(Mul(CombineHigh(pair, pair), gain));
+        Store(&dest[i], Add32(Load(&dest[i]), first));
+        Store(&dest[i + 1], Add32(Load(&dest[i + 1]), second));
+    }
+}
+
+/// Returns the downmixed sample in the low half, as {0 + 2, 1 + 3} like the scalar sums.
+SIMD_TARGET inline VecF DownmixStereo(const std::array<s32, 4>& sample, VecF scale) {
+    const VecF scaled = Mul(ToFloat(Load(&sample)), scale);
+    return Add(scaled, SwapHalves(scaled));
+}
+
+SIMD_TARGET void DownmixStereoIntoSIMD(StereoFrame16& dest, const QuadFrame32& samples,
+                                       float gain) {
+    static_assert(samples_per_frame % 4 == 0);
+    const VecF scale = SplatFloat(gain);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const VecI first = Truncate(
+            CombineLow(DownmixStereo(samples[i], scale), DownmixStereo(samples[i + 1], scale)));
+        const VecI second = Truncate(CombineLow(DownmixStereo(samples[i + 2], scale),
+                                                DownmixStereo(samples[i + 3], scale)));
+        Store(&dest[i], AddSaturate16(Load(&dest[i]), NarrowSaturate(first, second)));
+    }
+}
+
+SIMD_TARGET void DownmixMonoIntoSIMD(StereoFrame16& dest, const QuadFrame32& samples,
+                                     float gain) {
+    static_assert(samples_per_frame % 4 == 0);
+    const VecF scale = SplatFloat(gain);
+    const VecF half = SplatFloat(0.5f);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        VecF c0 = Mul(ToFloat(Load(&samples[i])), scale);
+        VecF c1 = Mul(ToFloat(Load(&samples[i + 1])), scale);
+        VecF c2 = Mul(ToFloat(Load(&samples[i + 2])), scale);
+        VecF c3 = Mul(ToFloat(Load(&samples[i + 3])), scale);
+        // Each vector now holds one channel of the four samples, summed in the scalar order
+        Transpose(c0, c1, c2, c3);
+        const VecI mono = Truncate(Mul(Add(Add(Add(c0, c1), c2), c3), half));
+        const VecI narrow = NarrowSaturate(mono, mono);
+        Store(&dest[i], AddSaturate16(Load(&dest[i]), InterleaveLow16(narrow, narrow)));
+    }
+}
+
+#undef SIMD_TARGET
+
+bool HostSupportsSIMD() {
+#if CITRA_ARCH(x86_64)
+    static const bool supported = Common::GetCPUCaps().sse4_1;
+    return supported;
+#else
+    return true;
+#endif
+}
+
+#define DISPATCH(kernel, ...)                                                                      \
+    if (HostSupportsSIMD()) {                                                                      \
+        return kernel##SIMD(__VA_ARGS__);                                                          \
+    }                                                                                              \
+    return kernel##Scalar(__VA_ARGS__)
+
+#else
+
+#define DISPATCH(kernel, ...) return kernel##Scalar(__VA_ARGS__)
+
+#endif
+
+} // Anonymous namespace
+
+void ExpandPCM8(unsigned num_channels, const u8* data, Sample* out, std::size_t count) {
+    DISPATCH(ExpandPCM8, num_channels, data, out, count);
+}
+
+void ExpandPCM16Mono(const u8* data, Sample* out, std::size_t count) {
+    DISPATCH(ExpandPCM16Mono, data, out, count);
+}
+
+void InterpolateLinear(const Sample* input, u64 fposition, u64 step, Sample* output,
+                       std::size_t count) {
+    DISPATCH(InterpolateLinear, input, fposition, step, output, count);
+}
+
+void InterpolatePolyphase(const Sample* input, u64 fposition, u64 step, Sample* output,
+                          std::size_t count, const s16* coefficients) {
+    DISPATCH(InterpolatePolyphase, input, fposition, step, output, count, coefficients);
+}
+
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& samples,
+                       const std::array<float, 4>& gains) {
+    DISPATCH(MixStereoIntoQuad, dest, samples, gains);
+}
+
+void DownmixStereoInto(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    DISPATCH(DownmixStereoInto, dest, samples, gain);
+}
+
+void DownmixMonoInto(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    DISPATCH(DownmixMonoInto, dest, samples, gain);
+}
+
+#undef DISPATCH
+
+} // namespace AudioCore::Kernels
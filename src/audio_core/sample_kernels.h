@@ -0,0 +1,71 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "audio_core/audio_types.h"
+#include "common/common_types.h"
+
+/**
+ * Inner loops of the HLE DSP pipeline. They are vectorized with SSE4.1 or NEON when the host
+ * supports it and fall back to scalar code otherwise, both produce identical output.
+ */
+namespace AudioCore::Kernels {
+
+using Sample = std::array<s16, 2>;
+
+/// Number of input samples each polyphase output is computed from.
+constexpr std::size_t polyphase_taps = 16;
+
+/// Number of fractional positions a polyphase filter bank holds coefficients for.
+constexpr std::size_t polyphase_phases = 256;
+
+/**
+ * Converts mono or stereo PCM8 samples to stereo PCM16.
+ * @param num_channels Number of channels of the input, 1 or 2
+ * @param data Input samples, count * num_channels bytes long
+ * @param out The decoded samples, count in length
+ */
+void ExpandPCM8(unsigned num_channels, const u8* data, Sample* out, std::size_t count);
+
+/// Converts mono PCM16 samples to stereo by copying each to both channels.
+void ExpandPCM16Mono(const u8* data, Sample* out, std::size_t count);
+
+/**
+ * Linearly interpolates count output samples. Output n is read at position fposition + n * step
+ * of the input, in fixed point with 24 fractional bits. The input must hold the sample that
+ * follows each read position.
+ */
+void InterpolateLinear(const Sample* input, u64 fposition, u64 step, Sample* output,
+                       std::size_t count);
+
+/**
+ * Interpolates count output samples with a polyphase filter, at the same positions as
+ * InterpolateLinear. Each output is the dot product of polyphase_taps input samples, from
+ * polyphase_taps / 2 - 1 before its read position to polyphase_taps / 2 after it, with the
+ * coefficients of the phase its fraction falls in.
+ * @param coefficients polyphase_phases sets of polyphase_taps coefficients, fixed point with 14
+ * fractional bits
+ */
+void InterpolatePolyphase(const Sample* input, u64 fposition, u64 step, Sample* output,
+                          std::size_t count, const s16* coefficients);
+
+/**
+ * Adds a stereo frame to a quadraphonic frame, the channels of the destination receive
+ * {left, right, left, right} scaled by the respective gain.
+ */
+void MixStereoIntoQuad(QuadFrame32& dest, const StereoFrame16& samples,
+                       const std::array<float, 4>& gains);
+
+/// Scales a quadraphonic frame by gain, downmixes it to stereo and adds it to dest with
+/// saturation.
+void DownmixStereoInto(StereoFrame16& dest, const QuadFrame32& samples, float gain);
+
+/// Scales a quadraphonic frame by gain, downmixes it to mono and adds it to both channels of dest
+/// with saturation.
+void DownmixMonoInto(StereoFrame16& dest, const QuadFrame32& samples, float gain);
+
+} // namespace AudioCore::Kernels
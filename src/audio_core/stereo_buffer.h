@@ -0,0 +1,91 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * A variable length buffer of signed PCM16 stereo samples, consumed from the front.
+ * The samples are stored contiguously and consuming them only advances a read position, the
+ * storage is kept and reused by the next buffer assigned to it. A few slots are kept in front of
+ * the unread samples so that the interpolators can prepend their history without moving data.
+ */
+class StereoBuffer16 {
+public:
+    using Sample = std::array<s16, 2>;
+
+    /// Number of samples that can be placed in front of the unread ones.
+    static constexpr std::size_t HistorySize = 16;
+
+    bool empty() const {
+        return read_pos == samples.size();
+    }
+
+    std::size_t size() const {
+        return samples.size() - read_pos;
+    }
+
+    const Sample& operator[](std::size_t index) const {
+        return samples[read_pos + index];
+    }
+
+    const Sample* data() const {
+        return samples.data() + read_pos;
+    }
+
+    void clear() {
+        samples.resize(HistorySize);
+        read_pos = HistorySize;
+    }
+
+    /// Replaces the contents of the buffer with count samples, returned to be written to.
+    std::span<Sample> Assign(std::size_t count) {
+        samples.resize(HistorySize + count);
+        read_pos = HistorySize;
+        return {samples.data() + HistorySize, count};
+    }
+
+    /// Drops up to count samples from the front of the buffer.
+    void Consume(std::size_t count) {
+        read_pos += std::min(count, size());
+    }
+
+    /// Returns the unread samples preceded by the provided history samples.
+    std::span<const Sample> WithHistory(std::span<const Sample, HistorySize> history) {
+        std::ranges::copy(history, samples.begin() + read_pos - HistorySize);
+        return {samples.data() + read_pos - HistorySize, size() + HistorySize};
+    }
+
+private:
+    std::vector<Sample> samples = std::vector<Sample>(HistorySize);
+    std::size_t read_pos = HistorySize;
+
+    template <class Archive>
+    void save(Archive& ar, const unsigned int) const {
+        std::vector<Sample> unread(samples.begin() + read_pos, samples.end());
+        ar << unread;
+    }
+
+    template <class Archive>
+    void load(Archive& ar, const unsigned int) {
+        std::vector<Sample> unread;
+        ar >> unread;
+        std::ranges::copy(unread, Assign(unread.size()).begin());
+    }
+    friend class boost::serialization::access;
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+};
+
+} // namespace AudioCore
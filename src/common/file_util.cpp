@@ -404,6 +404,26 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+u64 GetModificationTime(const std::string& filename) {
+#ifdef ANDROID
+    // The storage access framework does not expose modification times
+    return 0;
+#else
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#else
+    if (stat(filename.c_str(), &buf) == 0)
+#endif
+    {
+        return static_cast<u64>(buf.st_mtime);
+    }
+
+    LOG_ERROR(Common_Filesystem, "Stat failed {}: {}", filename, GetLastErrorMsg());
+    return 0;
+#endif
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
@@ -2,7 +2,15 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
 #include <boost/regex.hpp>
 
 #include <fmt/format.h>
@@ -21,7 +29,7 @@
 #include <signal.h>
 #endif
 
-#include "common/bounded_threadsafe_queue.h"
+#include "common/alignment.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/literals.h"
@@ -36,8 +44,126 @@
 
 namespace Common::Log {
 
+namespace detail {
+std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> class_levels{};
+} // namespace detail
+
 namespace {
 
+/// Header of a log record, followed by the arguments of the message
+struct RecordHeader {
+    u32 size;             ///< Size of the whole record, including padding
+    Class log_class;
+    Level log_level;
+    u32 line_num;
+    const char* filename; ///< nullptr for the padding that skips the end of the ring
+    const char* function;
+    const char* format;
+    std::size_t format_size;
+    detail::RecordFormatter formatter;
+    std::chrono::steady_clock::time_point time;
+};
+
+/**
+ * Ring of log records written by a single thread and read by the logging thread. Records are
+ * never split at the end of the ring, the space left there is skipped instead.
+ */
+class LogRing {
+public:
+    static constexpr std::size_t Capacity = 256 * 1024;
+
+    /**
+     * Reserves space for a record. Must only be called by the owning thread.
+     * @return The space of the record, or nullptr if the ring is full
+     */
+    u8* Reserve(std::size_t size) {
+        const u64 write = write_pos.load(std::memory_order_relaxed);
+        const u64 read = read_pos.load(std::memory_order_acquire);
+        const std::size_t offset = static_cast<std::size_t>(write % Capacity);
+        const std::size_t contiguous = Capacity - offset;
+        const std::size_t needed = size > contiguous ? contiguous + size : size;
+        if (needed > Capacity - (write - read)) {
+            return nullptr;
+        }
+        commit_pos = write + needed;
+        if (size > contiguous) {
+            // A tail too small for a header is skipped by the reader without one
+            if (contiguous >= sizeof(RecordHeader)) {
+                auto* padding = new (data.get() + offset) RecordHeader{};
+                padding->size = static_cast<u32>(contiguous);
+            }
+            return data.get();
+        }
+        return data.get() + offset;
+    }
+
+    /**
+     * Publishes the last reserved record. Must only be called by the owning thread.
+     * @return Whether the ring is more than half full
+     */
+    bool Commit() {
+        write_pos.store(commit_pos, std::memory_order_release);
+        return commit_pos - read_pos.load(std::memory_order_relaxed) > Capacity / 2;
+    }
+
+    /**
+     * Calls func for every published record, up to the given amount. Must only be called by the
+     * logging thread.
+     * @return The number of records passed to func
+     */
+    template <typename Func>
+    std::size_t Drain(std::size_t max_records, Func&& func) {
+        std::size_t count = 0;
+        u64 read = read_pos.load(std::memory_order_relaxed);
+        const u64 write = write_pos.load(std::memory_order_acquire);
+        while (read < write && count < max_records) {
+            const std::size_t offset = static_cast<std::size_t>(read % Capacity);
+            if (Capacity - offset < sizeof(RecordHeader)) {
+                read += Capacity - offset;
+                read_pos.store(read, std::memory_order_release);
+                continue;
+            }
+            const auto& header = *reinterpret_cast<const RecordHeader*>(data.get() + offset);
+            if (header.filename) {
+                func(header);
+                count++;
+            }
+            read += header.size;
+            read_pos.store(read, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool Empty() const {
+        return read_pos.load(std::memory_order_relaxed) ==
+               write_pos.load(std::memory_order_acquire);
+    }
+
+    std::atomic<u64> dropped{};   ///< Records dropped because the ring was full
+    u64 reported_dropped = 0;     ///< Dropped records reported by the logging thread
+    std::atomic_bool closed{};    ///< Set once the owning thread exited
+    bool notify_on_commit = false; ///< Whether the logging thread should be woken up on commit
+
+private:
+    std::unique_ptr<u8[]> data{new u8[Capacity]};
+    alignas(64) std::atomic<u64> write_pos{};
+    alignas(64) std::atomic<u64> read_pos{};
+    u64 commit_pos = 0;
+};
+
+/// Gives up the ring of a thread when the thread exits, the logging thread frees it once drained
+struct ThreadRing {
+    ~ThreadRing() {
+        if (ring) {
+            ring->closed.store(true, std::memory_order_release);
+        }
+    }
+
+    std::shared_ptr<LogRing> ring;
+};
+
+thread_local ThreadRing thread_ring;
+
 /**
  * Interface for logging backends.
  */
@@ -233,6 +359,15 @@ public:
 
     void SetGlobalFilter(const Filter& f) {
         filter = f;
+        // Publish the minimum level of every class for the checks at the call sites
+        for (std::size_t i = 0; i < detail::class_levels.size(); i++) {
+            u8 level = 0;
+            while (level < static_cast<u8>(Level::Count) &&
+                   !filter.CheckMessage(static_cast<Class>(i), static_cast<Level>(level))) {
+                level++;
+            }
+            detail::class_levels[i].store(static_cast<Level>(level), std::memory_order_relaxed);
+        }
     }
 
     bool SetRegexFilter(const std::string& regex) {
@@ -252,23 +387,66 @@ public:
         color_console_backend.SetEnabled(enabled);
     }
 
-    void PushEntry(Class log_class, Level log_level, const char* filename, unsigned int line_num,
-                   const char* function, std::string message) {
-        if (!filter.CheckMessage(log_class, log_level)) {
-            return;
+    u8* BeginRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                    const char* function, fmt::string_view format,
+                    detail::RecordFormatter formatter, std::size_t args_size) {
+        const std::size_t size =
+            Common::AlignUp(sizeof(RecordHeader) + args_size, alignof(RecordHeader));
+        LogRing& ring = GetThreadRing();
+        u8* record = ring.Reserve(size);
+        if (!record && log_level >= Level::Error && size <= LogRing::Capacity &&
+            std::this_thread::get_id() != backend_thread_id.load(std::memory_order_relaxed)) {
+            // Errors are worth waiting for, as long as the logging thread is there to make room
+            while (!record && backend_running.load(std::memory_order_relaxed)) {
+                wake_cv.notify_one();
+                std::this_thread::yield();
+                record = ring.Reserve(size);
+            }
         }
-        Entry new_entry =
-            CreateEntry(log_class, log_level, filename, line_num, function, std::move(message));
-        if (!regex_filter.empty() &&
-            !boost::regex_search(FormatLogMessage(new_entry), regex_filter)) {
-            return;
+        if (!record) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            dropped_messages.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
         }
-        message_queue.EmplaceWait(new_entry);
+        new (record) RecordHeader{
+            .size = static_cast<u32>(size),
+            .log_class = log_class,
+            .log_level = log_level,
+            .line_num = line_num,
+            .filename = filename,
+            .function = function,
+            .format = format.data(),
+            .format_size = format.size(),
+            .formatter = formatter,
+            .time = std::chrono::steady_clock::now(),
+        };
+        ring.notify_on_commit = log_level >= Level::Error;
+        return record + sizeof(RecordHeader);
+    }
+
+    void CommitRecord() {
+        LogRing& ring = *thread_ring.ring;
+        // Wake the logging thread up early for errors and when the ring fills up
+        if (ring.Commit() || ring.notify_on_commit) {
+            wake_cv.notify_one();
+        }
+        // The first record after the logging thread went idle starts a new flush
+        if (!records_pending.load(std::memory_order_relaxed) && !records_pending.exchange(true)) {
+            WakeBackendThread();
+        }
+    }
+
+    LogStats GetStats() const {
+        return {
+            .written = written_messages.load(std::memory_order_relaxed),
+            .dropped = dropped_messages.load(std::memory_order_relaxed),
+        };
     }
 
 private:
     Impl(const std::string& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename} {
+        : file_backend{file_backend_filename} {
+        SetGlobalFilter(filter_);
 #ifdef CITRA_LINUX_GCC_BACKTRACE
         int waker_pipefd[2];
         int done_printing_pipefd[2];
@@ -286,6 +464,7 @@ private:
                 abort();
             }
             backend_thread.request_stop();
+            WakeBackendThread();
             backend_thread.join();
             const auto signal_entry =
                 CreateEntry(Class::Log, Level::Critical, "?", 0, "?",
@@ -332,29 +511,38 @@ private:
     }
 
     void StartBackendThread() {
+        backend_running = true;
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("citra:Log");
-            Entry entry;
-            const auto write_logs = [this, &entry]() {
-                ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
-            };
+            backend_thread_id.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            std::vector<std::shared_ptr<LogRing>> thread_rings;
             while (!stop_token.stop_requested()) {
-                message_queue.PopWait(entry, stop_token);
-                if (entry.filename != nullptr) {
-                    write_logs();
+                // Records committed from here on start the next flush
+                records_pending = false;
+                DrainRings(thread_rings, std::numeric_limits<std::size_t>::max());
+
+                std::unique_lock lock{wake_mutex};
+                if (records_pending) {
+                    // Pick the records up in batches, only errors wake the thread up early
+                    wake_cv.wait_for(lock, std::chrono::milliseconds(5));
+                } else {
+                    // Nothing is logged, sleep until a thread commits a record
+                    wake_cv.wait(lock, [&] {
+                        return records_pending.load() || stop_token.stop_requested();
+                    });
                 }
             }
-            // Drain the logging queue. Only writes out up to MAX_LOGS_TO_WRITE to prevent a
-            // case where a system is repeatedly spamming logs even on close.
-            int max_logs_to_write = filter.IsDebug() ? INT_MAX : 100;
-            while (max_logs_to_write-- && message_queue.TryPop(entry)) {
-                write_logs();
-            }
+            // Drain the logging rings. Only writes out up to 100 messages besides errors to
+            // prevent a case where a system is repeatedly spamming logs even on close.
+            DrainRings(thread_rings, filter.IsDebug() ? std::numeric_limits<std::size_t>::max()
+                                                      : 100);
+            backend_running = false;
         });
     }
 
     void StopBackendThread() {
         backend_thread.request_stop();
+        WakeBackendThread();
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
@@ -362,6 +550,94 @@ private:
         ForEachBackend([](Backend& backend) { backend.Flush(); });
     }
 
+    /// Wakes the logging thread up even if it is about to go idle
+    void WakeBackendThread() {
+        // Taking the mutex orders the notification after the idle check of the logging thread
+        {
+            std::scoped_lock lock{wake_mutex};
+        }
+        wake_cv.notify_one();
+    }
+
+    LogRing& GetThreadRing() {
+        if (!thread_ring.ring) {
+            thread_ring.ring = std::make_shared<LogRing>();
+            std::scoped_lock lock{rings_mutex};
+            rings.push_back(thread_ring.ring);
+        }
+        return *thread_ring.ring;
+    }
+
+    /**
+     * Writes the records of every thread to the backends.
+     * @param thread_rings The rings known to the logging thread, refreshed from the registered ones
+     * @param max_messages Maximum number of messages written, not counting errors
+     * @return The number of records written
+     */
+    std::size_t DrainRings(std::vector<std::shared_ptr<LogRing>>& thread_rings,
+                           std::size_t max_messages) {
+        {
+            std::scoped_lock lock{rings_mutex};
+            if (rings.size() != thread_rings.size()) {
+                thread_rings = rings;
+            }
+        }
+
+        std::size_t written = 0;
+        for (const auto& ring : thread_rings) {
+            ring->Drain(std::numeric_limits<std::size_t>::max(), [&](const RecordHeader& header) {
+                if (written < max_messages || header.log_level >= Level::Error) {
+                    WriteRecord(header);
+                    written++;
+                }
+            });
+
+            const u64 dropped = ring->dropped.load(std::memory_order_relaxed);
+            if (dropped != ring->reported_dropped) {
+                WriteEntry(CreateEntry(Class::Log, Level::Warning, __FILE__, __LINE__, __func__,
+                                       fmt::format("Dropped {} log messages, the log ring of "
+                                                   "the thread was full",
+                                                   dropped - ring->reported_dropped)));
+                ring->reported_dropped = dropped;
+            }
+        }
+
+        // Forget the rings of threads that exited once they are empty
+        const auto is_finished = [](const std::shared_ptr<LogRing>& ring) {
+            return ring->closed.load(std::memory_order_acquire) && ring->Empty();
+        };
+        if (std::any_of(thread_rings.begin(), thread_rings.end(), is_finished)) {
+            std::scoped_lock lock{rings_mutex};
+            std::erase_if(rings, is_finished);
+            thread_rings = rings;
+        }
+        return written;
+    }
+
+    void WriteRecord(const RecordHeader& header) {
+        const auto* args = reinterpret_cast<const u8*>(&header + 1);
+        std::string message;
+        try {
+            message = header.formatter({header.format, header.format_size}, args);
+        } catch (const fmt::format_error& e) {
+            message = fmt::format("Could not format log message \"{}\": {}",
+                                  std::string_view{header.format, header.format_size}, e.what());
+        }
+        Entry entry = CreateEntry(header.log_class, header.log_level, header.filename,
+                                  header.line_num, header.function, std::move(message));
+        entry.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(header.time -
+                                                                                time_origin);
+        WriteEntry(entry);
+    }
+
+    void WriteEntry(const Entry& entry) {
+        if (!regex_filter.empty() && !boost::regex_search(FormatLogMessage(entry), regex_filter)) {
+            return;
+        }
+        written_messages.fetch_add(1, std::memory_order_relaxed);
+        ForEachBackend([&entry](Backend& backend) { backend.Write(entry); });
+    }
+
     Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                       const char* function, std::string&& message) const {
         using std::chrono::duration_cast;
@@ -433,7 +709,16 @@ private:
     LogcatBackend lc_backend{};
 #endif
 
-    MPSCQueue<Entry> message_queue{};
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<LogRing>> rings; ///< Rings of every thread that logged something
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::atomic_bool records_pending{}; ///< Whether records were committed since the last drain
+    std::atomic_bool backend_running{};
+    std::atomic<std::thread::id> backend_thread_id;
+    std::atomic<u64> written_messages{};
+    std::atomic<u64> dropped_messages{};
+
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
 
@@ -474,12 +759,35 @@ void SetColorConsoleBackendEnabled(bool enabled) {
     Impl::Instance().SetColorConsoleBackendEnabled(enabled);
 }
 
+LogStats GetLogStats() {
+    return Impl::Instance().GetStats();
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, fmt::string_view format,
                        const fmt::format_args& args) {
     if (!initialization_in_progress_suppress_logging) {
-        Impl::Instance().PushEntry(log_class, log_level, filename, line_num, function,
-                                   fmt::vformat(format, args));
+        // The arguments cannot be copied into a record, format the message right away
+        detail::LogDeferred(log_class, log_level, filename, line_num, function, "{}",
+                            fmt::vformat(format, args));
+    }
+}
+
+namespace detail {
+
+u8* BeginRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                const char* function, fmt::string_view format, RecordFormatter formatter,
+                std::size_t args_size) {
+    if (initialization_in_progress_suppress_logging) {
+        return nullptr;
     }
+    return Impl::Instance().BeginRecord(log_class, log_level, filename, line_num, function, format,
+                                        formatter, args_size);
 }
+
+void CommitRecord() {
+    Impl::Instance().CommitRecord();
+}
+
+} // namespace detail
 } // namespace Common::Log
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string_view>
+#include "common/common_types.h"
 #include "common/logging/filter.h"
 
 namespace Common::Log {
@@ -33,4 +34,12 @@ void SetGlobalFilter(const Filter& filter);
 bool SetRegexFilter(const std::string& regex);
 
 void SetColorConsoleBackendEnabled(bool enabled);
+
+struct LogStats {
+    u64 written; ///< Messages written to the backends
+    u64 dropped; ///< Messages dropped because the log ring of their thread was full
+};
+
+/// Returns the number of messages written and dropped since the logger started.
+LogStats GetLogStats();
 } // namespace Common::Log
@@ -6,9 +6,11 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <string_view>
 
 #include "common/logging/formatter.h"
+#include "common/logging/log_record.h"
 #include "common/logging/types.h"
 
 namespace Common::Log {
@@ -22,6 +24,18 @@ constexpr const char* TrimSourcePath(std::string_view source) {
     return source.data() + idx;
 }
 
+namespace detail {
+/// Minimum level of each class, mirroring the global filter so that filtered messages are
+/// discarded at the call site before their arguments are even evaluated.
+extern std::array<std::atomic<Level>, static_cast<std::size_t>(Class::Count)> class_levels;
+} // namespace detail
+
+/// Returns whether messages of the given class and level pass the global filter
+inline bool IsEnabled(Class log_class, Level log_level) {
+    return log_level >= detail::class_levels[static_cast<std::size_t>(log_class)].load(
+                            std::memory_order_relaxed);
+}
+
 /// Logs a message to the global logger, using fmt
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, fmt::string_view format,
@@ -30,43 +44,38 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, fmt::format_string<Args...> format, const Args&... args) {
-    FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
-                      fmt::make_format_args(args...));
+    if constexpr ((detail::IsDeferrableArg<Args> && ...)) {
+        detail::LogDeferred(log_class, log_level, filename, line_num, function, format, args...);
+    } else {
+        FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
+                          fmt::make_format_args(args...));
+    }
 }
 
 } // namespace Common::Log
 
 // Define the fmt lib macros
 #define LOG_GENERIC(log_class, log_level, ...)                                                     \
-    Common::Log::FmtLogMessage(log_class, log_level, Common::Log::TrimSourcePath(__FILE__),        \
-                               __LINE__, __func__, __VA_ARGS__)
+    (Common::Log::IsEnabled(log_class, log_level)                                                  \
+         ? Common::Log::FmtLogMessage(log_class, log_level,                                        \
+                                      Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,   \
+                                      __VA_ARGS__)                                                 \
+         : void(0))
 
 #ifdef _DEBUG
 #define LOG_TRACE(log_class, ...)                                                                  \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Trace,           \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+    LOG_GENERIC(Common::Log::Class::log_class, Common::Log::Level::Trace, __VA_ARGS__)
 #else
 #define LOG_TRACE(log_class, fmt, ...) (void(0))
 #endif
 
 #define LOG_DEBUG(log_class, ...)                                                                  \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Debug,           \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+    LOG_GENERIC(Common::Log::Class::log_class, Common::Log::Level::Debug, __VA_ARGS__)
 #define LOG_INFO(log_class, ...)                                                                   \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Info,            \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+    LOG_GENERIC(Common::Log::Class::log_class, Common::Log::Level::Info, __VA_ARGS__)
 #define LOG_WARNING(log_class, ...)                                                                \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Warning,         \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+    LOG_GENERIC(Common::Log::Class::log_class, Common::Log::Level::Warning, __VA_ARGS__)
 #define LOG_ERROR(log_class, ...)                                                                  \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Error,           \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+    LOG_GENERIC(Common::Log::Class::log_class, Common::Log::Level::Error, __VA_ARGS__)
 #define LOG_CRITICAL(log_class, ...)                                                               \
-    Common::Log::FmtLogMessage(Common::Log::Class::log_class, Common::Log::Level::Critical,        \
-                               Common::Log::TrimSourcePath(__FILE__), __LINE__, __func__,          \
-                               __VA_ARGS__)
+    LOG_GENERIC(Common::Log::Class::log_class, Common::Log::Level::Critical, __VA_ARGS__)
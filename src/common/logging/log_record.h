@@ -0,0 +1,135 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <fmt/format.h>
+
+#include "common/logging/formatter.h"
+#include "common/logging/types.h"
+
+namespace Common::Log::detail {
+
+/*
+ * Log messages are not formatted by the thread logging them. Their arguments are copied into a
+ * binary record in a ring owned by the calling thread, and the logging thread formats the record
+ * with the function instantiated for the argument types. Arguments that may refer to memory the
+ * record does not own cannot be deferred, messages using them are formatted right away.
+ */
+
+/// Types that are stored as text in a record, and read back as a std::string_view
+template <typename T>
+constexpr bool IsStringArg =
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+    std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+/// Types that are copied as is into a record
+template <typename T>
+constexpr bool IsValueArg =
+    std::is_arithmetic_v<T> || std::is_enum_v<T> ||
+    (std::is_pointer_v<T> && !IsStringArg<T> && std::is_void_v<std::remove_pointer_t<T>>);
+
+template <typename T>
+constexpr bool IsDeferrableArg = IsStringArg<std::decay_t<T>> || IsValueArg<std::decay_t<T>>;
+
+template <typename T>
+using StoredArg =
+    std::conditional_t<IsStringArg<std::decay_t<T>>, std::string_view, std::decay_t<T>>;
+
+/// Formats the message of a record from the arguments that follow it
+using RecordFormatter = std::string (*)(fmt::string_view format, const u8* args);
+
+/**
+ * Reserves space for a record in the log ring of the calling thread.
+ * @return Where the arguments of the record have to be written, or nullptr if the message is
+ * dropped because the ring is full or logging is disabled.
+ */
+u8* BeginRecord(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                const char* function, fmt::string_view format, RecordFormatter formatter,
+                std::size_t args_size);
+
+/// Publishes the record reserved with BeginRecord to the logging thread.
+void CommitRecord();
+
+template <typename T>
+std::string_view ToStringView(const T& arg) {
+    if constexpr (std::is_array_v<T>) {
+        return std::string_view(arg);
+    } else if constexpr (std::is_pointer_v<T>) {
+        return arg ? std::string_view(arg) : std::string_view{};
+    } else {
+        return std::string_view(arg);
+    }
+}
+
+template <typename T>
+std::size_t ArgSize(const T& arg) {
+    if constexpr (IsStringArg<std::decay_t<T>>) {
+        return sizeof(u32) + ToStringView(arg).size();
+    } else {
+        return sizeof(T);
+    }
+}
+
+template <typename T>
+u8* WriteArg(u8* out, const T& arg) {
+    if constexpr (IsStringArg<std::decay_t<T>>) {
+        const std::string_view text = ToStringView(arg);
+        const auto size = static_cast<u32>(text.size());
+        std::memcpy(out, &size, sizeof(size));
+        std::memcpy(out + sizeof(size), text.data(), size);
+        return out + sizeof(size) + size;
+    } else {
+        std::memcpy(out, &arg, sizeof(T));
+        return out + sizeof(T);
+    }
+}
+
+template <typename T>
+T ReadArg(const u8*& in) {
+    if constexpr (std::is_same_v<T, std::string_view>) {
+        u32 size;
+        std::memcpy(&size, in, sizeof(size));
+        const std::string_view text(reinterpret_cast<const char*>(in + sizeof(size)), size);
+        in += sizeof(size) + size;
+        return text;
+    } else {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+}
+
+template <typename... Args>
+std::string FormatRecord(fmt::string_view format, const u8* args) {
+    // The arguments are read in order, braced initializers are evaluated left to right
+    const std::tuple<StoredArg<Args>...> values{ReadArg<StoredArg<Args>>(args)...};
+    return std::apply(
+        [format](const auto&... value) {
+            return fmt::vformat(format, fmt::make_format_args(value...));
+        },
+        values);
+}
+
+/// Copies a message into a record. The format string is not copied, it has to be a literal.
+template <typename... Args>
+void LogDeferred(Class log_class, Level log_level, const char* filename, unsigned int line_num,
+                 const char* function, fmt::string_view format, const Args&... args) {
+    const std::size_t args_size = (std::size_t{0} + ... + ArgSize(args));
+    u8* out = BeginRecord(log_class, log_level, filename, line_num, function, format,
+                          &FormatRecord<Args...>, args_size);
+    if (!out) {
+        return;
+    }
+    ((out = WriteArg(out, args)), ...);
+    CommitRecord();
+}
+
+} // namespace Common::Log::detail
@@ -83,6 +83,10 @@ void LogSettings() {
     LOG_INFO(Config, "Lemonade Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit.GetValue());
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage.GetValue());
+    log_setting("Core_ParallelCores", values.parallel_cores.GetValue());
+    log_setting("Core_RewindInterval", values.rewind_interval.GetValue());
+    log_setting("Core_RewindBufferSize", values.rewind_buffer_size.GetValue());
+    log_setting("Core_IncrementalSavestates", values.incremental_savestates.GetValue());
     log_setting("Renderer_UseGLES", values.use_gles.GetValue());
     log_setting("Renderer_GraphicsAPI", GetGraphicsAPIName(values.graphics_api.GetValue()));
     log_setting("Renderer_AsyncShaders", values.async_shader_compilation.GetValue());
@@ -134,6 +138,8 @@ void LogSettings() {
     log_setting("Camera_OuterLeftFlip", values.camera_flip[OuterLeftCamera]);
     log_setting("DataStorage_UseVirtualSd", values.use_virtual_sd.GetValue());
     log_setting("DataStorage_UseCustomStorage", values.use_custom_storage.GetValue());
+    log_setting("DataStorage_RomFSCacheSize", values.romfs_cache_size.GetValue());
+    log_setting("DataStorage_RomFSReadAhead", values.romfs_read_ahead.GetValue());
     if (values.use_custom_storage) {
         log_setting("DataStorage_SdmcDir", FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir));
         log_setting("DataStorage_NandDir", FileUtil::GetUserPath(FileUtil::UserPath::NANDDir));
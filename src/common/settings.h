@@ -432,11 +432,17 @@ struct Values {
     Setting<bool> use_cpu_jit{true, "use_cpu_jit"};
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
+    Setting<bool> parallel_cores{false, "parallel_cores"};
+    Setting<u32> rewind_interval{0, "rewind_interval"};
+    Setting<u32> rewind_buffer_size{256, "rewind_buffer_size"};
+    Setting<bool> incremental_savestates{false, "incremental_savestates"};
     SwitchableSetting<bool> lle_applets{false, "lle_applets"};
 
     // Data Storage
     Setting<bool> use_virtual_sd{true, "use_virtual_sd"};
     Setting<bool> use_custom_storage{false, "use_custom_storage"};
+    Setting<u32> romfs_cache_size{16, "romfs_cache_size"};
+    Setting<bool> romfs_read_ahead{true, "romfs_read_ahead"};
 
     // System
     SwitchableSetting<s32> region_value{REGION_VALUE_AUTO_SELECT, "region_value"};
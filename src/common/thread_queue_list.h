@@ -4,204 +4,202 @@
 
 #pragma once
 
-#include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
+#include "common/assert.h"
 #include "common/common_types.h"
 
 namespace Common {
 
 template <class T, unsigned int N>
-struct ThreadQueueList {
-    // TODO(yuriks): If performance proves to be a problem, the std::deques can be replaced with
-    //               (dynamically resizable) circular buffers to remove their overhead when
-    //               inserting and popping.
+class ThreadQueueList;
+
+/**
+ * Links of an element queued in a ThreadQueueList. Elements derive from this so that queueing them
+ * never allocates and removing them does not need to search the queue.
+ */
+template <class T>
+class ThreadQueueListNode {
+    template <class, unsigned int>
+    friend class ThreadQueueList;
+
+    T* prev = nullptr;
+    T* next = nullptr;
+    u32 priority = 0;
+    bool queued = false;
+};
 
+/**
+ * Ready queue with one intrusive doubly-linked list of elements per priority level and a bitmap of
+ * the non-empty levels, so that every operation is constant time. Lower levels have precedence.
+ */
+template <class T, unsigned int N>
+class ThreadQueueList {
+public:
     using Priority = unsigned int;
 
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
-
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    static_assert(NUM_QUEUES <= 64, "The priority bitmap holds at most 64 levels");
 
     // Only for debugging, returns priority level.
-    [[nodiscard]] Priority contains(const T& uid) const {
-        for (Priority i = 0; i < NUM_QUEUES; ++i) {
-            const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
-                return i;
-            }
-        }
-
-        return -1;
+    [[nodiscard]] Priority contains(const T* thread) const {
+        const auto& node = Node(thread);
+        return node.queued ? node.priority : -1;
     }
 
-    [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+    [[nodiscard]] T* get_first() const {
+        if (nonempty_mask == 0) {
+            return nullptr;
         }
-
-        return T();
+        return queues[std::countr_zero(nonempty_mask)].front;
     }
 
-    T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+    T* pop_first() {
+        T* thread = get_first();
+        if (thread) {
+            remove(thread);
         }
-
-        return T();
+        return thread;
     }
 
-    T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+    /// Pops the first element of a level strictly better than the given one, if any.
+    T* pop_first_better(Priority priority) {
+        const u64 better_mask = nonempty_mask & ((u64{1} << priority) - 1);
+        if (better_mask == 0) {
+            return nullptr;
         }
-
-        return T();
-    }
-
-    void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        T* thread = queues[std::countr_zero(better_mask)].front;
+        remove(thread);
+        return thread;
     }
 
-    void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+    void push_front(Priority priority, T* thread) {
+        auto& node = Link(priority, thread);
+        Queue& queue = queues[priority];
+        node.next = queue.front;
+        if (queue.front) {
+            Node(queue.front).prev = thread;
+        } else {
+            queue.back = thread;
+            nonempty_mask |= u64{1} << priority;
+        }
+        queue.front = thread;
     }
 
-    void move(const T& thread_id, Priority old_priority, Priority new_priority) {
-        remove(old_priority, thread_id);
-        prepare(new_priority);
-        push_back(new_priority, thread_id);
+    void push_back(Priority priority, T* thread) {
+        auto& node = Link(priority, thread);
+        Queue& queue = queues[priority];
+        node.prev = queue.back;
+        if (queue.back) {
+            Node(queue.back).next = thread;
+        } else {
+            queue.front = thread;
+            nonempty_mask |= u64{1} << priority;
+        }
+        queue.back = thread;
     }
 
-    void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+    /// Moves a queued element to the back of another level.
+    void move(T* thread, Priority new_priority) {
+        remove(thread);
+        push_back(new_priority, thread);
     }
 
-    void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+    /// Removes an element from the queue, does nothing if it is not queued.
+    void remove(T* thread) {
+        auto& node = Node(thread);
+        if (!node.queued) {
+            return;
         }
+        Queue& queue = queues[node.priority];
+        if (node.prev) {
+            Node(node.prev).next = node.next;
+        } else {
+            queue.front = node.next;
+        }
+        if (node.next) {
+            Node(node.next).prev = node.prev;
+        } else {
+            queue.back = node.prev;
+        }
+        if (!queue.front) {
+            nonempty_mask &= ~(u64{1} << node.priority);
+        }
+        node = {};
     }
 
     void clear() {
-        queues.fill(Queue());
-        first = nullptr;
+        while (T* thread = get_first()) {
+            remove(thread);
+        }
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        return (nonempty_mask & (u64{1} << priority)) == 0;
     }
 
 private:
     struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
+        T* front = nullptr;
+        T* back = nullptr;
     };
 
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
+    static ThreadQueueListNode<T>& Node(T* thread) {
+        return static_cast<ThreadQueueListNode<T>&>(*thread);
     }
 
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
-
-        cur->next_nonempty = first;
-        first = cur;
+    static const ThreadQueueListNode<T>& Node(const T* thread) {
+        return static_cast<const ThreadQueueListNode<T>&>(*thread);
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
-
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
-        } else {
-            return q - queues.data();
-        }
+    ThreadQueueListNode<T>& Link(Priority priority, T* thread) {
+        auto& node = Node(thread);
+        ASSERT_MSG(!node.queued, "Element is already queued");
+        node.queued = true;
+        node.priority = priority;
+        return node;
     }
 
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
-        } else {
-            return &queues[idx];
-        }
-    }
+    /// Bit i is set when the level i has queued elements
+    u64 nonempty_mask = 0;
+    std::array<Queue, NUM_QUEUES> queues{};
 
+    // The archive layout matches the previous deque based implementation, which also recorded the
+    // levels that had ever been used as a linked list of indices. Every level is reported as used,
+    // which the old layout treats the same way.
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
-        ar << idx;
+        const s64 first_idx = 0;
+        ar << first_idx;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
-            ar << idx1;
-            ar << queues[i].data;
+            const s64 next_idx = i + 1 < NUM_QUEUES ? static_cast<s64>(i + 1) : -2;
+            ar << next_idx;
+            std::deque<T*> data;
+            for (T* thread = queues[i].front; thread; thread = Node(thread).next) {
+                data.push_back(thread);
+            }
+            ar << data;
         }
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int file_version) {
+        nonempty_mask = 0;
+        queues = {};
         s64 idx;
         ar >> idx;
-        first = ToPointer(idx);
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
             ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            std::deque<T*> data;
+            ar >> data;
+            for (T* thread : data) {
+                push_back(static_cast<Priority>(i), thread);
+            }
         }
     }
 
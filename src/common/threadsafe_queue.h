@@ -186,4 +186,63 @@ private:
     SPSCQueue<T, with_stop_token> spsc_queue;
     std::mutex write_lock;
 };
+
+// a lock-free, unbounded,
+// single reader, multiple writer queue that is drained in batches
+template <typename T>
+class MPSCInbox {
+public:
+    MPSCInbox() = default;
+    ~MPSCInbox() {
+        PopAll([](T&&) {});
+    }
+
+    MPSCInbox(const MPSCInbox&) = delete;
+    MPSCInbox& operator=(const MPSCInbox&) = delete;
+
+    [[nodiscard]] bool Empty() const {
+        return head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    template <typename Arg>
+    void Push(Arg&& t) {
+        Node* node = new Node{std::forward<Arg>(t), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        }
+    }
+
+    // Removes every element pushed so far and passes them to func in push order.
+    // Must only be called from the reader thread.
+    template <typename Func>
+    void PopAll(Func&& func) {
+        if (Empty()) {
+            return;
+        }
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+        // Writers link new elements at the head, so reverse the list to restore push order.
+        Node* ordered = nullptr;
+        while (node) {
+            Node* next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+        while (ordered) {
+            Node* next = ordered->next;
+            func(std::move(ordered->value));
+            delete ordered;
+            ordered = next;
+        }
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{nullptr};
+};
 } // namespace Common
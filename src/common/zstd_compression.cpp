@@ -3,8 +3,10 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <zstd.h>
 
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/zstd_compression.h"
 
@@ -70,4 +72,224 @@ std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed) {
     return decompressed;
 }
 
+struct ZSTDOutputBuffer::Impl {
+    explicit Impl(FileUtil::IOFile& file_) : file{file_} {}
+    ~Impl() {
+        ZSTD_freeCCtx(context);
+    }
+
+    FileUtil::IOFile& file;
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    std::vector<u8> output = std::vector<u8>(ZSTD_CStreamOutSize());
+    bool failed = false;
+};
+
+ZSTDOutputBuffer::ZSTDOutputBuffer(FileUtil::IOFile& file, u32 num_threads,
+                                   s32 compression_level)
+    : impl{std::make_unique<Impl>(file)}, buffer(ZSTD_CStreamInSize() * 8) {
+    compression_level = std::clamp(compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+    ZSTD_CCtx_setParameter(impl->context, ZSTD_c_compressionLevel, compression_level);
+    if (num_threads > 0) {
+        const std::size_t result =
+            ZSTD_CCtx_setParameter(impl->context, ZSTD_c_nbWorkers, static_cast<int>(num_threads));
+        if (ZSTD_isError(result)) {
+            LOG_WARNING(Common, "ZSTD multithreaded compression is unavailable: {}",
+                        ZSTD_getErrorName(result));
+        }
+    }
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+ZSTDOutputBuffer::~ZSTDOutputBuffer() = default;
+
+bool ZSTDOutputBuffer::Finish() {
+    return FlushBuffer() && Compress({}, true);
+}
+
+ZSTDOutputBuffer::int_type ZSTDOutputBuffer::overflow(int_type ch) {
+    if (!FlushBuffer()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize ZSTDOutputBuffer::xsputn(const char_type* data, std::streamsize count) {
+    if (static_cast<std::size_t>(count) < buffer.size()) {
+        return std::streambuf::xsputn(data, count);
+    }
+
+    // Large writes, like the emulated memory, are handed to the compressor without a copy.
+    const std::span input{reinterpret_cast<const u8*>(data), static_cast<std::size_t>(count)};
+    if (!FlushBuffer() || !Compress(input, false)) {
+        return 0;
+    }
+    return count;
+}
+
+bool ZSTDOutputBuffer::FlushBuffer() {
+    const std::span input{reinterpret_cast<const u8*>(pbase()),
+                          static_cast<std::size_t>(pptr() - pbase())};
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return Compress(input, false);
+}
+
+bool ZSTDOutputBuffer::Compress(std::span<const u8> input, bool end_frame) {
+    if (impl->failed) {
+        return false;
+    }
+
+    ZSTD_inBuffer in{input.data(), input.size(), 0};
+    const ZSTD_EndDirective mode = end_frame ? ZSTD_e_end : ZSTD_e_continue;
+    while (true) {
+        ZSTD_outBuffer out{impl->output.data(), impl->output.size(), 0};
+        const std::size_t remaining = ZSTD_compressStream2(impl->context, &out, &in, mode);
+        if (ZSTD_isError(remaining)) {
+            LOG_ERROR(Common, "Error compressing ZSTD stream: {} ({})",
+                      ZSTD_getErrorName(remaining), remaining);
+            impl->failed = true;
+            return false;
+        }
+        if (out.pos > 0 && impl->file.WriteBytes(impl->output.data(), out.pos) != out.pos) {
+            LOG_ERROR(Common, "Error writing ZSTD stream");
+            impl->failed = true;
+            return false;
+        }
+        // Continuing only needs the input to be consumed, ending needs the frame to be flushed.
+        if (end_frame ? remaining == 0 : in.pos == in.size) {
+            return true;
+        }
+    }
+}
+
+struct ZSTDInputBuffer::Impl {
+    explicit Impl(FileUtil::IOFile& file_) : file{file_} {}
+    ~Impl() {
+        ZSTD_freeDCtx(context);
+    }
+
+    FileUtil::IOFile& file;
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    std::vector<u8> input = std::vector<u8>(ZSTD_DStreamInSize());
+    ZSTD_inBuffer in{input.data(), 0, 0};
+    bool end_of_file = false;
+};
+
+ZSTDInputBuffer::ZSTDInputBuffer(FileUtil::IOFile& file)
+    : impl{std::make_unique<Impl>(file)}, buffer(ZSTD_DStreamOutSize()) {
+    setg(buffer.data(), buffer.data(), buffer.data());
+}
+
+ZSTDInputBuffer::~ZSTDInputBuffer() = default;
+
+ZSTDInputBuffer::int_type ZSTDInputBuffer::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    const std::streamsize size = Decompress(buffer);
+    if (size <= 0) {
+        return traits_type::eof();
+    }
+    setg(buffer.data(), buffer.data(), buffer.data() + size);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize ZSTDInputBuffer::xsgetn(char_type* data, std::streamsize count) {
+    const std::streamsize buffered = std::min<std::streamsize>(count, egptr() - gptr());
+    std::memcpy(data, gptr(), static_cast<std::size_t>(buffered));
+    gbump(static_cast<int>(buffered));
+    if (buffered == count) {
+        return count;
+    }
+
+    const std::streamsize remaining = count - buffered;
+    if (static_cast<std::size_t>(remaining) < buffer.size()) {
+        return buffered + std::streambuf::xsgetn(data + buffered, remaining);
+    }
+
+    // Large reads are decompressed straight into the destination.
+    const std::streamsize size =
+        Decompress({data + buffered, static_cast<std::size_t>(remaining)});
+    return buffered + std::max<std::streamsize>(size, 0);
+}
+
+std::streamsize ZSTDInputBuffer::Decompress(std::span<char_type> output) {
+    ZSTD_outBuffer out{output.data(), output.size(), 0};
+    while (out.pos < out.size) {
+        if (impl->in.pos == impl->in.size) {
+            if (impl->end_of_file) {
+                break;
+            }
+            const std::size_t read = impl->file.ReadBytes(impl->input.data(), impl->input.size());
+            if (read == 0) {
+                impl->end_of_file = true;
+                break;
+            }
+            impl->in = ZSTD_inBuffer{impl->input.data(), read, 0};
+        }
+
+        const std::size_t result = ZSTD_decompressStream(impl->context, &out, &impl->in);
+        if (ZSTD_isError(result)) {
+            LOG_ERROR(Common, "Error decompressing ZSTD stream: {} ({})",
+                      ZSTD_getErrorName(result), result);
+            return -1;
+        }
+    }
+    return static_cast<std::streamsize>(out.pos);
+}
+
+struct ZSTDContext::Impl {
+    ~Impl() {
+        ZSTD_freeCCtx(compress_context);
+        ZSTD_freeDCtx(decompress_context);
+    }
+
+    ZSTD_CCtx* compress_context = ZSTD_createCCtx();
+    ZSTD_DCtx* decompress_context = ZSTD_createDCtx();
+    s32 compression_level{};
+    /// Scratch space sized for the worst case, so returned buffers don't waste capacity
+    std::vector<u8> scratch;
+};
+
+ZSTDContext::ZSTDContext(s32 compression_level) : impl{std::make_unique<Impl>()} {
+    impl->compression_level =
+        std::clamp(compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+}
+
+ZSTDContext::~ZSTDContext() = default;
+
+std::vector<u8> ZSTDContext::Compress(std::span<const u8> source) {
+    auto& scratch = impl->scratch;
+    scratch.resize(ZSTD_compressBound(source.size()));
+    const std::size_t compressed_size =
+        ZSTD_compressCCtx(impl->compress_context, scratch.data(), scratch.size(), source.data(),
+                          source.size(), impl->compression_level);
+    if (ZSTD_isError(compressed_size)) {
+        LOG_ERROR(Common, "Error compressing ZSTD data: {} ({})",
+                  ZSTD_getErrorName(compressed_size), compressed_size);
+        return {};
+    }
+    return std::vector<u8>(scratch.begin(), scratch.begin() + compressed_size);
+}
+
+bool ZSTDContext::Decompress(std::span<const u8> compressed, std::span<u8> destination) {
+    const std::size_t result =
+        ZSTD_decompressDCtx(impl->decompress_context, destination.data(), destination.size(),
+                            compressed.data(), compressed.size());
+    if (ZSTD_isError(result)) {
+        LOG_ERROR(Common, "Error decompressing ZSTD data: {} ({})", ZSTD_getErrorName(result),
+                  result);
+        return false;
+    }
+    if (result != destination.size()) {
+        LOG_ERROR(Common, "ZSTD decompression expected {} bytes, got {}", destination.size(),
+                  result);
+        return false;
+    }
+    return true;
+}
+
 } // namespace Common::Compression
@@ -4,11 +4,17 @@
 
 #pragma once
 
+#include <memory>
 #include <span>
+#include <streambuf>
 #include <vector>
 
 #include "common/common_types.h"
 
+namespace FileUtil {
+class IOFile;
+}
+
 namespace Common::Compression {
 
 /**
@@ -40,4 +46,79 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed);
 
+/**
+ * Stream buffer that compresses everything written to it into a single Zstandard frame and appends
+ * it to a file while it is being produced. Compression runs on worker threads when the Zstandard
+ * library was built with multithreading support, so writers mostly pay for a memory copy.
+ * Finish must be called once all data has been written.
+ */
+class ZSTDOutputBuffer final : public std::streambuf {
+public:
+    /**
+     * @param file the file the compressed frame is appended to.
+     * @param num_threads the number of compression workers, 0 compresses on the calling thread.
+     * @param compression_level the used compression level. Should be between 1 and 22, defaults
+     *                          to the Zstandard default level.
+     */
+    explicit ZSTDOutputBuffer(FileUtil::IOFile& file, u32 num_threads, s32 compression_level = 3);
+    ~ZSTDOutputBuffer() override;
+
+    /// Compresses any pending data and ends the frame. Returns false if any step failed.
+    [[nodiscard]] bool Finish();
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char_type* data, std::streamsize count) override;
+
+private:
+    bool Compress(std::span<const u8> input, bool end_frame);
+    bool FlushBuffer();
+
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    std::vector<char_type> buffer;
+};
+
+/**
+ * Stream buffer that reads and decompresses Zstandard frames from a file on demand, starting at the
+ * current position of the file. Frames without a recorded content size are supported.
+ */
+class ZSTDInputBuffer final : public std::streambuf {
+public:
+    explicit ZSTDInputBuffer(FileUtil::IOFile& file);
+    ~ZSTDInputBuffer() override;
+
+protected:
+    int_type underflow() override;
+    std::streamsize xsgetn(char_type* data, std::streamsize count) override;
+
+private:
+    /// Decompresses into the provided buffer, returns the amount of bytes written or -1 on error.
+    std::streamsize Decompress(std::span<char_type> output);
+
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    std::vector<char_type> buffer;
+};
+
+/**
+ * Compresses and decompresses many small independent buffers, reusing the same Zstandard contexts
+ * instead of allocating new ones for each call.
+ */
+class ZSTDContext {
+public:
+    explicit ZSTDContext(s32 compression_level);
+    ~ZSTDContext();
+
+    /// Compresses the source into a single frame, returns an empty vector on error.
+    [[nodiscard]] std::vector<u8> Compress(std::span<const u8> source);
+
+    /// Decompresses a frame into the destination, which must match the decompressed size exactly.
+    [[nodiscard]] bool Decompress(std::span<const u8> compressed, std::span<u8> destination);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
 } // namespace Common::Compression
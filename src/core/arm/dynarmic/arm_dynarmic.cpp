@@ -7,14 +7,17 @@
 #include <dynarmic/interface/optimization_flags.h>
 #include "common/assert.h"
 #include "common/microprofile.h"
+#include "common/scope_exit.h"
 #include "common/settings.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dynarmic/arm_dynarmic_cp15.h"
 #include "core/arm/dynarmic/arm_exclusive_monitor.h"
 #include "core/arm/dynarmic/arm_tick_counts.h"
+#include "core/arm/parallel_core_gate.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
 
@@ -23,46 +26,94 @@ namespace Core {
 class DynarmicUserCallbacks final : public Dynarmic::A32::UserCallbacks {
 public:
     explicit DynarmicUserCallbacks(ARM_Dynarmic& parent)
-        : parent(parent), svc_context(parent.system), memory(parent.memory) {}
+        : parent(parent), svc_context(parent.system), memory(parent.memory),
+          kernel(parent.system.Kernel()), gate(parent.system.GetParallelCoreGate()) {}
     ~DynarmicUserCallbacks() = default;
 
+    /**
+     * When cores run in parallel, the memory system and the HLE kernel only track a single current
+     * core and expect no guest code to run while they do. SVCs, MMIO and everything else that
+     * leaves the JIT for them therefore stops the other cores first and points the kernel at this
+     * core.
+     */
+    template <typename Func>
+    auto EnterKernel(Func&& func) {
+        if (!gate) {
+            return func();
+        }
+        const u32 core_id = parent.GetID();
+        gate->StopOthers(core_id);
+        SCOPE_EXIT({ gate->ResumeOthers(core_id); });
+        std::scoped_lock lock{kernel.GetHLELock()};
+        kernel.ActivateCPU(&parent);
+        return func();
+    }
+
+    /**
+     * Slow path accesses to RAM only need the memory system to use the page table of this core.
+     * The other cores cannot change page tables while this one is in guest code, so they keep
+     * running, and the HLE lock alone serializes the switch. Rasterizer cached pages are flushed
+     * under that lock as well. Anything else, like MMIO or unmapped pages, enters the kernel.
+     */
+    template <typename Func>
+    auto AccessMemory(VAddr vaddr, Func&& func) {
+        if (!gate) {
+            return func();
+        }
+        const auto type = parent.current_page_table->attributes[vaddr >> Memory::CITRA_PAGE_BITS];
+        if (type != Memory::PageType::Memory && type != Memory::PageType::RasterizerCachedMemory) {
+            return EnterKernel(func);
+        }
+        std::scoped_lock lock{kernel.GetHLELock()};
+        kernel.ActivateCPU(&parent);
+        return func();
+    }
+
     std::uint8_t MemoryRead8(VAddr vaddr) override {
-        return memory.Read8(vaddr);
+        return AccessMemory(vaddr, [&] { return memory.Read8(vaddr); });
     }
     std::uint16_t MemoryRead16(VAddr vaddr) override {
-        return memory.Read16(vaddr);
+        return AccessMemory(vaddr, [&] { return memory.Read16(vaddr); });
     }
     std::uint32_t MemoryRead32(VAddr vaddr) override {
-        return memory.Read32(vaddr);
+        return AccessMemory(vaddr, [&] { return memory.Read32(vaddr); });
     }
     std::uint64_t MemoryRead64(VAddr vaddr) override {
-        return memory.Read64(vaddr);
+        return AccessMemory(vaddr, [&] { return memory.Read64(vaddr); });
     }
 
     void MemoryWrite8(VAddr vaddr, std::uint8_t value) override {
-        memory.Write8(vaddr, value);
+        AccessMemory(vaddr, [&] { memory.Write8(vaddr, value); });
     }
     void MemoryWrite16(VAddr vaddr, std::uint16_t value) override {
-        memory.Write16(vaddr, value);
+        AccessMemory(vaddr, [&] { memory.Write16(vaddr, value); });
     }
     void MemoryWrite32(VAddr vaddr, std::uint32_t value) override {
-        memory.Write32(vaddr, value);
+        AccessMemory(vaddr, [&] { memory.Write32(vaddr, value); });
     }
     void MemoryWrite64(VAddr vaddr, std::uint64_t value) override {
-        memory.Write64(vaddr, value);
+        AccessMemory(vaddr, [&] { memory.Write64(vaddr, value); });
     }
 
     bool MemoryWriteExclusive8(u32 vaddr, u8 value, u8 expected) override {
-        return memory.WriteExclusive8(vaddr, value, expected);
+        return AccessMemory(vaddr, [&] {
+            return memory.WriteExclusive8(vaddr, value, expected);
+        });
     }
     bool MemoryWriteExclusive16(u32 vaddr, u16 value, u16 expected) override {
-        return memory.WriteExclusive16(vaddr, value, expected);
+        return AccessMemory(vaddr, [&] {
+            return memory.WriteExclusive16(vaddr, value, expected);
+        });
     }
     bool MemoryWriteExclusive32(u32 vaddr, u32 value, u32 expected) override {
-        return memory.WriteExclusive32(vaddr, value, expected);
+        return AccessMemory(vaddr, [&] {
+            return memory.WriteExclusive32(vaddr, value, expected);
+        });
     }
     bool MemoryWriteExclusive64(u32 vaddr, u64 value, u64 expected) override {
-        return memory.WriteExclusive64(vaddr, value, expected);
+        return AccessMemory(vaddr, [&] {
+            return memory.WriteExclusive64(vaddr, value, expected);
+        });
     }
 
     void InterpreterFallback(VAddr pc, std::size_t num_instructions) override {
@@ -72,7 +123,7 @@ public:
     }
 
     void CallSVC(std::uint32_t swi) override {
-        svc_context.CallSVC(swi);
+        EnterKernel([&] { svc_context.CallSVC(swi); });
     }
 
     void ExceptionRaised(VAddr pc, Dynarmic::A32::Exception exception) override {
@@ -81,14 +132,7 @@ public:
         case Dynarmic::A32::Exception::UnpredictableInstruction:
         case Dynarmic::A32::Exception::DecodeError:
         case Dynarmic::A32::Exception::NoExecuteFault:
-            break;
         case Dynarmic::A32::Exception::Breakpoint:
-            if (GDBStub::IsConnected()) {
-                parent.jit->HaltExecution();
-                parent.SetPC(pc);
-                parent.ServeBreak();
-                return;
-            }
             break;
         case Dynarmic::A32::Exception::SendEvent:
         case Dynarmic::A32::Exception::SendEventLocal:
@@ -100,11 +144,20 @@ public:
         case Dynarmic::A32::Exception::PreloadInstruction:
             return;
         }
-        for (int i = 0; i < 16; i++) {
-            LOG_CRITICAL(Debug, "r{:02d} = {:08X}", i, parent.GetReg(i));
-        }
-        ASSERT_MSG(false, "ExceptionRaised(exception = {}, pc = {:08X}, code = {:08X})", exception,
-                   pc, MemoryReadCode(pc).value());
+        // The debugger and the memory reads below expect the other cores to be stopped
+        EnterKernel([&] {
+            if (exception == Dynarmic::A32::Exception::Breakpoint && GDBStub::IsConnected()) {
+                parent.jit->HaltExecution();
+                parent.SetPC(pc);
+                parent.ServeBreak();
+                return;
+            }
+            for (int i = 0; i < 16; i++) {
+                LOG_CRITICAL(Debug, "r{:02d} = {:08X}", i, parent.GetReg(i));
+            }
+            ASSERT_MSG(false, "ExceptionRaised(exception = {}, pc = {:08X}, code = {:08X})",
+                       exception, pc, memory.Read32(pc));
+        });
     }
 
     void AddTicks(std::uint64_t ticks) override {
@@ -122,6 +175,8 @@ public:
     ARM_Dynarmic& parent;
     Kernel::SVCContext svc_context;
     Memory::MemorySystem& memory;
+    Kernel::KernelSystem& kernel;
+    ParallelCoreGate* const gate;
 };
 
 ARM_Dynarmic::ARM_Dynarmic(Core::System& system_, u32 core_id_,
@@ -138,12 +193,18 @@ ARM_Dynarmic::~ARM_Dynarmic() = default;
 MICROPROFILE_DEFINE(ARM_Jit, "ARM JIT", "ARM JIT", MP_RGB(255, 64, 64));
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    // Parallel cores only point the memory system at their page table while holding the HLE lock.
+    ASSERT(system.IsParallelCoresEnabled() ||
+           memory.GetCurrentPageTable() == current_page_table);
     MICROPROFILE_SCOPE(ARM_Jit);
 
     jit->Run();
 }
 
+void ARM_Dynarmic::HaltExecution() {
+    jit->HaltExecution();
+}
+
 void ARM_Dynarmic::Step() {
     jit->Step();
 
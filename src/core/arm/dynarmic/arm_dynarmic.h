@@ -51,6 +51,9 @@ public:
 
     void PrepareReschedule() override;
 
+    /// Makes Run return as soon as possible, may be called from any thread.
+    void HaltExecution();
+
     void ClearInstructionCache() override;
     void InvalidateCacheRange(u32 start_address, std::size_t length) override;
     void ClearExclusiveState() override;
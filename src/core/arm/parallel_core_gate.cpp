@@ -0,0 +1,56 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+#include "core/arm/parallel_core_gate.h"
+
+namespace Core {
+
+ParallelCoreGate::ParallelCoreGate(std::function<void(u32)> halt_core_)
+    : halt_core{std::move(halt_core_)} {}
+
+ParallelCoreGate::~ParallelCoreGate() = default;
+
+void ParallelCoreGate::EnterGuest(u32 core_id) {
+    std::unique_lock lock{mutex};
+    cv.wait(lock, [this] { return !stopped; });
+    in_guest[core_id] = true;
+    ++running;
+}
+
+bool ParallelCoreGate::LeaveGuest(u32 core_id) {
+    std::scoped_lock lock{mutex};
+    in_guest[core_id] = false;
+    --running;
+    cv.notify_all();
+    return std::exchange(halted[core_id], false);
+}
+
+void ParallelCoreGate::StopOthers(u32 core_id) {
+    std::unique_lock lock{mutex};
+    // While waiting for its turn, this core counts as stopped for whoever stops the others first.
+    in_guest[core_id] = false;
+    --running;
+    cv.notify_all();
+    cv.wait(lock, [this] { return !stopped; });
+
+    stopped = true;
+    for (u32 core = 0; core < MaxCores; ++core) {
+        if (in_guest[core]) {
+            halted[core] = true;
+            halt_core(core);
+        }
+    }
+    cv.wait(lock, [this] { return running == 0; });
+}
+
+void ParallelCoreGate::ResumeOthers(u32 core_id) {
+    std::scoped_lock lock{mutex};
+    stopped = false;
+    in_guest[core_id] = true;
+    ++running;
+    cv.notify_all();
+}
+
+} // namespace Core
@@ -0,0 +1,54 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include "common/common_types.h"
+
+namespace Core {
+
+/**
+ * Coordinates cores that run guest code on separate host threads. The HLE kernel, the services
+ * and the memory system expect to be alone with the guest, so a core that leaves the JIT for them
+ * first stops all other cores. Those resume the rest of their slice once it is done.
+ */
+class ParallelCoreGate {
+public:
+    static constexpr u32 MaxCores = 4;
+
+    /// halt_core makes the guest code of a core return soon, it is called from other threads.
+    explicit ParallelCoreGate(std::function<void(u32 core_id)> halt_core);
+    ~ParallelCoreGate();
+
+    /// Called by a core before running guest code, waits while another core has stopped it.
+    void EnterGuest(u32 core_id);
+
+    /**
+     * Called by a core after its guest code returned.
+     * @returns Whether another core halted it, in which case its slice is not over yet.
+     */
+    bool LeaveGuest(u32 core_id);
+
+    /// Called from the guest code of a core, returns once every other core is out of guest code.
+    void StopOthers(u32 core_id);
+
+    /// Undoes StopOthers and returns to the guest code of the calling core.
+    void ResumeOthers(u32 core_id);
+
+private:
+    std::function<void(u32)> halt_core;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::array<bool, MaxCores> in_guest{};
+    std::array<bool, MaxCores> halted{};
+    u32 running = 0;
+    bool stopped = false;
+};
+
+} // namespace Core
@@ -10,9 +10,11 @@
 #include "audio_core/lle/lle.h"
 #include "common/arch.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "common/settings.h"
 #include "core/arm/arm_interface.h"
 #include "core/arm/exclusive_monitor.h"
+#include "core/arm/parallel_core_gate.h"
 #include "core/hle/service/cam/cam.h"
 #include "core/hle/service/hid/hid.h"
 #include "core/hle/service/ir/ir_user.h"
@@ -47,6 +49,8 @@
 #ifdef ENABLE_SCRIPTING
 #include "core/rpc/server.h"
 #endif
+#include "core/rewind_buffer.h"
+#include "core/savestate.h"
 #include "network/network.h"
 #include "video_core/custom_textures/custom_tex_manager.h"
 #include "video_core/gpu.h"
@@ -106,11 +110,27 @@ System::ResultStatus System::RunLoop() {
         frame_limiter.WaitOnce();
         return ResultStatus::Success;
     }
-    case Signal::Save: {
+    case Signal::Rewind: {
+        const u32 steps = param;
+        try {
+            if (!System::LoadStateFromMemory(steps)) {
+                LOG_WARNING(Core, "No rewind snapshot available");
+                return ResultStatus::Success;
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR(Core, "Error rewinding: {}", e.what());
+            status_details = e.what();
+            return ResultStatus::ErrorSavestate;
+        }
+        frame_limiter.WaitOnce();
+        return ResultStatus::Success;
+    }
+    case Signal::Save:
+    case Signal::SaveIncremental: {
         const u32 slot = param;
         LOG_INFO(Core, "Begin save to slot {}", slot);
         try {
-            System::SaveState(slot);
+            System::SaveState(slot, signal == Signal::SaveIncremental);
             LOG_INFO(Core, "Save completed");
         } catch (const std::exception& e) {
             LOG_ERROR(Core, "Error saving: {}", e.what());
@@ -124,6 +144,8 @@ System::ResultStatus System::RunLoop() {
         break;
     }
 
+    UpdateRewindBuffer();
+
     return Settings::values.is_new_3ds ? RunLoopMultiCores() : RunLoopSingleCore();
 }
 
@@ -175,6 +197,31 @@ System::ResultStatus System::RunLoopMultiCores() {
             kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
             max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
         }
+        if (parallel_cores) {
+            // Every core gets the same slice, the ones that end up behind are synced up by the
+            // delay handling above on the next iteration.
+            for (auto& cpu_core : cpu_cores) {
+                cpu_core->GetTimer().SetNextSlice(max_slice);
+                kernel->SetRunningCPU(cpu_core.get());
+                // If we don't have a currently active thread then don't execute instructions,
+                // instead advance to the next event and try to yield to the next thread
+                const bool idle = kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr;
+                if (idle) {
+                    LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+                    cpu_core->GetTimer().Idle();
+                    kernel->PrepareReschedule();
+                }
+                idle_cores[cpu_core->GetID()] = idle;
+            }
+            slice_start_barrier->Sync();
+            RunCoreInParallel(*cpu_cores[0]);
+            slice_end_barrier->Sync();
+
+            // Leave the kernel on the last core, as the serial loop below does
+            kernel->SetRunningCPU(cpu_cores.back().get());
+            kernel->RescheduleMultiCores();
+            return status;
+        }
         for (auto& cpu_core : cpu_cores) {
             cpu_core->GetTimer().SetNextSlice(max_slice);
             auto start_ticks = cpu_core->GetTimer().GetTicks();
@@ -197,6 +244,40 @@ System::ResultStatus System::RunLoopMultiCores() {
     return status;
 }
 
+void System::StartCoreThreads(u32 num_cores) {
+    slice_start_barrier = std::make_unique<Common::Barrier>(num_cores);
+    slice_end_barrier = std::make_unique<Common::Barrier>(num_cores);
+    for (u32 i = 1; i < num_cores; ++i) {
+        core_threads.emplace_back([this, i](std::stop_token stop_token) {
+            CoreThreadLoop(stop_token, i);
+        });
+    }
+}
+
+void System::CoreThreadLoop(std::stop_token stop_token, u32 core_id) {
+    const std::string name = fmt::format("CPUCore_{}", core_id);
+    Common::SetCurrentThreadName(name.c_str());
+
+    while (slice_start_barrier->Sync(stop_token)) {
+        RunCoreInParallel(*cpu_cores[core_id]);
+        if (!slice_end_barrier->Sync(stop_token)) {
+            break;
+        }
+    }
+}
+
+void System::RunCoreInParallel(ARM_Interface& cpu_core) {
+    const u32 core_id = cpu_core.GetID();
+    if (idle_cores[core_id]) {
+        return;
+    }
+    // A core halted by another one entering the kernel continues its slice afterwards
+    do {
+        core_gate->EnterGuest(core_id);
+        cpu_core.Run();
+    } while (core_gate->LeaveGuest(core_id) && cpu_core.GetTimer().GetDowncount() > 0);
+}
+
 System::ResultStatus System::RunLoopSingleCore() {
     // If we don't have a currently active thread then don't execute instructions,
     // instead advance to the next event and try to yield to the next thread
@@ -530,8 +611,18 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return (perf_stats && timing) ? perf_stats->GetAndResetStats(timing->GetGlobalTimeUs())
-                                  : PerfStats::Results{};
+    if (!perf_stats || !timing) {
+        return PerfStats::Results{};
+    }
+    const PerfStats::AudioCounters audio_counters =
+        dsp_core ? dsp_core->GetOutputCounters() : PerfStats::AudioCounters{};
+    const PerfStats::Results results =
+        perf_stats->GetAndResetStats(timing->GetGlobalTimeUs(), audio_counters);
+    if (dsp_core) {
+        // The audio output thread must not read perf_stats, it is replaced on load and shutdown
+        dsp_core->SetEmulationSpeed(results.emulation_speed);
+    }
+    return results;
 }
 
 PerfStats::Results System::GetLastPerfStats() {
@@ -561,6 +652,15 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     exclusive_monitor = MakeExclusiveMonitor(*memory, num_cores);
     if (Settings::values.use_cpu_jit) {
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+        // Parallel execution relies on the dynarmic callbacks stopping the other cores and is not
+        // compatible with the debugger stopping a single core.
+        parallel_cores = num_cores > 1 && Settings::values.parallel_cores.GetValue() &&
+                         !Settings::values.use_gdbstub.GetValue();
+        if (parallel_cores) {
+            core_gate = std::make_unique<ParallelCoreGate>([this](u32 core_id) {
+                static_cast<ARM_Dynarmic&>(*cpu_cores[core_id]).HaltExecution();
+            });
+        }
         for (u32 i = 0; i < num_cores; ++i) {
             cpu_cores[i] = std::make_shared<ARM_Dynarmic>(
                 *this, i, timing->GetTimer(i), *exclusive_monitor);
@@ -583,6 +683,10 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     }
 
     kernel->SetRunningCPU(cpu_cores[0].get());
+    if (parallel_cores) {
+        LOG_INFO(Core, "Running {} CPU cores in parallel", num_cores);
+        StartCoreThreads(num_cores);
+    }
     if (Settings::values.core_downcount_hack) {
         SetCpuUsageLimit(true, num_cores);
     }
@@ -747,6 +851,7 @@ void System::Shutdown(bool is_deserializing) {
         GDBStub::Shutdown();
         perf_stats.reset();
         app_loader.reset();
+        rewind_buffer.reset();
     }
     custom_tex_manager.reset();
 #ifdef ENABLE_SCRIPTING
@@ -755,6 +860,11 @@ void System::Shutdown(bool is_deserializing) {
     archive_manager.reset();
     service_manager.reset();
     dsp_core.reset();
+    core_threads.clear();
+    slice_start_barrier.reset();
+    slice_end_barrier.reset();
+    core_gate.reset();
+    parallel_cores = false;
     kernel.reset();
     cpu_cores = {};
     exclusive_monitor.reset();
@@ -895,7 +1005,10 @@ void System::serialize(Archive& ar, const unsigned int file_version) {
         throw std::runtime_error("LLE audio not supported for save states");
     }
 
+    memory->SetSavestateContext(savestate_context ? *savestate_context
+                                                  : Memory::SavestateContext{});
     ar&* memory.get();
+    memory->SetSavestateContext({});
     ar&* kernel.get();
     ar&* gpu.get();
     ar& movie;
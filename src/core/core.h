@@ -4,10 +4,13 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 #include <boost/optional.hpp>
 #include <boost/serialization/version.hpp>
 #include "common/common_types.h"
@@ -18,6 +21,10 @@
 #include "core/movie.h"
 #include "core/perf_stats.h"
 
+namespace Common {
+class Barrier;
+}
+
 namespace Frontend {
 class EmuWindow;
 class ImageInterface;
@@ -27,7 +34,8 @@ class SoftwareKeyboard;
 
 namespace Memory {
 class MemorySystem;
-}
+struct SavestateContext;
+} // namespace Memory
 
 namespace AudioCore {
 class DspInterface;
@@ -73,7 +81,10 @@ namespace Core {
 
 class ARM_Interface;
 class ExclusiveMonitor;
+class ParallelCoreGate;
+class RewindBuffer;
 class Timing;
+struct SavestateBase;
 
 class System {
 public:
@@ -132,7 +143,7 @@ public:
     /// Shutdown and then load again
     void Reset();
 
-    enum class Signal : u32 { None, Shutdown, Reset, Save, Load };
+    enum class Signal : u32 { None, Shutdown, Reset, Save, SaveIncremental, Load, Rewind };
 
     bool SendSignal(Signal signal, u32 param = 0);
 
@@ -166,6 +177,16 @@ public:
         return is_powered_on;
     }
 
+    /// Returns true when the New 3DS cores execute guest code on separate host threads.
+    [[nodiscard]] bool IsParallelCoresEnabled() const {
+        return parallel_cores;
+    }
+
+    /// Returns the gate that stops the other parallel cores, or nullptr when they run serially.
+    [[nodiscard]] ParallelCoreGate* GetParallelCoreGate() const {
+        return core_gate.get();
+    }
+
     /// Prepare the core emulation for a reschedule
     void PrepareReschedule();
 
@@ -323,10 +344,21 @@ public:
                (mic_permission_granted = mic_permission_func());
     }
 
-    void SaveState(u32 slot) const;
+    /**
+     * Saves the emulation state to a slot. Incremental states only store the memory pages that
+     * changed since a full base state of the slot, which is written the first time.
+     */
+    void SaveState(u32 slot, bool incremental = false);
 
     void LoadState(u32 slot);
 
+    /**
+     * Loads the rewind snapshot taken the given amount of snapshots ago, 1 being the newest,
+     * without going through the filesystem. The loaded snapshot and any newer ones are discarded.
+     * @returns false if there is no snapshot to rewind to
+     */
+    bool LoadStateFromMemory(u32 steps);
+
     /// Self delete ncch
     bool SetSelfDelete(const std::string& file) {
         if (m_filepath == file) {
@@ -355,6 +387,15 @@ private:
                                     Kernel::MemoryMode memory_mode,
                                     const Kernel::New3dsHwCapabilities& n3ds_hw_caps);
 
+    /// Spawns the host threads that run cores 1 to num_cores - 1 in parallel mode.
+    void StartCoreThreads(u32 num_cores);
+
+    /// Host thread entry point for a core running in parallel mode.
+    void CoreThreadLoop(std::stop_token stop_token, u32 core_id);
+
+    /// Runs a single slice of the provided core while other cores may be running as well.
+    void RunCoreInParallel(ARM_Interface& cpu_core);
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -404,6 +445,15 @@ private:
 
     std::unique_ptr<Core::ExclusiveMonitor> exclusive_monitor;
 
+    /// When true, the cores of a slice run concurrently and stop each other to enter the kernel
+    bool parallel_cores = false;
+    std::unique_ptr<ParallelCoreGate> core_gate;
+    /// Cores without a thread to run during the current parallel slice
+    std::array<bool, 4> idle_cores{};
+    std::unique_ptr<Common::Barrier> slice_start_barrier;
+    std::unique_ptr<Common::Barrier> slice_end_barrier;
+    std::vector<std::jthread> core_threads;
+
 private:
     static System s_instance;
 
@@ -429,6 +479,17 @@ private:
     boost::optional<Service::APT::DeliverArg> restore_deliver_arg;
     boost::optional<Service::PLGLDR::PLG_LDR::PluginLoaderContext> restore_plugin_context;
 
+    /// Base state of the incremental savestates
+    std::unique_ptr<SavestateBase> savestate_base;
+    /// Snapshots taken periodically for rewinding, null when rewinding is disabled
+    std::unique_ptr<RewindBuffer> rewind_buffer;
+    s32 last_rewind_frame = 0;
+    /// How memory is stored by the savestate currently being saved or loaded
+    const Memory::SavestateContext* savestate_context = nullptr;
+
+    /// Takes a rewind snapshot when enough frames passed since the previous one
+    void UpdateRewindBuffer();
+
     friend class boost::serialization::access;
     template <typename Archive>
     void serialize(Archive& ar, const unsigned int file_version);
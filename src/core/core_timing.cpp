@@ -192,11 +192,11 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 }
 
 void Timing::Timer::MoveEvents() {
-    for (Event ev; ts_queue.Pop(ev);) {
+    ts_queue.PopAll([this](Event&& ev) {
         ev.fifo_order = event_fifo_id++;
         event_queue.emplace_back(std::move(ev));
         std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-    }
+    });
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
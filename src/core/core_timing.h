@@ -220,8 +220,9 @@ public:
         std::vector<Event> event_queue;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
-        // to the event_queue by the emu thread
-        Common::MPSCQueue<Event> ts_queue;
+        // to the event_queue by the emu thread. Pushing never takes a lock, so cores and host
+        // threads scheduling into this timer don't contend with each other.
+        Common::MPSCInbox<Event> ts_queue;
         // Are we in a function that has been called from Advance()
         // If events are sheduled from a function that gets called from Advance(),
         // don't change slice_length and downcount.
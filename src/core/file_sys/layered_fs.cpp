@@ -4,15 +4,19 @@
 
 #include <algorithm>
 #include <cstring>
+#include <span>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include "common/alignment.h"
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/patch.h"
+#include "core/loader/loader.h"
 
 SERIALIZE_EXPORT_IMPL(FileSys::LayeredFS)
 
@@ -54,12 +58,52 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "Size of FileMetadata is not correct");
 
+// The cache file holds a CacheHeader, the rebuilt metadata, the data entries, the replacement file
+// paths and the patched files, in this order
+constexpr u32 CacheMagic = Loader::MakeMagic('L', 'F', 'S', 'C');
+constexpr u32 CacheVersion = 1;
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le fingerprint;
+    u64_le metadata_size;
+    u64_le data_size;
+    u64_le entry_count;
+    u64_le paths_size;
+    u64_le patched_size;
+};
+static_assert(sizeof(CacheHeader) == 0x38, "Size of CacheHeader is not correct");
+
+struct CacheEntry {
+    u64_le offset;
+    u64_le size;
+    u64_le source; // original offset, or offset in the paths or patched files blob
+    u32_le type;
+    u32_le path_length;
+};
+static_assert(sizeof(CacheEntry) == 0x20, "Size of CacheEntry is not correct");
+
+/// Contents of the cache file, mapped in memory when possible.
+struct LayeredFS::CacheStorage {
+    boost::iostreams::mapped_file_source mapping;
+    std::vector<u8> buffer;
+
+    std::span<const u8> Data() const {
+        if (mapping.is_open()) {
+            return {reinterpret_cast<const u8*>(mapping.data()), mapping.size()};
+        }
+        return buffer;
+    }
+};
+
 LayeredFS::LayeredFS() = default;
 
 LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path_,
-                     std::string patch_ext_path_, bool load_relocations_)
+                     std::string patch_ext_path_, bool load_relocations_, std::string cache_path_)
     : romfs(std::move(romfs_)), patch_path(std::move(patch_path_)),
-      patch_ext_path(std::move(patch_ext_path_)), load_relocations(load_relocations_) {
+      patch_ext_path(std::move(patch_ext_path_)), load_relocations(load_relocations_),
+      cache_path(std::move(cache_path_)) {
     Load();
 }
 
@@ -68,6 +112,17 @@ void LayeredFS::Load() {
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
 
+    const bool use_cache = load_relocations && !cache_path.empty();
+    u64 fingerprint{};
+    if (use_cache) {
+        fingerprint = ComputeFingerprint();
+        if (LoadCache(fingerprint)) {
+            LOG_INFO(Service_FS, "LayeredFS loaded {} files from cache {}", data_entries.size(),
+                     cache_path);
+            return;
+        }
+    }
+
     // TODO: is root always the first directory in table?
     root.parent = &root;
     LoadDirectory(root, 0);
@@ -78,6 +133,10 @@ void LayeredFS::Load() {
     }
 
     RebuildMetadata();
+
+    if (use_cache) {
+        WriteCache(fingerprint);
+    }
 }
 
 LayeredFS::~LayeredFS() = default;
@@ -402,7 +461,15 @@ void LayeredFS::BuildFiles() {
         metadata.file_data_length = file->relocation.size;
         current_data_offset += Common::AlignUp(metadata.file_data_length, 16);
         if (metadata.file_data_length != 0) {
-            data_offset_map.emplace(metadata.file_data_offset, file);
+            const auto& relocation = file->relocation;
+            data_entries.push_back({
+                .offset = metadata.file_data_offset,
+                .size = relocation.size,
+                .type = relocation.type,
+                .original_offset = relocation.original_offset,
+                .replace_file_path = relocation.replace_file_path,
+                .patched_file = relocation.patched_file.data(),
+            });
         }
 
         const auto bucket =
@@ -483,6 +550,193 @@ void LayeredFS::RebuildMetadata() {
                 header.file_metadata_table.length);
 }
 
+u64 LayeredFS::ComputeFingerprint() {
+    std::vector<u8> original_metadata(header.file_data_offset);
+    romfs->ReadFile(0, original_metadata.size(), original_metadata.data());
+    u64 fingerprint = Common::ComputeHash64(original_metadata.data(), original_metadata.size());
+    fingerprint = Common::HashCombine(fingerprint, romfs->GetSize());
+
+    const auto hash_tree = [&fingerprint](const std::string& path) {
+        if (!FileUtil::Exists(path)) {
+            return;
+        }
+        FileUtil::FSTEntry tree;
+        FileUtil::ScanDirectoryTree(path, tree, 256);
+
+        // The directory listing order is not guaranteed, so hash the entries by name
+        const auto hash_entries = [&fingerprint](const auto& self,
+                                                 const FileUtil::FSTEntry& parent) -> void {
+            std::vector<const FileUtil::FSTEntry*> children;
+            children.reserve(parent.children.size());
+            for (const auto& child : parent.children) {
+                children.push_back(&child);
+            }
+            std::sort(children.begin(), children.end(), [](const auto* a, const auto* b) {
+                return a->virtualName < b->virtualName;
+            });
+            for (const auto* child : children) {
+                fingerprint = Common::HashCombine(
+                    fingerprint,
+                    Common::ComputeHash64(child->virtualName.data(), child->virtualName.size()));
+                fingerprint = Common::HashCombine(fingerprint, child->isDirectory);
+                fingerprint = Common::HashCombine(fingerprint, child->size);
+                fingerprint = Common::HashCombine(
+                    fingerprint, FileUtil::GetModificationTime(child->physicalName));
+                if (child->isDirectory) {
+                    self(self, *child);
+                }
+            }
+        };
+        hash_entries(hash_entries, tree);
+    };
+    hash_tree(patch_path);
+    fingerprint = Common::HashCombine(fingerprint, 0);
+    hash_tree(patch_ext_path);
+
+    return fingerprint;
+}
+
+bool LayeredFS::LoadCache(u64 fingerprint) {
+    if (!FileUtil::Exists(cache_path)) {
+        return false;
+    }
+
+    auto storage = std::make_unique<CacheStorage>();
+    try {
+        storage->mapping.open(cache_path);
+    } catch (const std::exception&) {
+        // Mapping is not possible on every storage, read the file instead
+        FileUtil::IOFile file(cache_path, "rb");
+        storage->buffer.resize(file.GetSize());
+        if (file.ReadBytes(storage->buffer.data(), storage->buffer.size()) !=
+            storage->buffer.size()) {
+            return false;
+        }
+    }
+
+    const auto data = storage->Data();
+    CacheHeader cache_header;
+    if (data.size() < sizeof(cache_header)) {
+        return false;
+    }
+    std::memcpy(&cache_header, data.data(), sizeof(cache_header));
+    if (cache_header.magic != CacheMagic || cache_header.version != CacheVersion) {
+        LOG_WARNING(Service_FS, "LayeredFS cache {} is invalid", cache_path);
+        return false;
+    }
+    if (cache_header.fingerprint != fingerprint) {
+        LOG_INFO(Service_FS, "LayeredFS cache {} is outdated", cache_path);
+        return false;
+    }
+
+    const u64 entries_offset = sizeof(cache_header) + cache_header.metadata_size;
+    const u64 paths_offset = entries_offset + cache_header.entry_count * sizeof(CacheEntry);
+    const u64 patched_offset = paths_offset + cache_header.paths_size;
+    if (patched_offset + cache_header.patched_size != data.size()) {
+        LOG_WARNING(Service_FS, "LayeredFS cache {} has an incorrect size", cache_path);
+        return false;
+    }
+
+    const auto paths = data.subspan(paths_offset, cache_header.paths_size);
+    const auto patched = data.subspan(patched_offset, cache_header.patched_size);
+    std::vector<DataEntry> entries(cache_header.entry_count);
+    for (std::size_t i = 0; i < entries.size(); i++) {
+        CacheEntry cache_entry;
+        std::memcpy(&cache_entry, data.data() + entries_offset + i * sizeof(CacheEntry),
+                    sizeof(cache_entry));
+
+        auto& entry = entries[i];
+        entry = {
+            .offset = cache_entry.offset,
+            .size = cache_entry.size,
+            .type = static_cast<int>(cache_entry.type),
+            .original_offset = cache_entry.source,
+            .replace_file_path = {},
+            .patched_file = nullptr,
+        };
+        bool valid = i == 0 || entries[i - 1].offset < entry.offset;
+        if (entry.type == 1) {
+            valid &= cache_entry.source + cache_entry.path_length <= paths.size();
+            if (valid) {
+                entry.replace_file_path = {
+                    reinterpret_cast<const char*>(paths.data() + cache_entry.source),
+                    cache_entry.path_length};
+            }
+        } else if (entry.type == 2) {
+            valid &= cache_entry.source + cache_entry.size <= patched.size();
+            if (valid) {
+                entry.patched_file = patched.data() + cache_entry.source;
+            }
+        } else {
+            valid &= entry.type == 0;
+        }
+        if (!valid) {
+            LOG_WARNING(Service_FS, "LayeredFS cache {} is corrupted", cache_path);
+            return false;
+        }
+    }
+
+    metadata.assign(data.begin() + sizeof(cache_header), data.begin() + entries_offset);
+    current_data_offset = cache_header.data_size;
+    data_entries = std::move(entries);
+    cache_storage = std::move(storage);
+    return true;
+}
+
+void LayeredFS::WriteCache(u64 fingerprint) {
+    std::vector<CacheEntry> entries;
+    entries.reserve(data_entries.size());
+    std::string paths;
+    std::vector<u8> patched;
+    for (const auto& entry : data_entries) {
+        CacheEntry& cache_entry = entries.emplace_back();
+        cache_entry.offset = entry.offset;
+        cache_entry.size = entry.size;
+        cache_entry.type = static_cast<u32>(entry.type);
+        cache_entry.path_length = 0;
+        cache_entry.source = entry.original_offset;
+        if (entry.type == 1) {
+            cache_entry.source = paths.size();
+            cache_entry.path_length = static_cast<u32>(entry.replace_file_path.size());
+            paths += entry.replace_file_path;
+        } else if (entry.type == 2) {
+            cache_entry.source = patched.size();
+            patched.insert(patched.end(), entry.patched_file, entry.patched_file + entry.size);
+        }
+    }
+
+    CacheHeader cache_header{};
+    cache_header.magic = CacheMagic;
+    cache_header.version = CacheVersion;
+    cache_header.fingerprint = fingerprint;
+    cache_header.metadata_size = metadata.size();
+    cache_header.data_size = current_data_offset;
+    cache_header.entry_count = entries.size();
+    cache_header.paths_size = paths.size();
+    cache_header.patched_size = patched.size();
+
+    // Write to a temporary file first, so that an interrupted write does not leave a broken cache
+    const std::string temp_path = cache_path + ".tmp";
+    {
+        FileUtil::CreateFullPath(cache_path);
+        FileUtil::IOFile file(temp_path, "wb");
+        if (!file || file.WriteObject(cache_header) != 1 ||
+            file.WriteBytes(metadata.data(), metadata.size()) != metadata.size() ||
+            file.WriteArray(entries.data(), entries.size()) != entries.size() ||
+            file.WriteBytes(paths.data(), paths.size()) != paths.size() ||
+            file.WriteBytes(patched.data(), patched.size()) != patched.size()) {
+            LOG_ERROR(Service_FS, "Could not write LayeredFS cache {}", temp_path);
+            return;
+        }
+    }
+    if (FileUtil::Exists(cache_path)) {
+        FileUtil::Delete(cache_path);
+    }
+    if (!FileUtil::Rename(temp_path, cache_path)) {
+        LOG_ERROR(Service_FS, "Could not move LayeredFS cache to {}", cache_path);
+    }
+}
+
 std::size_t LayeredFS::GetSize() const {
     return metadata.size() + current_data_offset;
 }
@@ -502,37 +756,36 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
     }
 
     // Read files
-    auto current = (--data_offset_map.upper_bound(offset));
+    auto current = std::upper_bound(
+        data_entries.begin(), data_entries.end(), offset,
+        [](std::size_t value, const DataEntry& entry) { return value < entry.offset; });
+    --current;
     while (read_size < length) {
-        const auto relative_offset = offset - current->first;
+        const auto relative_offset = offset - current->offset;
         std::size_t to_read{};
-        if (current->second->relocation.size > relative_offset) {
-            to_read = std::min<std::size_t>(current->second->relocation.size - relative_offset,
-                                            length - read_size);
+        if (current->size > relative_offset) {
+            to_read = std::min<std::size_t>(current->size - relative_offset, length - read_size);
         }
         const auto alignment =
-            std::min<std::size_t>(Common::AlignUp(current->second->relocation.size, 16) -
-                                      relative_offset,
+            std::min<std::size_t>(Common::AlignUp(current->size, 16) - relative_offset,
                                   length - read_size) -
             to_read;
 
         // Read the file in different ways depending on relocation type
-        auto& relocation = current->second->relocation;
-        if (relocation.type == 0) { // none
-            romfs->ReadFile(relocation.original_offset + relative_offset, to_read,
+        if (current->type == 0) { // none
+            romfs->ReadFile(current->original_offset + relative_offset, to_read,
                             buffer + read_size);
-        } else if (relocation.type == 1) { // replace
-            FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
+        } else if (current->type == 1) { // replace
+            const std::string replace_file_path{current->replace_file_path};
+            FileUtil::IOFile replace_file(replace_file_path, "rb");
             if (replace_file) {
                 replace_file.Seek(relative_offset, SEEK_SET);
                 replace_file.ReadBytes(buffer + read_size, to_read);
             } else {
-                LOG_ERROR(Service_FS, "Could not open replacement file for {}",
-                          current->second->path);
+                LOG_ERROR(Service_FS, "Could not open replacement file {}", replace_file_path);
             }
-        } else if (relocation.type == 2) { // patch
-            std::memcpy(buffer + read_size, relocation.patched_file.data() + relative_offset,
-                        to_read);
+        } else if (current->type == 2) { // patch
+            std::memcpy(buffer + read_size, current->patched_file + relative_offset, to_read);
         } else {
             UNREACHABLE();
         }
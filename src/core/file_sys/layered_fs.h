@@ -4,15 +4,16 @@
 
 #pragma once
 
-#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/string.hpp>
+#include <boost/serialization/version.hpp>
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/romfs_reader.h"
@@ -41,11 +42,14 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  * patch_ext_path: Path for RomFS extensions. Files present in this path:
  *  - When with an extension of ".stub", remove the corresponding file in the RomFS.
  *  - When with an extension of ".ips" or ".bps", patch the file in the RomFS.
+ * cache_path: Optional file where the rebuilt metadata is stored. It is loaded instead of walking
+ * the patch directories again as long as the RomFS and the patch directories are unchanged.
  */
 class LayeredFS : public RomFSReader {
 public:
     explicit LayeredFS(std::shared_ptr<RomFSReader> romfs, std::string patch_path,
-                       std::string patch_ext_path, bool load_relocations = true);
+                       std::string patch_ext_path, bool load_relocations = true,
+                       std::string cache_path = "");
     ~LayeredFS() override;
 
     std::size_t GetSize() const override;
@@ -106,19 +110,42 @@ private:
 
     void RebuildMetadata();
 
+    // Hashes the original RomFS metadata and the names, sizes and modification times of the
+    // patch directories contents
+    u64 ComputeFingerprint();
+
+    // Loads the rebuilt metadata from the cache file, returns false if it is missing or stale
+    bool LoadCache(u64 fingerprint);
+
+    void WriteCache(u64 fingerprint);
+
     void Load();
 
+    /// A file of the rebuilt RomFS data
+    struct DataEntry {
+        u64 offset; // assigned data offset
+        u64 size;
+        int type; // relocation type, see FileRelocationInfo
+        u64 original_offset;
+        std::string_view replace_file_path;
+        const u8* patched_file;
+    };
+
+    struct CacheStorage;
+
     std::shared_ptr<RomFSReader> romfs;
     std::string patch_path;
     std::string patch_ext_path;
     bool load_relocations;
+    std::string cache_path;
 
     RomFSHeader header;
     Directory root;
     std::unordered_map<std::string, File*> file_path_map;
     std::unordered_map<std::string, Directory*> directory_path_map;
-    std::map<u64, File*> data_offset_map; // assigned data offset -> file
-    std::vector<u8> metadata;             // Includes header, hash table and metadata
+    std::vector<DataEntry> data_entries; // sorted by assigned data offset
+    std::vector<u8> metadata;            // Includes header, hash table and metadata
+    std::unique_ptr<CacheStorage> cache_storage; // backs the data entries loaded from the cache
 
     // Used for rebuilding header
     std::vector<u32_le> directory_hash_table;
@@ -139,12 +166,15 @@ private:
     LayeredFS();
 
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
+    void serialize(Archive& ar, const unsigned int file_version) {
         ar& boost::serialization::base_object<RomFSReader>(*this);
         ar& romfs;
         ar& patch_path;
         ar& patch_ext_path;
         ar& load_relocations;
+        if (file_version > 0) {
+            ar& cache_path;
+        }
         if (Archive::is_loading::value) {
             Load();
         }
@@ -156,3 +186,4 @@ private:
 } // namespace FileSys
 
 BOOST_CLASS_EXPORT_KEY(FileSys::LayeredFS)
+BOOST_CLASS_VERSION(FileSys::LayeredFS, 1)
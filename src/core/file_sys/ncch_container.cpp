@@ -5,8 +5,6 @@
 #include <cstring>
 #include <memory>
 #include <span>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
 #include <cryptopp/sha.h>
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -15,6 +13,7 @@
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/patch.h"
 #include "core/file_sys/seed_db.h"
+#include "core/hw/aes/cipher.h"
 #include "core/hw/aes/key.h"
 #include "core/loader/loader.h"
 
@@ -348,10 +347,9 @@ Loader::ResultStatus NCCHContainer::Load() {
                         LOG_ERROR(Service_FS, "Failed to decrypt");
                         return Loader::ResultStatus::ErrorEncrypted;
                     }
-                    CryptoPP::byte* data = reinterpret_cast<CryptoPP::byte*>(&exheader_header);
-                    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption(
-                        primary_key.data(), primary_key.size(), exheader_ctr.data())
-                        .ProcessData(data, data, sizeof(exheader_header));
+                    HW::AES::DecryptCTR(
+                        {reinterpret_cast<u8*>(&exheader_header), sizeof(exheader_header)},
+                        primary_key, exheader_ctr);
                 }
             }
 
@@ -420,10 +418,8 @@ Loader::ResultStatus NCCHContainer::Load() {
                 return Loader::ResultStatus::Error;
 
             if (is_encrypted) {
-                CryptoPP::byte* data = reinterpret_cast<CryptoPP::byte*>(&exefs_header);
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption(primary_key.data(),
-                                                              primary_key.size(), exefs_ctr.data())
-                    .ProcessData(data, data, sizeof(exefs_header));
+                HW::AES::DecryptCTR({reinterpret_cast<u8*>(&exefs_header), sizeof(exefs_header)},
+                                    primary_key, exefs_ctr);
             }
 
             exefs_file = FileUtil::IOFile(filepath, "rb");
@@ -532,9 +528,7 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 key = secondary_key;
             }
 
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption dec(key.data(), key.size(),
-                                                              exefs_ctr.data());
-            dec.Seek(section.offset + sizeof(ExeFs_Header));
+            const u64 crypto_offset = section.offset + sizeof(ExeFs_Header);
 
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
                 // Section is compressed, read compressed .code section...
@@ -544,7 +538,7 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                     return Loader::ResultStatus::Error;
 
                 if (is_encrypted) {
-                    dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                    HW::AES::DecryptCTR(temp_buffer, key, exefs_ctr, crypto_offset);
                 }
 
                 // Decompress .code section...
@@ -558,7 +552,7 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 if (exefs_file.ReadBytes(buffer.data(), section.size) != section.size)
                     return Loader::ResultStatus::Error;
                 if (is_encrypted) {
-                    dec.ProcessData(buffer.data(), buffer.data(), section.size);
+                    HW::AES::DecryptCTR(buffer, key, exefs_ctr, crypto_offset);
                 }
             }
 
@@ -693,8 +687,11 @@ Loader::ResultStatus NCCHContainer::ReadRomFS(std::shared_ptr<RomFSReader>& romf
     if (use_layered_fs &&
         (FileUtil::Exists(path + "romfs/") || FileUtil::Exists(path + "romfs_ext/"))) {
 
+        const auto cache_path =
+            fmt::format("{}layeredfs/{:016X}.bin",
+                        FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), ncch_header.program_id);
         romfs_file = std::make_shared<LayeredFS>(std::move(direct_romfs), path + "romfs/",
-                                                 path + "romfs_ext/");
+                                                 path + "romfs_ext/", true, cache_path);
     } else {
         romfs_file = std::move(direct_romfs);
     }
@@ -1,65 +1,405 @@
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <unordered_map>
 #include <vector>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
 #include "common/archives.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/file_sys/romfs_reader.h"
+#include "core/hw/aes/cipher.h"
 
 SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
 
 namespace FileSys {
 
+/**
+ * Least recently used cache of fixed size blocks, split in shards with their own lock so that
+ * lookups from different threads rarely contend. Blocks are filled outside of the lock, threads
+ * requesting a block that is being filled wait for it instead of reading it a second time. The
+ * memory of a shard is only allocated once a block is looked up in it.
+ */
+class DirectRomFSReader::BlockCache {
+public:
+    static constexpr std::size_t NumShards = 8;
+
+    explicit BlockCache(std::size_t num_blocks)
+        : blocks_per_shard(std::max<std::size_t>(num_blocks / NumShards, 2)) {}
+
+    /// Returns the amount of data the cache can hold.
+    std::size_t Capacity() const {
+        return NumShards * blocks_per_shard * cache_block_size;
+    }
+
+    /**
+     * Copies part of a block of the reader into the buffer, reading it from the file first if
+     * needed.
+     * @returns The amount of bytes copied, which is less than requested past the end of the data.
+     */
+    std::size_t Read(DirectRomFSReader& reader, std::size_t block, std::size_t offset,
+                     std::size_t length, u8* buffer) {
+        Shard& shard = GetShard({reader.cache_id, block});
+        std::unique_lock lock{shard.mutex};
+        const auto [slot, cached] = Lookup(shard, lock, reader, block);
+        if (cached) {
+            ++reader.hits;
+        } else {
+            ++reader.misses;
+        }
+        if (slot == Shard::None) {
+            // Every slot of the shard is being filled, bypass the cache
+            lock.unlock();
+            std::vector<u8> data(cache_block_size);
+            const std::size_t size = reader.ReadBlock(block, data.data());
+            return CopyBlock(data.data(), size, offset, length, buffer);
+        }
+        const Shard::Slot& entry = shard.slots[slot];
+        return CopyBlock(shard.Data(slot), entry.size, offset, length, buffer);
+    }
+
+    /// Reads a block of the reader from the file into the cache, unless it is already there.
+    void Prefetch(DirectRomFSReader& reader, std::size_t block) {
+        Shard& shard = GetShard({reader.cache_id, block});
+        std::unique_lock lock{shard.mutex};
+        if (!Lookup(shard, lock, reader, block).second) {
+            ++reader.read_ahead;
+        }
+    }
+
+    /// Returns whether the block of the reader is in the cache and completely filled.
+    bool Contains(u64 reader_id, std::size_t block) {
+        const Key key{reader_id, block};
+        Shard& shard = GetShard(key);
+        std::scoped_lock lock{shard.mutex};
+        const auto it = shard.index.find(key);
+        return it != shard.index.end() && !shard.slots[it->second].filling;
+    }
+
+    /// Frees the slots of every block of the reader, which must not be reading anymore.
+    void Evict(u64 reader_id) {
+        for (Shard& shard : shards) {
+            std::scoped_lock lock{shard.mutex};
+            std::erase_if(shard.index, [&](const auto& entry) {
+                if (entry.first.reader != reader_id) {
+                    return false;
+                }
+                shard.slots[entry.second].size = 0;
+                shard.Unlink(entry.second);
+                shard.PushBack(entry.second);
+                return true;
+            });
+        }
+    }
+
+private:
+    struct Key {
+        u64 reader;
+        std::size_t block;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const noexcept {
+            return std::hash<u64>{}(key.reader ^ (static_cast<u64>(key.block) << 16));
+        }
+    };
+
+    struct Shard {
+        static constexpr u32 None = std::numeric_limits<u32>::max();
+
+        struct Slot {
+            Key key{};
+            std::size_t size = 0;
+            bool filling = false;
+            u32 prev = None;
+            u32 next = None;
+        };
+
+        void Initialize(std::size_t num_slots) {
+            slots.resize(num_slots);
+            data.resize(num_slots * cache_block_size);
+            index.reserve(num_slots);
+            for (u32 i = 0; i < static_cast<u32>(num_slots); i++) {
+                PushFront(i);
+            }
+        }
+
+        u8* Data(u32 slot) {
+            return data.data() + slot * cache_block_size;
+        }
+
+        void Unlink(u32 slot) {
+            Slot& entry = slots[slot];
+            (entry.prev != None ? slots[entry.prev].next : most_recent) = entry.next;
+            (entry.next != None ? slots[entry.next].prev : least_recent) = entry.prev;
+            entry.prev = entry.next = None;
+        }
+
+        void PushFront(u32 slot) {
+            Slot& entry = slots[slot];
+            entry.next = most_recent;
+            (most_recent != None ? slots[most_recent].prev : least_recent) = slot;
+            most_recent = slot;
+        }
+
+        void PushBack(u32 slot) {
+            Slot& entry = slots[slot];
+            entry.prev = least_recent;
+            (least_recent != None ? slots[least_recent].next : most_recent) = slot;
+            least_recent = slot;
+        }
+
+        std::mutex mutex;
+        std::condition_variable filled;
+        std::unordered_map<Key, u32, KeyHash> index;
+        std::vector<Slot> slots;
+        std::vector<u8> data;
+        u32 most_recent = None;
+        u32 least_recent = None;
+    };
+
+    Shard& GetShard(const Key& key) {
+        return shards[(key.reader + key.block) % NumShards];
+    }
+
+    /**
+     * Finds the slot of a block, filling the least recently used slot with it if not cached.
+     * @returns The slot holding the block, or None if no slot could be evicted, and whether the
+     * block was cached.
+     */
+    std::pair<u32, bool> Lookup(Shard& shard, std::unique_lock<std::mutex>& lock,
+                                DirectRomFSReader& reader, std::size_t block) {
+        if (shard.slots.empty()) {
+            shard.Initialize(blocks_per_shard);
+        }
+
+        const Key key{reader.cache_id, block};
+        for (;;) {
+            const auto it = shard.index.find(key);
+            if (it == shard.index.end()) {
+                break;
+            }
+            const u32 slot = it->second;
+            if (!shard.slots[slot].filling) {
+                shard.Unlink(slot);
+                shard.PushFront(slot);
+                return {slot, true};
+            }
+            // Another thread is reading the block, look it up again once it is done
+            shard.filled.wait(lock);
+        }
+
+        u32 slot = shard.least_recent;
+        while (slot != Shard::None && shard.slots[slot].filling) {
+            slot = shard.slots[slot].prev;
+        }
+        if (slot == Shard::None) {
+            return {Shard::None, false};
+        }
+
+        Shard::Slot& entry = shard.slots[slot];
+        if (entry.size != 0) {
+            shard.index.erase(entry.key);
+        }
+        entry.key = key;
+        entry.size = 0;
+        entry.filling = true;
+        shard.index.emplace(key, slot);
+        shard.Unlink(slot);
+        shard.PushFront(slot);
+
+        lock.unlock();
+        const std::size_t size = reader.ReadBlock(block, shard.Data(slot));
+        lock.lock();
+
+        entry.filling = false;
+        entry.size = size;
+        if (size == 0) {
+            // Nothing could be read, do not keep the block around
+            shard.index.erase(key);
+            shard.Unlink(slot);
+            shard.PushBack(slot);
+        }
+        shard.filled.notify_all();
+        return {slot, false};
+    }
+
+    static std::size_t CopyBlock(const u8* data, std::size_t size, std::size_t offset,
+                                 std::size_t length, u8* buffer) {
+        if (offset >= size) {
+            return 0;
+        }
+        const std::size_t copy_amount = std::min(length, size - offset);
+        std::memcpy(buffer, data + offset, copy_amount);
+        return copy_amount;
+    }
+
+    std::size_t blocks_per_shard;
+    std::array<Shard, NumShards> shards;
+};
+
+/// The block cache and read-ahead thread, shared by the readers while any of them is alive.
+struct DirectRomFSReader::SharedCache {
+    SharedCache(std::size_t num_blocks, bool read_ahead) : blocks(num_blocks) {
+        if (read_ahead) {
+            read_ahead_worker = std::make_unique<Common::ThreadWorker>(1, "RomFS read-ahead");
+        }
+    }
+
+    BlockCache blocks;
+    std::unique_ptr<Common::ThreadWorker> read_ahead_worker;
+};
+
+DirectRomFSReader::DirectRomFSReader() = default;
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size) {
+    InitializeCache();
+}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size, const std::array<u8, 16>& key,
+                                     const std::array<u8, 16>& ctr, std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size) {
+    InitializeCache();
+}
+
+DirectRomFSReader::~DirectRomFSReader() {
+    if (!cache) {
+        return;
+    }
+    {
+        // The read-ahead thread outlives this reader, wait for the work it still has for it
+        std::unique_lock lock{read_ahead_mutex};
+        stop_read_ahead = true;
+        read_ahead_done.wait(lock, [this] { return pending_read_ahead == 0; });
+    }
+    cache->blocks.Evict(cache_id);
+
+    const auto stats = GetCacheStats();
+    LOG_DEBUG(Service_FS, "RomFS cache stats: hits={}, misses={}, read_ahead={}, bypassed={}",
+              stats.hits, stats.misses, stats.read_ahead, stats.bypassed);
+}
+
+void DirectRomFSReader::InitializeCache() {
+    static std::atomic<u64> next_cache_id{1};
+    static std::mutex shared_cache_mutex;
+    static std::weak_ptr<SharedCache> shared_cache;
+    cache_id = next_cache_id++;
+
+    std::scoped_lock lock{shared_cache_mutex};
+    cache = shared_cache.lock();
+    if (!cache) {
+        // The settings are read when the first reader is created
+        const std::size_t cache_size =
+            static_cast<std::size_t>(Settings::values.romfs_cache_size.GetValue()) * 1024 * 1024;
+        cache = std::make_shared<SharedCache>(cache_size / cache_block_size,
+                                              Settings::values.romfs_read_ahead.GetValue());
+        shared_cache = cache;
+    }
+}
+
+std::size_t DirectRomFSReader::ReadUncached(std::size_t offset, std::size_t length, u8* buffer) {
+    const std::size_t read_size = file.ReadAtBytes(buffer, length, file_offset + offset);
+    if (read_size == 0 || read_size > length) {
+        return 0;
+    }
+    if (is_encrypted) {
+        HW::AES::DecryptCTR({buffer, read_size}, key, ctr, crypto_offset + offset);
+    }
+    return read_size;
+}
+
+std::size_t DirectRomFSReader::ReadBlock(std::size_t block, u8* data) {
+    const std::size_t offset = block * cache_block_size;
+    if (offset >= data_size) {
+        return 0;
+    }
+    return ReadUncached(offset, std::min<std::size_t>(cache_block_size, data_size - offset), data);
+}
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
+    if (offset >= data_size) {
+        return 0;
+    }
     length = std::min(length, static_cast<std::size_t>(data_size) - offset);
     if (length == 0)
         return 0; // Crypto++ does not like zero size buffer
 
-    const auto segments = BreakupRead(offset, length);
+    // Reads bigger than a quarter of the cache would evict most of it
+    if (length > cache->blocks.Capacity() / 4) {
+        ++bypassed;
+        LOG_TRACE(Service_FS, "RomFS Cache SKIP: offset={}, length={}", offset, length);
+        return ReadUncached(offset, length, buffer);
+    }
+
     std::size_t read_progress = 0;
+    while (read_progress < length) {
+        const std::size_t current = offset + read_progress;
+        const std::size_t into = current % cache_block_size;
+        const std::size_t expected = std::min(length - read_progress, cache_block_size - into);
+        const std::size_t copied =
+            cache->blocks.Read(*this, current / cache_block_size, into, expected,
+                               buffer + read_progress);
+        read_progress += copied;
+        if (copied < expected) {
+            break;
+        }
+    }
+
+    QueueReadAhead(offset, read_progress);
+    return read_progress;
+}
+
+void DirectRomFSReader::QueueReadAhead(std::size_t offset, std::size_t length) {
+    if (!cache->read_ahead_worker || length == 0) {
+        return;
+    }
+
+    // Read ahead a quarter of the cache at most, so that the read ahead blocks are not evicted
+    // before they are needed
+    const std::size_t window = std::min<std::size_t>(1024 * 1024, cache->blocks.Capacity() / 4);
+    const std::size_t end = offset + length;
 
-    // Skip cache if the read is too big
-    if (segments.size() == 1 && segments[0].second > cache_line_size) {
-        length = file.ReadAtBytes(buffer, length, file_offset + offset);
-        if (is_encrypted) {
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-            d.Seek(crypto_offset + offset);
-            d.ProcessData(buffer, buffer, length);
+    std::size_t first_block;
+    std::size_t last_block;
+    {
+        std::scoped_lock lock{read_ahead_mutex};
+        const bool sequential = offset == last_read_end;
+        last_read_end = end;
+        if (!sequential) {
+            return;
         }
-        LOG_TRACE(Service_FS, "RomFS Cache SKIP: offset={}, length={}", offset, length);
-        return length;
-    }
-
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::unique_lock<std::shared_mutex> read_guard(cache_mutex);
-    for (const auto& seg : segments) {
-        std::size_t read_size = cache_line_size;
-        std::size_t page = OffsetToPage(seg.first);
-        // Check if segment is in cache
-        auto cache_entry = cache.request(page);
-        if (!cache_entry.first) {
-            // If not found, read from disk and cache the data
-            read_size = file.ReadAtBytes(cache_entry.second.data(), read_size, file_offset + page);
-            if (is_encrypted && read_size) {
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-                d.Seek(crypto_offset + page);
-                d.ProcessData(cache_entry.second.data(), cache_entry.second.data(), read_size);
-            }
-            LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, length={}, into={}", page, seg.second,
-                      (seg.first - page));
-        } else {
-            LOG_TRACE(Service_FS, "RomFS Cache HIT: page={}, length={}, into={}", page, seg.second,
-                      (seg.first - page));
+        // Keep the queued data at least half a window ahead of the reads
+        if (read_ahead_end >= end + window / 2) {
+            return;
+        }
+        const std::size_t start = std::max(read_ahead_end, end);
+        read_ahead_end = std::min<std::size_t>(end + window, data_size);
+        if (start >= read_ahead_end) {
+            return;
         }
-        std::size_t copy_amount =
-            (read_size > (seg.first - page))
-                ? std::min((seg.first - page) + seg.second, read_size) - (seg.first - page)
-                : 0;
-        std::memcpy(buffer + read_progress, cache_entry.second.data() + (seg.first - page),
-                    copy_amount);
-        read_progress += copy_amount;
+        first_block = start / cache_block_size;
+        last_block = (read_ahead_end - 1) / cache_block_size;
+        ++pending_read_ahead;
     }
-    return read_progress;
+
+    cache->read_ahead_worker->QueueWork([this, first_block, last_block] {
+        for (std::size_t block = first_block; block <= last_block && !stop_read_ahead; block++) {
+            cache->blocks.Prefetch(*this, block);
+        }
+        std::scoped_lock lock{read_ahead_mutex};
+        if (--pending_read_ahead == 0) {
+            read_ahead_done.notify_all();
+        }
+    });
 }
 
 bool DirectRomFSReader::AllowsCachedReads() const {
@@ -67,46 +407,28 @@ bool DirectRomFSReader::AllowsCachedReads() const {
 }
 
 bool DirectRomFSReader::CacheReady(std::size_t file_offset, std::size_t length) {
-    auto segments = BreakupRead(file_offset, length);
-    if (segments.size() == 1 && segments[0].second > cache_line_size) {
-        return false;
-    } else {
-        // TODO(PabloMK7): Since the LRU cache is not thread safe, a lock must be used.
-        // However, this completely breaks the point of using a cache, because
-        // smaller reads may be blocked by bigger reads. For now, always return
-        // data being in cache to prevent the need of a lock, and only read data
-        // asynchronously if it is too big to use the cache.
-        /*
-        std::shared_lock<std::shared_mutex> read_guard(cache_mutex);
-        for (auto it = segments.begin(); it != segments.end(); it++) {
-            if (!cache.contains(OffsetToPage(it->first)))
-                return false;
-        }
-        */
+    if (length == 0) {
         return true;
     }
-}
-
-std::vector<std::pair<std::size_t, std::size_t>> DirectRomFSReader::BreakupRead(
-    std::size_t offset, std::size_t length) {
-
-    std::vector<std::pair<std::size_t, std::size_t>> ret;
-
-    // Reads bigger than the cache line size will probably never hit again
-    if (length > cache_line_size) {
-        ret.push_back(std::make_pair(offset, length));
-        return ret;
+    if (length > cache->blocks.Capacity() / 4) {
+        return false;
     }
-
-    std::size_t curr_offset = offset;
-    while (length) {
-        std::size_t next_page = OffsetToPage(curr_offset + cache_line_size);
-        std::size_t curr_page_len = std::min(length, next_page - curr_offset);
-        ret.push_back(std::make_pair(curr_offset, curr_page_len));
-        curr_offset = next_page;
-        length -= curr_page_len;
+    const std::size_t last_block = (file_offset + length - 1) / cache_block_size;
+    for (std::size_t block = file_offset / cache_block_size; block <= last_block; block++) {
+        if (!cache->blocks.Contains(cache_id, block)) {
+            return false;
+        }
     }
-    return ret;
+    return true;
+}
+
+DirectRomFSReader::CacheStats DirectRomFSReader::GetCacheStats() const {
+    return {
+        .hits = hits.load(),
+        .misses = misses.load(),
+        .read_ahead = read_ahead.load(),
+        .bypassed = bypassed.load(),
+    };
 }
 
 } // namespace FileSys
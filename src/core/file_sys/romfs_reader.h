@@ -1,14 +1,16 @@
 #pragma once
 
 #include <array>
-#include <shared_mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
-#include "common/static_lru_cache.h"
 
 namespace FileSys {
 
@@ -32,20 +34,21 @@ private:
 
 /**
  * A RomFS reader that directly reads the RomFS file.
+ *
+ * Reads go through a sharded cache of decrypted blocks sized by the romfs_cache_size setting, which
+ * can be looked up from several threads at once. Sequential reads additionally have the following
+ * blocks read ahead on a background thread. The cache and the read-ahead thread are shared by all
+ * the readers alive at the same time.
  */
 class DirectRomFSReader : public RomFSReader {
 public:
-    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                      std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                      std::size_t crypto_offset);
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -57,7 +60,20 @@ public:
 
     bool CacheReady(std::size_t file_offset, std::size_t length) override;
 
+    struct CacheStats {
+        u64 hits;       ///< Blocks copied from the cache
+        u64 misses;     ///< Blocks read from the file on request
+        u64 read_ahead; ///< Blocks read from the file ahead of being requested
+        u64 bypassed;   ///< Reads too large for the cache, served from the file directly
+    };
+
+    /// Returns the counters of the block cache.
+    CacheStats GetCacheStats() const;
+
 private:
+    class BlockCache;
+    struct SharedCache;
+
     bool is_encrypted;
     FileUtil::IOFile file;
     std::array<u8, 16> key;
@@ -66,22 +82,39 @@ private:
     u64 crypto_offset;
     u64 data_size;
 
-    // Total cache size: 128KB
-    static constexpr std::size_t cache_line_size = (1 << 13); // About 8KB
-    static constexpr std::size_t cache_line_count = 16;
+    static constexpr std::size_t cache_block_size = 32 * 1024;
 
-    Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count> cache;
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::shared_mutex cache_mutex;
+    std::shared_ptr<SharedCache> cache;
+    /// Identifies the blocks of this reader in the shared cache
+    u64 cache_id = 0;
 
-    DirectRomFSReader() = default;
+    std::atomic<u64> hits{};
+    std::atomic<u64> misses{};
+    std::atomic<u64> read_ahead{};
+    std::atomic<u64> bypassed{};
 
-    std::size_t OffsetToPage(std::size_t offset) {
-        return Common::AlignDown<std::size_t>(offset, cache_line_size);
-    }
+    /// End of the last read, used to detect sequential reads
+    std::size_t last_read_end = 0;
+    /// End of the data queued for reading ahead
+    std::size_t read_ahead_end = 0;
+    /// Read-ahead work queued for this reader that did not finish yet
+    std::size_t pending_read_ahead = 0;
+    std::atomic<bool> stop_read_ahead = false;
+    std::mutex read_ahead_mutex;
+    std::condition_variable read_ahead_done;
+
+    DirectRomFSReader();
+
+    void InitializeCache();
+
+    /// Reads and decrypts data from the file, returning the amount read.
+    std::size_t ReadUncached(std::size_t offset, std::size_t length, u8* buffer);
+
+    /// Reads a whole cache block from the file, returning the amount read.
+    std::size_t ReadBlock(std::size_t block, u8* data);
 
-    std::vector<std::pair<std::size_t, std::size_t>> BreakupRead(std::size_t offset,
-                                                                 std::size_t length);
+    /// Queues the blocks following a sequential read for reading ahead.
+    void QueueReadAhead(std::size_t offset, std::size_t length);
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
@@ -93,6 +126,9 @@ private:
         ar& file_offset;
         ar& crypto_offset;
         ar& data_size;
+        if (Archive::is_loading::value) {
+            InitializeCache();
+        }
     }
     friend class boost::serialization::access;
 };
@@ -27,6 +27,11 @@ SERIALIZE_EXPORT_IMPL(Kernel::HLERequestContext::ThreadCallback)
 
 namespace Kernel {
 
+namespace {
+/// Upper bound of pooled contexts, more than this are only needed while many threads sleep
+constexpr std::size_t MaxPooledContexts = 16;
+} // Anonymous namespace
+
 class HLERequestContext::ThreadCallback : public Kernel::WakeupCallback {
 
 public:
@@ -43,17 +48,22 @@ public:
         auto process = thread->owner_process.lock();
         ASSERT(process);
 
-        // We must copy the entire command buffer *plus* the entire static buffers area, since
+        // We must access the entire command buffer *plus* the entire static buffers area, since
         // the translation might need to read from it in order to retrieve the StaticBuffer
         // target addresses.
         std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buff;
         Memory::MemorySystem& memory = context->kernel.memory;
-        memory.ReadBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                         cmd_buff.size() * sizeof(u32));
+        const VAddr cmd_buff_address = thread->GetCommandBufferAddress();
+        auto* guest_cmd_buff = reinterpret_cast<u32_le*>(
+            memory.GetPlainMemoryPointer(*process, cmd_buff_address, sizeof(cmd_buff)));
+        if (guest_cmd_buff) {
+            context->WriteToOutgoingCommandBuffer(guest_cmd_buff, *process);
+            return;
+        }
+        memory.ReadBlock(*process, cmd_buff_address, cmd_buff.data(), sizeof(cmd_buff));
         context->WriteToOutgoingCommandBuffer(cmd_buff.data(), *process);
         // Copy the translated command buffer back into the thread's command buffer area.
-        memory.WriteBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                          cmd_buff.size() * sizeof(u32));
+        memory.WriteBlock(*process, cmd_buff_address, cmd_buff.data(), sizeof(cmd_buff));
     }
 
 private:
@@ -76,20 +86,33 @@ SessionRequestHandler::SessionInfo::SessionInfo(std::shared_ptr<ServerSession> s
 
 void SessionRequestHandler::ClientConnected(std::shared_ptr<ServerSession> server_session) {
     server_session->SetHleHandler(shared_from_this());
+    server_session->hle_session_index = static_cast<u32>(connected_sessions.size());
     connected_sessions.emplace_back(std::move(server_session), MakeSessionData());
 }
 
 void SessionRequestHandler::ClientDisconnected(std::shared_ptr<ServerSession> server_session) {
     server_session->SetHleHandler(nullptr);
-    connected_sessions.erase(
-        std::remove_if(connected_sessions.begin(), connected_sessions.end(),
-                       [&](const SessionInfo& info) { return info.session == server_session; }),
-        connected_sessions.end());
+    const u32 index = server_session->hle_session_index;
+    if (index >= connected_sessions.size() ||
+        connected_sessions[index].session != server_session) {
+        return;
+    }
+    // Move the last session into the freed slot so the indices of the others stay valid
+    if (index != connected_sessions.size() - 1) {
+        std::swap(connected_sessions[index], connected_sessions.back());
+        connected_sessions[index].session->hle_session_index = index;
+    }
+    connected_sessions.pop_back();
 }
 
 template <class Archive>
 void SessionRequestHandler::serialize(Archive& ar, const unsigned int) {
     ar& connected_sessions;
+    if (Archive::is_loading::value) {
+        for (u32 i = 0; i < connected_sessions.size(); i++) {
+            connected_sessions[i].session->hle_session_index = i;
+        }
+    }
 }
 SERIALIZE_IMPL(SessionRequestHandler)
 
@@ -131,6 +154,19 @@ HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<Serve
 
 HLERequestContext::~HLERequestContext() = default;
 
+void HLERequestContext::Reset(std::shared_ptr<ServerSession> session_,
+                              std::shared_ptr<Thread> thread_) {
+    cmd_buf[0] = 0;
+    session = std::move(session_);
+    thread = std::move(thread_);
+    // Clearing keeps the capacity of the buffers for the next request
+    request_handles.clear();
+    for (auto& buffer : static_buffers) {
+        buffer.clear();
+    }
+    request_mapped_buffers.clear();
+}
+
 std::shared_ptr<Object> HLERequestContext::GetIncomingHandle(u32 id_from_cmdbuf) const {
     ASSERT(id_from_cmdbuf < request_handles.size());
     return request_handles[id_from_cmdbuf];
@@ -204,11 +240,11 @@ Result HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* src_cm
             VAddr source_address = src_cmdbuf[i];
             IPC::StaticBufferDescInfo buffer_info{descriptor};
 
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
+            // Copy the input buffer into our own vector, reusing its storage from previous requests.
+            auto& data = static_buffers[buffer_info.buffer_id];
+            data.resize(buffer_info.size);
             kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
 
-            AddStaticBuffer(buffer_info.buffer_id, std::move(data));
             cmd_buf[i++] = source_address;
             break;
         }
@@ -355,4 +391,31 @@ void MappedBuffer::Write(const void* src_buffer, std::size_t offset, std::size_t
     memory->WriteBlock(*process, address + static_cast<VAddr>(offset), src_buffer, size);
 }
 
+HLERequestContextPool::HLERequestContextPool(KernelSystem& kernel) : kernel(kernel) {
+    free_contexts.reserve(MaxPooledContexts);
+}
+
+HLERequestContextPool::~HLERequestContextPool() = default;
+
+std::shared_ptr<HLERequestContext> HLERequestContextPool::Acquire(
+    std::shared_ptr<ServerSession> session, std::shared_ptr<Thread> thread) {
+    if (free_contexts.empty()) {
+        return std::make_shared<HLERequestContext>(kernel, std::move(session), std::move(thread));
+    }
+    auto context = std::move(free_contexts.back());
+    free_contexts.pop_back();
+    context->Reset(std::move(session), std::move(thread));
+    return context;
+}
+
+void HLERequestContextPool::Release(std::shared_ptr<HLERequestContext> context) {
+    // A context still referenced elsewhere belongs to a request that has not completed yet
+    if (context.use_count() != 1 || free_contexts.size() >= MaxPooledContexts) {
+        return;
+    }
+    // Drop the references to the session and thread right away, they may be closed meanwhile
+    context->Reset(nullptr, nullptr);
+    free_contexts.push_back(std::move(context));
+}
+
 } // namespace Kernel
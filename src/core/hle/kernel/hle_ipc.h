@@ -97,17 +97,17 @@ protected:
 
     /// Returns the session data associated with the server session.
     template <typename T>
-    T* GetSessionData(std::shared_ptr<ServerSession> session) {
+    T* GetSessionData(const std::shared_ptr<ServerSession>& session) {
         static_assert(std::is_base_of<SessionDataBase, T>(),
                       "T is not a subclass of SessionDataBase");
-        auto itr = std::find_if(connected_sessions.begin(), connected_sessions.end(),
-                                [&](const SessionInfo& info) { return info.session == session; });
-        ASSERT(itr != connected_sessions.end());
-        return static_cast<T*>(itr->data.get());
+        const u32 index = session->hle_session_index;
+        ASSERT(index < connected_sessions.size() && connected_sessions[index].session == session);
+        return static_cast<T*>(connected_sessions[index].data.get());
     }
 
     /// List of sessions that are connected to this handler. A ServerSession whose server endpoint
     /// is an HLE implementation is kept alive by this list for the duration of the connection.
+    /// Each session records its index in this list, so the order is not preserved on removal.
     std::vector<SessionInfo> connected_sessions;
 
 private:
@@ -210,14 +210,14 @@ public:
      * Returns the session through which this request was made. This can be used as a map key to
      * access per-client data on services.
      */
-    std::shared_ptr<ServerSession> Session() const {
+    const std::shared_ptr<ServerSession>& Session() const {
         return session;
     }
 
     /**
      * Returns the client thread that made the service request.
      */
-    std::shared_ptr<Thread> ClientThread() const {
+    const std::shared_ptr<Thread>& ClientThread() const {
         return thread;
     }
 
@@ -368,6 +368,11 @@ public:
     friend class ThreadCallback;
 
 private:
+    friend class HLERequestContextPool;
+
+    /// Prepares a released context to handle a new request.
+    void Reset(std::shared_ptr<ServerSession> session, std::shared_ptr<Thread> thread);
+
     KernelSystem& kernel;
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     std::shared_ptr<ServerSession> session;
@@ -385,6 +390,28 @@ private:
     friend class boost::serialization::access;
 };
 
+/**
+ * Keeps the contexts of handled HLE requests for reuse, along with the capacity of their buffers,
+ * so that handling a request does not allocate. Contexts that are still referenced, such as the
+ * ones kept by a client thread put to sleep, are not recycled.
+ */
+class HLERequestContextPool {
+public:
+    explicit HLERequestContextPool(KernelSystem& kernel);
+    ~HLERequestContextPool();
+
+    /// Returns a context for a new request, reusing a released one when possible.
+    std::shared_ptr<HLERequestContext> Acquire(std::shared_ptr<ServerSession> session,
+                                               std::shared_ptr<Thread> thread);
+
+    /// Returns the context of a handled request to the pool.
+    void Release(std::shared_ptr<HLERequestContext> context);
+
+private:
+    KernelSystem& kernel;
+    std::vector<std::shared_ptr<HLERequestContext>> free_contexts;
+};
+
 } // namespace Kernel
 
 BOOST_CLASS_EXPORT_KEY(Kernel::SessionRequestHandler)
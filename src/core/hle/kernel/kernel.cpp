@@ -10,6 +10,7 @@
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/config_mem.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/ipc_debugger/recorder.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
@@ -38,6 +39,7 @@ KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
     }
     timer_manager = std::make_unique<TimerManager>(timing);
     ipc_recorder = std::make_unique<IPCDebugger::Recorder>();
+    hle_context_pool = std::make_unique<HLERequestContextPool>(*this);
 
     next_thread_id = 1;
 }
@@ -96,6 +98,21 @@ void KernelSystem::SetRunningCPU(Core::ARM_Interface* cpu) {
     }
 }
 
+void KernelSystem::ActivateCPU(Core::ARM_Interface* cpu) {
+    if (current_cpu == cpu) {
+        return;
+    }
+    if (current_process) {
+        stored_processes[current_cpu->GetID()] = current_process;
+    }
+    current_cpu = cpu;
+    timing.SetCurrentTimer(cpu->GetID());
+    if (stored_processes[current_cpu->GetID()]) {
+        current_process = stored_processes[current_cpu->GetID()];
+        memory.SetCurrentPageTable(current_process->vm_manager.page_table);
+    }
+}
+
 ThreadManager& KernelSystem::GetThreadManager(u32 core_id) {
     return *thread_managers[core_id];
 }
@@ -140,6 +157,10 @@ const IPCDebugger::Recorder& KernelSystem::GetIPCRecorder() const {
     return *ipc_recorder;
 }
 
+HLERequestContextPool& KernelSystem::GetHLERequestContextPool() {
+    return *hle_context_pool;
+}
+
 void KernelSystem::AddNamedPort(std::string name, std::shared_ptr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
@@ -54,6 +54,7 @@ class ClientPort;
 class ServerPort;
 class ClientSession;
 class ServerSession;
+class HLERequestContextPool;
 class ResourceLimitList;
 class SharedMemory;
 class ThreadManager;
@@ -277,6 +278,13 @@ public:
 
     void SetRunningCPU(Core::ARM_Interface* cpu);
 
+    /**
+     * Makes cpu the current core and points the memory system at the page table of its process.
+     * Used by cores that run in parallel when they enter the HLE kernel, must be called with the
+     * HLE lock held and the other cores stopped.
+     */
+    void ActivateCPU(Core::ARM_Interface* cpu);
+
     ThreadManager& GetThreadManager(u32 core_id);
     const ThreadManager& GetThreadManager(u32 core_id) const;
 
@@ -296,6 +304,8 @@ public:
     IPCDebugger::Recorder& GetIPCRecorder();
     const IPCDebugger::Recorder& GetIPCRecorder() const;
 
+    HLERequestContextPool& GetHLERequestContextPool();
+
     std::shared_ptr<MemoryRegionInfo> GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -384,6 +394,7 @@ private:
     std::shared_ptr<SharedPage::Handler> shared_page_handler;
 
     std::unique_ptr<IPCDebugger::Recorder> ipc_recorder;
+    std::unique_ptr<HLERequestContextPool> hle_context_pool;
 
     u32 next_thread_id;
 
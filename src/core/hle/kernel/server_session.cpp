@@ -87,12 +87,21 @@ Result ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
         std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buf;
         auto current_process = thread->owner_process.lock();
         ASSERT(current_process);
-        kernel.memory.ReadBlock(*current_process, thread->GetCommandBufferAddress(), cmd_buf.data(),
-                                cmd_buf.size() * sizeof(u32));
 
-        auto context =
-            std::make_shared<Kernel::HLERequestContext>(kernel, SharedFrom(this), thread);
-        context->PopulateFromIncomingCommandBuffer(cmd_buf.data(), current_process);
+        // The command buffer lives in the TLS of the thread, which is normally plain memory that
+        // can be translated in place. Otherwise it is copied in and out.
+        const VAddr cmd_buf_address = thread->GetCommandBufferAddress();
+        auto* guest_cmd_buf = reinterpret_cast<u32_le*>(kernel.memory.GetPlainMemoryPointer(
+            *current_process, cmd_buf_address, sizeof(cmd_buf)));
+        if (!guest_cmd_buf) {
+            kernel.memory.ReadBlock(*current_process, cmd_buf_address, cmd_buf.data(),
+                                    sizeof(cmd_buf));
+        }
+        u32_le* const request_cmd_buf = guest_cmd_buf ? guest_cmd_buf : cmd_buf.data();
+
+        auto& context_pool = kernel.GetHLERequestContextPool();
+        auto context = context_pool.Acquire(SharedFrom(this), thread);
+        context->PopulateFromIncomingCommandBuffer(request_cmd_buf, current_process);
 
         hle_handler->HandleSyncRequest(*context);
 
@@ -102,10 +111,13 @@ Result ServerSession::HandleSyncRequest(std::shared_ptr<Thread> thread) {
         // put the thread to sleep then the writing of the command buffer will be deferred to the
         // wakeup callback.
         if (thread->status == Kernel::ThreadStatus::Running) {
-            context->WriteToOutgoingCommandBuffer(cmd_buf.data(), *current_process);
-            kernel.memory.WriteBlock(*current_process, thread->GetCommandBufferAddress(),
-                                     cmd_buf.data(), cmd_buf.size() * sizeof(u32));
+            context->WriteToOutgoingCommandBuffer(request_cmd_buf, *current_process);
+            if (!guest_cmd_buf) {
+                kernel.memory.WriteBlock(*current_process, cmd_buf_address, cmd_buf.data(),
+                                         sizeof(cmd_buf));
+            }
         }
+        context_pool.Release(std::move(context));
     }
 
     if (thread->status == ThreadStatus::Running) {
@@ -78,6 +78,8 @@ public:
     std::shared_ptr<Session> parent; ///< The parent session, which links to the client endpoint.
     std::shared_ptr<SessionRequestHandler>
         hle_handler; ///< This session's HLE request handler (optional)
+    /// Index of this session in the connected sessions of its HLE handler, for direct lookups
+    u32 hle_session_index = 0;
 
     /// List of threads that are pending a response after a sync request. This list is processed in
     /// a LIFO manner, thus, the last request will be dispatched first.
@@ -92,7 +92,7 @@ void Thread::Stop() {
     // Clean up thread from ready queue
     // This is only needed when the thread is termintated forcefully (SVC TerminateProcess)
     if (status == ThreadStatus::Ready) {
-        thread_manager.ready_queue.remove(current_priority, this);
+        thread_manager.ready_queue.remove(this);
     }
 
     status = ThreadStatus::Dead;
@@ -148,7 +148,7 @@ void ThreadManager::SwitchContext(Thread* new_thread) {
 
         current_thread = SharedFrom(new_thread);
 
-        ready_queue.remove(new_thread->current_priority, new_thread);
+        ready_queue.remove(new_thread);
         new_thread->status = ThreadStatus::Running;
 
         ASSERT(current_thread->owner_process.lock());
@@ -341,7 +341,6 @@ ResultVal<std::shared_ptr<Thread>> KernelSystem::CreateThread(
     auto thread = std::make_shared<Thread>(*this, processor_id);
 
     thread_managers[processor_id]->thread_list.push_back(thread);
-    thread_managers[processor_id]->ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = ThreadStatus::Dormant;
@@ -375,9 +374,7 @@ void Thread::SetPriority(u32 priority) {
                "Invalid priority value.");
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
-        thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
+        thread_manager.ready_queue.move(this, priority);
 
     nominal_priority = current_priority = priority;
 }
@@ -394,9 +391,7 @@ void Thread::UpdatePriority() {
 void Thread::BoostPriority(u32 priority) {
     // If thread was ready, adjust queues
     if (status == ThreadStatus::Ready)
-        thread_manager.ready_queue.move(this, current_priority, priority);
-    else
-        thread_manager.ready_queue.prepare(priority);
+        thread_manager.ready_queue.move(this, priority);
     current_priority = priority;
 }
 
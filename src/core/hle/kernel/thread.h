@@ -140,7 +140,7 @@ private:
     Core::ARM_Interface* cpu;
 
     std::shared_ptr<Thread> current_thread;
-    Common::ThreadQueueList<Thread*, ThreadPrioLowest + 1> ready_queue;
+    Common::ThreadQueueList<Thread, ThreadPrioLowest + 1> ready_queue;
     std::deque<Thread*> unscheduled_ready_queue;
     std::unordered_map<u64, Thread*> wakeup_callback_table;
 
@@ -158,7 +158,7 @@ private:
     void serialize(Archive& ar, const unsigned int);
 };
 
-class Thread final : public WaitObject {
+class Thread final : public WaitObject, public Common::ThreadQueueListNode<Thread> {
 public:
     explicit Thread(KernelSystem&, u32 core_id);
     ~Thread() override;
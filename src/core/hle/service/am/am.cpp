@@ -5,8 +5,6 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstring>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
 #include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/archives.h"
@@ -30,6 +28,7 @@
 #include "core/hle/service/am/am_u.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/fs_user.h"
+#include "core/hw/aes/cipher.h"
 #include "core/loader/loader.h"
 #include "core/loader/smdh.h"
 #include "core/nus_download.h"
@@ -111,7 +110,9 @@ u32 CTCert::GetDeviceID() const {
 
 class CIAFile::DecryptionState {
 public:
-    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    HW::AES::AESKey title_key;
+    /// IV of the next data to decrypt of every content
+    std::vector<HW::AES::AESIV> content_iv;
 };
 
 CIAFile::CIAFile(Core::System& system_, Service::FS::MediaType media_type)
@@ -198,11 +199,10 @@ Result CIAFile::WriteTitleMetadata() {
 
     if (container.GetTitleMetadata().HasEncryptedContent()) {
         if (auto title_key = container.GetTicket().GetTitleKey()) {
-            decryption_state->content.resize(content_count);
+            decryption_state->title_key = *title_key;
+            decryption_state->content_iv.resize(content_count);
             for (std::size_t i = 0; i < content_count; ++i) {
-                auto ctr = tmd.GetContentCTRByIndex(i);
-                decryption_state->content[i].SetKeyWithIV(title_key->data(), title_key->size(),
-                                                          ctr.data());
+                decryption_state->content_iv[i] = tmd.GetContentCTRByIndex(i);
             }
         } else {
             LOG_ERROR(Service_AM, "Could not read title key from ticket for encrypted CIA.");
@@ -249,7 +249,8 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
                                  buffer + (range_min - offset) + available_to_write);
 
             if ((tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) != 0) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
+                HW::AES::DecryptCBC(temp, decryption_state->title_key,
+                                    decryption_state->content_iv[i]);
             }
 
             file.WriteBytes(temp.data(), temp.size());
@@ -32,6 +32,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/service/plgldr/plgldr.h"
 #include "core/loader/loader.h"
+#include "core/memory.h"
 
 SERIALIZE_EXPORT_IMPL(Service::PLGLDR::PLG_LDR)
 SERVICE_CONSTRUCT_IMPL(Service::PLGLDR::PLG_LDR)
@@ -88,6 +89,9 @@ template <class Archive>
 void PLG_LDR::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
     ar& plgldr_context;
+    if (Archive::is_loading::value) {
+        system.Memory().InvalidateRasterizerCachedTLB();
+    }
 }
 SERIALIZE_IMPL(PLG_LDR)
 
@@ -180,6 +184,17 @@ void PLG_LDR::OnMemoryChanged(Kernel::Process& process, Kernel::KernelSystem& ke
     evt->Signal();
 }
 
+void PLG_LDR::SetPluginLoaderContext(PluginLoaderContext& context) {
+    plgldr_context = context;
+    system.Memory().InvalidateRasterizerCachedTLB();
+}
+
+void PLG_LDR::SetPluginFBAddr(PAddr addr) {
+    plgldr_context.plugin_fb_addr = addr;
+    // The framebuffer pages are rasterizer cached, their translation depends on this address
+    system.Memory().InvalidateRasterizerCachedTLB();
+}
+
 void PLG_LDR::IsEnabled(Kernel::HLERequestContext& ctx) {
     IPC::RequestParser rp(ctx);
 
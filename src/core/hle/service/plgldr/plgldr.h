@@ -94,9 +94,7 @@ public:
     PluginLoaderContext& GetPluginLoaderContext() {
         return plgldr_context;
     }
-    void SetPluginLoaderContext(PluginLoaderContext& context) {
-        plgldr_context = context;
-    }
+    void SetPluginLoaderContext(PluginLoaderContext& context);
     void SetEnabled(bool enabled) {
         plgldr_context.is_enabled = enabled;
     }
@@ -109,9 +107,7 @@ public:
     bool GetAllowGameChangeState() {
         return plgldr_context.allow_game_change;
     }
-    void SetPluginFBAddr(PAddr addr) {
-        plgldr_context.plugin_fb_addr = addr;
-    }
+    void SetPluginFBAddr(PAddr addr);
     PAddr GetPluginFBAddr() {
         return plgldr_context.plugin_fb_addr;
     }
@@ -0,0 +1,154 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/alignment.h"
+#include "common/thread_worker.h"
+#include "core/hw/aes/cipher.h"
+
+namespace HW::AES {
+
+namespace {
+
+// Buffers smaller than this are decrypted on the calling thread
+constexpr std::size_t ParallelThreshold = 1024 * 1024;
+constexpr std::size_t MinChunkSize = 256 * 1024;
+constexpr std::size_t MaxChunks = 8;
+constexpr std::size_t MaxCachedSchedules = 16;
+
+struct KeySchedule {
+    explicit KeySchedule(const AESKey& key) : key(key) {
+        encryption.SetKey(key.data(), key.size());
+        decryption.SetKey(key.data(), key.size());
+    }
+
+    AESKey key;
+    // Crypto++ ciphers use internal workspace while processing data, so these are never used
+    // directly. Each chunk copies the one it needs, which is much cheaper than expanding the key.
+    // CTR mode only uses the encryption direction of the block cipher.
+    CryptoPP::AES::Encryption encryption;
+    CryptoPP::AES::Decryption decryption;
+};
+
+/// Returns the expanded key, keeping the most recently used ones around. Reads of a title switch
+/// between a handful of keys, so expanding them on each call is wasted work.
+std::shared_ptr<KeySchedule> GetKeySchedule(const AESKey& key) {
+    static std::mutex mutex;
+    static std::vector<std::shared_ptr<KeySchedule>> schedules;
+
+    std::scoped_lock lock{mutex};
+    const auto it = std::find_if(schedules.begin(), schedules.end(),
+                                 [&key](const auto& schedule) { return schedule->key == key; });
+    if (it != schedules.end()) {
+        std::rotate(schedules.begin(), it, it + 1);
+        return schedules.front();
+    }
+
+    if (schedules.size() >= MaxCachedSchedules) {
+        schedules.pop_back();
+    }
+    schedules.insert(schedules.begin(), std::make_shared<KeySchedule>(key));
+    return schedules.front();
+}
+
+Common::ThreadWorker* GetWorkers() {
+    static const std::size_t num_workers =
+        std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1U), MaxChunks) - 1;
+    if (num_workers == 0) {
+        return nullptr;
+    }
+    static Common::ThreadWorker workers(num_workers, "AES");
+    return &workers;
+}
+
+struct ChunkLayout {
+    std::size_t count;
+    std::size_t size;
+};
+
+ChunkLayout GetChunkLayout(std::size_t size) {
+    Common::ThreadWorker* workers = size >= ParallelThreshold ? GetWorkers() : nullptr;
+    if (!workers) {
+        return {1, size};
+    }
+    const std::size_t count =
+        std::clamp<std::size_t>(size / MinChunkSize, 1, workers->NumWorkers() + 1);
+    const std::size_t chunk_size = Common::AlignUp(size / count, AES_BLOCK_SIZE);
+    return {(size + chunk_size - 1) / chunk_size, chunk_size};
+}
+
+/// Calls func(index, begin, end) for every chunk of the layout, the first one on this thread.
+template <typename Func>
+void RunChunks(const ChunkLayout& layout, std::size_t size, Func&& func) {
+    if (layout.count == 1) {
+        func(0, 0, size);
+        return;
+    }
+
+    Common::ThreadWorker* workers = GetWorkers();
+    std::latch done{static_cast<std::ptrdiff_t>(layout.count - 1)};
+    for (std::size_t i = 1; i < layout.count; i++) {
+        const std::size_t begin = i * layout.size;
+        const std::size_t end = std::min(size, begin + layout.size);
+        workers->QueueWork([&func, &done, i, begin, end] {
+            func(i, begin, end);
+            done.count_down();
+        });
+    }
+    func(0, 0, std::min(size, layout.size));
+    done.wait();
+}
+
+} // Anonymous namespace
+
+void DecryptCTR(std::span<u8> data, const AESKey& key, const AESIV& ctr, u64 offset) {
+    if (data.empty()) {
+        return; // Crypto++ does not like zero size buffer
+    }
+    const auto schedule = GetKeySchedule(key);
+
+    // Every chunk seeks the counter to its own position, so the chunks are independent
+    RunChunks(GetChunkLayout(data.size()), data.size(),
+              [&](std::size_t, std::size_t begin, std::size_t end) {
+                  CryptoPP::AES::Encryption cipher{schedule->encryption};
+                  CryptoPP::CTR_Mode_ExternalCipher::Decryption d(cipher, ctr.data());
+                  d.Seek(offset + begin);
+                  d.ProcessData(data.data() + begin, data.data() + begin, end - begin);
+              });
+}
+
+void DecryptCBC(std::span<u8> data, const AESKey& key, AESIV& iv) {
+    const std::size_t size = Common::AlignDown(data.size(), AES_BLOCK_SIZE);
+    if (size == 0) {
+        return;
+    }
+    const auto schedule = GetKeySchedule(key);
+
+    // Each chunk is chained to the last cipher block of the previous one, which has to be saved
+    // before the previous chunk is decrypted in place
+    const ChunkLayout layout = GetChunkLayout(size);
+    std::array<AESIV, MaxChunks> chunk_ivs;
+    chunk_ivs[0] = iv;
+    for (std::size_t i = 1; i < layout.count; i++) {
+        std::memcpy(chunk_ivs[i].data(), data.data() + i * layout.size - AES_BLOCK_SIZE,
+                    AES_BLOCK_SIZE);
+    }
+    std::memcpy(iv.data(), data.data() + size - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+
+    RunChunks(layout, size, [&](std::size_t index, std::size_t begin, std::size_t end) {
+        CryptoPP::AES::Decryption cipher{schedule->decryption};
+        CryptoPP::CBC_Mode_ExternalCipher::Decryption d(cipher, chunk_ivs[index].data());
+        d.ProcessData(data.data() + begin, data.data() + begin, end - begin);
+    });
+}
+
+} // namespace HW::AES
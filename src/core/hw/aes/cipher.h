@@ -0,0 +1,31 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include "common/common_types.h"
+#include "core/hw/aes/key.h"
+
+namespace HW::AES {
+
+/**
+ * Decrypts data in place using AES-CTR. Large buffers are split between several threads.
+ * @param data The data to decrypt
+ * @param key The normal key to use
+ * @param ctr The initial counter of the encrypted stream
+ * @param offset The byte offset of the data in the encrypted stream
+ */
+void DecryptCTR(std::span<u8> data, const AESKey& key, const AESIV& ctr, u64 offset = 0);
+
+/**
+ * Decrypts data in place using AES-CBC. Large buffers are split between several threads. Only
+ * whole blocks are decrypted.
+ * @param data The data to decrypt
+ * @param key The normal key to use
+ * @param iv The IV of the data, updated to the IV of the data following it
+ */
+void DecryptCBC(std::span<u8> data, const AESKey& key, AESIV& iv);
+
+} // namespace HW::AES
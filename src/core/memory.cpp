@@ -3,7 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
 #include <cstring>
+#include <ostream>
+#include <span>
+#include <stdexcept>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
 #include "audio_core/dsp_interface.h"
@@ -11,6 +15,7 @@
 #include "common/assert.h"
 #include "common/atomic_ops.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
 #include "common/swap.h"
@@ -30,10 +35,26 @@ SERIALIZE_EXPORT_IMPL(Memory::MemorySystem::BackingMemImpl<Memory::Region::N3DS>
 
 namespace Memory {
 
+namespace {
+
+/**
+ * Bumped whenever the mapping of any page table changes. Translations cached by the software TLB
+ * are only valid for the generation they were resolved in, so this is all it takes to invalidate
+ * the TLBs of every thread.
+ */
+std::atomic<u64> tlb_generation{1};
+
+void InvalidateTLB() {
+    tlb_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+} // Anonymous namespace
+
 void PageTable::Clear() {
     pointers.raw.fill(nullptr);
     pointers.refs.fill(MemoryRef());
     attributes.fill(PageType::Unmapped);
+    InvalidateTLB();
 }
 
 class RasterizerCacheMarker {
@@ -98,6 +119,7 @@ public:
     std::vector<std::shared_ptr<PageTable>> page_table_list;
 
     AudioCore::DspInterface* dsp = nullptr;
+    SavestateContext savestate_context;
 
     std::shared_ptr<BackingMem> fcram_mem;
     std::shared_ptr<BackingMem> vram_mem;
@@ -155,6 +177,55 @@ public:
         return system.Kernel().GetRunningCore().GetPC();
     }
 
+    /// Host pointer and physical address of the start of a rasterizer cached page.
+    struct RasterizerCachedPage {
+        u8* pointer;
+        PAddr paddr;
+    };
+
+    /**
+     * Resolves a rasterizer cached page of the provided page table. The translation involves a
+     * region search and, for the plugin framebuffer, a service lookup, so the result is kept in a
+     * small direct mapped TLB. The TLB is per host thread, which means per core when the cores
+     * run in parallel, and needs no locking.
+     */
+    RasterizerCachedPage LookupRasterizerCachedPage(const PageTable& page_table,
+                                                    std::size_t page_index) {
+        struct TLBEntry {
+            u64 generation;
+            const PageTable* page_table;
+            std::size_t page_index;
+            RasterizerCachedPage page;
+        };
+        static constexpr std::size_t TLB_SIZE = 256;
+        thread_local std::array<TLBEntry, TLB_SIZE> tlb{};
+
+        const u64 generation = tlb_generation.load(std::memory_order_acquire);
+        TLBEntry& entry = tlb[page_index % TLB_SIZE];
+        if (entry.generation == generation && entry.page_table == &page_table &&
+            entry.page_index == page_index) {
+            return entry.page;
+        }
+
+        const VAddr page_vaddr = static_cast<VAddr>(page_index << CITRA_PAGE_BITS);
+        u8* pointer = GetPointerForRasterizerCache(page_vaddr);
+        const bool is_vram = pointer >= vram.get() && pointer < vram.get() + VRAM_SIZE;
+        const PAddr paddr = is_vram ? VRAM_PADDR + static_cast<PAddr>(pointer - vram.get())
+                                    : FCRAM_PADDR + static_cast<PAddr>(pointer - fcram.get());
+        entry = TLBEntry{generation, &page_table, page_index, {pointer, paddr}};
+        return entry.page;
+    }
+
+    /// Returns the host pointer of a rasterizer cached address after flushing the range from the
+    /// rasterizer with the provided mode.
+    u8* FlushRasterizerCachedMemory(const PageTable& page_table, VAddr vaddr, u32 size,
+                                    FlushMode mode) {
+        const auto page = LookupRasterizerCachedPage(page_table, vaddr >> CITRA_PAGE_BITS);
+        const u32 page_offset = vaddr & CITRA_PAGE_MASK;
+        RasterizerFlushPhysicalRegion(page.paddr + page_offset, size, mode);
+        return page.pointer + page_offset;
+    }
+
     template <bool UNSAFE>
     void ReadBlockImpl(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
                        const std::size_t size) {
@@ -185,11 +256,12 @@ public:
                 break;
             }
             case PageType::RasterizerCachedMemory: {
+                const auto page = LookupRasterizerCachedPage(page_table, page_index);
                 if constexpr (!UNSAFE) {
-                    RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                                 FlushMode::Flush);
+                    RasterizerFlushPhysicalRegion(page.paddr + static_cast<u32>(page_offset),
+                                                  static_cast<u32>(copy_amount), FlushMode::Flush);
                 }
-                std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
+                std::memcpy(dest_buffer, page.pointer + page_offset, copy_amount);
                 break;
             }
             default:
@@ -231,11 +303,13 @@ public:
                 break;
             }
             case PageType::RasterizerCachedMemory: {
+                const auto page = LookupRasterizerCachedPage(page_table, page_index);
                 if constexpr (!UNSAFE) {
-                    RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                                 FlushMode::Invalidate);
+                    RasterizerFlushPhysicalRegion(page.paddr + static_cast<u32>(page_offset),
+                                                  static_cast<u32>(copy_amount),
+                                                  FlushMode::Invalidate);
                 }
-                std::memcpy(GetPointerForRasterizerCache(current_vaddr), src_buffer, copy_amount);
+                std::memcpy(page.pointer + page_offset, src_buffer, copy_amount);
                 break;
             }
             default:
@@ -280,24 +354,11 @@ public:
                 return;
             }
 
-            auto& renderer = system.GPU().Renderer();
             VAddr overlap_start = std::max(start, region_start);
             VAddr overlap_end = std::min(end, region_end);
             PAddr physical_start = paddr_region_start + (overlap_start - region_start);
             u32 overlap_size = overlap_end - overlap_start;
-
-            auto* rasterizer = renderer.Rasterizer();
-            switch (mode) {
-            case FlushMode::Flush:
-                rasterizer->FlushRegion(physical_start, overlap_size);
-                break;
-            case FlushMode::Invalidate:
-                rasterizer->InvalidateRegion(physical_start, overlap_size);
-                break;
-            case FlushMode::FlushAndInvalidate:
-                rasterizer->FlushAndInvalidateRegion(physical_start, overlap_size);
-                break;
-            }
+            RasterizerFlushPhysicalRegion(physical_start, overlap_size, mode);
         };
 
         CheckRegion(LINEAR_HEAP_VADDR, LINEAR_HEAP_VADDR_END, FCRAM_PADDR);
@@ -309,17 +370,53 @@ public:
         }
     }
 
+    void RasterizerFlushPhysicalRegion(PAddr start, u32 size, FlushMode mode) {
+        auto* rasterizer = system.GPU().Renderer().Rasterizer();
+        switch (mode) {
+        case FlushMode::Flush:
+            rasterizer->FlushRegion(start, size);
+            break;
+        case FlushMode::Invalidate:
+            rasterizer->InvalidateRegion(start, size);
+            break;
+        case FlushMode::FlushAndInvalidate:
+            rasterizer->FlushAndInvalidateRegion(start, size);
+            break;
+        }
+    }
+
+    /// Memory regions that savestates store the contents of, in the order of SavestatePageHashes
+    std::array<std::span<u8>, 3> GetSavestateRegions(bool save_n3ds_ram) {
+        return {
+            std::span{vram.get(), Memory::VRAM_SIZE},
+            std::span{fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE},
+            std::span{n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0},
+        };
+    }
+
 private:
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int file_version) {
+        InvalidateTLB();
         bool save_n3ds_ram = Settings::values.is_new_3ds.GetValue();
         ar& save_n3ds_ram;
-        ar& boost::serialization::make_binary_object(vram.get(), Memory::VRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+        const auto regions = GetSavestateRegions(save_n3ds_ram);
+        for (std::size_t i = 0; i < regions.size(); i++) {
+            if (savestate_context.page_store) {
+                SerializeStoredPages(ar, regions[i]);
+                continue;
+            }
+            if (savestate_context.incremental) {
+                std::span<const u64> base_hashes;
+                if constexpr (Archive::is_saving::value) {
+                    base_hashes = (*savestate_context.page_hashes)[i];
+                }
+                SerializeChangedPages(ar, regions[i], base_hashes, savestate_context.read_base);
+                continue;
+            }
+            ar& boost::serialization::make_binary_object(regions[i].data(), regions[i].size());
+        }
         ar& cache_marker;
         ar& page_table_list;
         // dsp is set from Core::System at startup
@@ -329,6 +426,30 @@ private:
         ar& n3ds_extra_ram_mem;
         ar& dsp_mem;
     }
+
+    /// Stores the pages of a memory region in the page store of the savestate and serializes their
+    /// keys, or restores the pages identified by the keys when loading.
+    template <class Archive>
+    void SerializeStoredPages(Archive& ar, std::span<u8> data) {
+        const std::size_t num_pages = data.size() / CITRA_PAGE_SIZE;
+        auto& store = *savestate_context.page_store;
+        std::vector<u64> keys;
+        if constexpr (Archive::is_saving::value) {
+            keys.resize(num_pages);
+            for (std::size_t page = 0; page < num_pages; page++) {
+                keys[page] = store.StorePage(data.subspan(page * CITRA_PAGE_SIZE, CITRA_PAGE_SIZE));
+            }
+        }
+        ar& keys;
+        if constexpr (Archive::is_loading::value) {
+            if (keys.size() != num_pages) {
+                throw std::runtime_error("Savestate memory region size does not match");
+            }
+            for (std::size_t page = 0; page < num_pages; page++) {
+                store.LoadPage(keys[page], data.subspan(page * CITRA_PAGE_SIZE, CITRA_PAGE_SIZE));
+            }
+        }
+    }
 };
 
 // We use this rather than BufferMem because we don't want new objects to be allocated when
@@ -395,6 +516,7 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
         RasterizerFlushVirtualRegion(base << CITRA_PAGE_BITS, size * CITRA_PAGE_SIZE,
                                      FlushMode::FlushAndInvalidate);
     }
+    InvalidateTLB();
 
     u32 end = base + size;
     while (base != end) {
@@ -441,6 +563,7 @@ void MemorySystem::UnregisterPageTable(std::shared_ptr<PageTable> page_table) {
     if (it != impl->page_table_list.end()) {
         impl->page_table_list.erase(it);
     }
+    InvalidateTLB();
 }
 
 template <typename T>
@@ -478,10 +601,10 @@ T MemorySystem::Read(const VAddr vaddr) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         break;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Flush);
-
+        const u8* pointer = impl->FlushRasterizerCachedMemory(*impl->current_page_table, vaddr,
+                                                              sizeof(T), FlushMode::Flush);
         T value;
-        std::memcpy(&value, GetPointerForRasterizerCache(vaddr), sizeof(T));
+        std::memcpy(&value, pointer, sizeof(T));
         return value;
     }
     default:
@@ -527,8 +650,9 @@ void MemorySystem::Write(const VAddr vaddr, const T data) {
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         break;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
-        std::memcpy(GetPointerForRasterizerCache(vaddr), &data, sizeof(T));
+        u8* pointer = impl->FlushRasterizerCachedMemory(*impl->current_page_table, vaddr,
+                                                        sizeof(T), FlushMode::Invalidate);
+        std::memcpy(pointer, &data, sizeof(T));
         break;
     }
     default:
@@ -556,9 +680,9 @@ bool MemorySystem::WriteExclusive(const VAddr vaddr, const T data, const T expec
         ASSERT_MSG(false, "Mapped memory page without a pointer @ {:08X}", vaddr);
         return true;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushVirtualRegion(vaddr, sizeof(T), FlushMode::Invalidate);
-        const auto volatile_pointer =
-            reinterpret_cast<volatile T*>(GetPointerForRasterizerCache(vaddr).GetPtr());
+        u8* pointer = impl->FlushRasterizerCachedMemory(*impl->current_page_table, vaddr,
+                                                        sizeof(T), FlushMode::Invalidate);
+        const auto volatile_pointer = reinterpret_cast<volatile T*>(pointer);
         return Common::AtomicCompareAndSwap(volatile_pointer, data, expected);
     }
     default:
@@ -594,7 +718,9 @@ u8* MemorySystem::GetPointer(const VAddr vaddr) {
 
     if (impl->current_page_table->attributes[vaddr >> CITRA_PAGE_BITS] ==
         PageType::RasterizerCachedMemory) {
-        return GetPointerForRasterizerCache(vaddr);
+        const auto page =
+            impl->LookupRasterizerCachedPage(*impl->current_page_table, vaddr >> CITRA_PAGE_BITS);
+        return page.pointer + (vaddr & CITRA_PAGE_MASK);
     }
 
     LOG_ERROR(HW_Memory, "unknown GetPointer @ 0x{:08x} at PC 0x{:08X}", vaddr, impl->GetPC());
@@ -616,6 +742,19 @@ const u8* MemorySystem::GetPointer(const VAddr vaddr) const {
     return nullptr;
 }
 
+u8* MemorySystem::GetPlainMemoryPointer(const Kernel::Process& process, VAddr vaddr,
+                                        std::size_t size) {
+    if ((vaddr & CITRA_PAGE_MASK) + size > CITRA_PAGE_SIZE) {
+        return nullptr;
+    }
+    auto& page_table = *process.vm_manager.page_table;
+    const std::size_t page_index = vaddr >> CITRA_PAGE_BITS;
+    if (page_table.attributes[page_index] != PageType::Memory) {
+        return nullptr;
+    }
+    return page_table.pointers[page_index] + (vaddr & CITRA_PAGE_MASK);
+}
+
 std::string MemorySystem::ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
@@ -634,6 +773,15 @@ std::string MemorySystem::ReadCString(VAddr vaddr, std::size_t max_length) {
 }
 
 u8* MemorySystem::GetPhysicalPointer(PAddr address) const {
+    // The GPU resolves addresses per vertex attribute and per command list, so skip building a
+    // MemoryRef and its reference count updates for the regions it uses.
+    // Note: the region end checks are inclusive to match GetPhysicalRef
+    if (address >= VRAM_PADDR && address <= VRAM_PADDR_END) {
+        return impl->vram.get() + (address - VRAM_PADDR);
+    }
+    if (address >= FCRAM_PADDR && address <= FCRAM_N3DS_PADDR_END) {
+        return impl->fcram.get() + (address - FCRAM_PADDR);
+    }
     return GetPhysicalRef(address);
 }
 
@@ -711,11 +859,16 @@ std::vector<VAddr> MemorySystem::PhysicalToVirtualAddressForRasterizer(PAddr add
     return {};
 }
 
+void MemorySystem::InvalidateRasterizerCachedTLB() {
+    InvalidateTLB();
+}
+
 void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached) {
     if (start < VRAM_PADDR) {
         LOG_ERROR(HW_Memory, "Using invalid physical address for rasterizer: {:08X}", start);
         return;
     }
+    InvalidateTLB();
 
     u32 num_pages = ((start + size - 1) >> CITRA_PAGE_BITS) - (start >> CITRA_PAGE_BITS) + 1;
     PAddr paddr = start;
@@ -857,9 +1010,9 @@ void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_ad
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memset(GetPointerForRasterizerCache(current_vaddr), 0, copy_amount);
+            u8* dest_ptr = impl->FlushRasterizerCachedMemory(
+                page_table, current_vaddr, static_cast<u32>(copy_amount), FlushMode::Invalidate);
+            std::memset(dest_ptr, 0, copy_amount);
             break;
         }
         default:
@@ -905,10 +1058,9 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            WriteBlock(dest_process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
-                       copy_amount);
+            const u8* src_ptr = impl->FlushRasterizerCachedMemory(
+                page_table, current_vaddr, static_cast<u32>(copy_amount), FlushMode::Flush);
+            WriteBlock(dest_process, dest_addr, src_ptr, copy_amount);
             break;
         }
         default:
@@ -947,4 +1099,25 @@ void MemorySystem::SetDSP(AudioCore::DspInterface& dsp) {
     impl->dsp = &dsp;
 }
 
+void MemorySystem::SetSavestateContext(const SavestateContext& context) {
+    impl->savestate_context = context;
+}
+
+void MemorySystem::SaveBaseMemory(std::ostream& stream, SavestatePageHashes& page_hashes) {
+    const auto regions = impl->GetSavestateRegions(Settings::values.is_new_3ds.GetValue());
+    for (std::size_t i = 0; i < regions.size(); i++) {
+        stream.write(reinterpret_cast<const char*>(regions[i].data()),
+                     static_cast<std::streamsize>(regions[i].size()));
+        page_hashes[i] = HashSavestatePages(regions[i]);
+    }
+}
+
+std::vector<u64> HashSavestatePages(std::span<const u8> data) {
+    std::vector<u64> hashes(data.size() / CITRA_PAGE_SIZE);
+    for (std::size_t page = 0; page < hashes.size(); page++) {
+        hashes[page] = Common::ComputeHash64(data.data() + page * CITRA_PAGE_SIZE, CITRA_PAGE_SIZE);
+    }
+    return hashes;
+}
+
 } // namespace Memory
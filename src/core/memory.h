@@ -5,8 +5,13 @@
 #pragma once
 #include <array>
 #include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <boost/serialization/array.hpp>
+#include <boost/serialization/binary_object.hpp>
 #include <boost/serialization/vector.hpp>
 #include "common/common_types.h"
 #include "common/memory_ref.h"
@@ -235,6 +240,74 @@ enum class FlushMode {
     FlushAndInvalidate,
 };
 
+class MemorySystem;
+
+/// Hashes of each page of the VRAM, FCRAM and New 3DS memory regions, in that order.
+using SavestatePageHashes = std::array<std::vector<u64>, 3>;
+
+/**
+ * Keeps the memory pages of savestates outside of the serialized data, so that pages which are
+ * identical between states are only stored once.
+ */
+class SavestatePageStore {
+public:
+    virtual ~SavestatePageStore() = default;
+
+    /// Stores the contents of a page and returns the key that identifies it.
+    virtual u64 StorePage(std::span<const u8> page) = 0;
+
+    /// Copies the contents of a previously stored page.
+    virtual void LoadPage(u64 key, std::span<u8> page) const = 0;
+};
+
+/**
+ * Controls how the memory contents are stored in a savestate. Full states store every page.
+ * Incremental states only store the pages whose hash differs from the ones recorded for their base
+ * state, the remaining pages are read from the base state when loading.
+ */
+struct SavestateContext {
+    bool incremental = false;
+    /// Page hashes of the base state, required to save an incremental state.
+    const SavestatePageHashes* page_hashes = nullptr;
+    /// Reads the next bytes of the base state memory, required to load an incremental state.
+    std::function<void(std::span<u8>)> read_base;
+    /// When set, only the keys of the pages in this store are serialized.
+    SavestatePageStore* page_store = nullptr;
+};
+
+/// Hashes every page of a memory region, as recorded for the base of incremental savestates.
+std::vector<u64> HashSavestatePages(std::span<const u8> data);
+
+/**
+ * Stores the pages of a memory region whose hash differs from base_hashes. When loading, the
+ * region is first filled by read_base and the stored pages are applied on top.
+ */
+template <class Archive>
+void SerializeChangedPages(Archive& ar, std::span<u8> data, std::span<const u64> base_hashes,
+                           const std::function<void(std::span<u8>)>& read_base) {
+    const std::size_t num_pages = data.size() / CITRA_PAGE_SIZE;
+    std::vector<u32> changed_pages;
+    if constexpr (Archive::is_saving::value) {
+        const std::vector<u64> hashes = HashSavestatePages(data);
+        for (u32 page = 0; page < num_pages; page++) {
+            if (page >= base_hashes.size() || base_hashes[page] != hashes[page]) {
+                changed_pages.push_back(page);
+            }
+        }
+    } else {
+        read_base(data);
+    }
+
+    ar& changed_pages;
+    for (const u32 page : changed_pages) {
+        if (page >= num_pages) {
+            throw std::runtime_error("Savestate contains an out of range memory page");
+        }
+        ar& boost::serialization::make_binary_object(data.data() + page * CITRA_PAGE_SIZE,
+                                                     CITRA_PAGE_SIZE);
+    }
+}
+
 class MemorySystem {
 public:
     explicit MemorySystem(Core::System& system);
@@ -276,6 +349,14 @@ public:
      */
     const u8* GetPointer(VAddr vaddr) const;
 
+    /**
+     * Gets a pointer to a block of a process' address space that can be accessed in place.
+     *
+     * @returns The pointer to the block, or nullptr if it crosses a page boundary or is not backed
+     *          by plain memory, in which case ReadBlock/WriteBlock must be used.
+     */
+    u8* GetPlainMemoryPointer(const Kernel::Process& process, VAddr vaddr, std::size_t size);
+
     /**
      * Reads an 8-bit unsigned value from the current process' address space
      * at the given virtual address.
@@ -516,6 +597,12 @@ public:
      */
     void RasterizerMarkRegionCached(PAddr start, u32 size, bool cached);
 
+    /**
+     * Drops the cached translations of rasterizer cached pages. Needed whenever the address such a
+     * page translates to changes without a page table update, like for the plugin framebuffer.
+     */
+    void InvalidateRasterizerCachedTLB();
+
     /// For a rasterizer-accessible PAddr, gets a list of all possible VAddr
     std::vector<VAddr> PhysicalToVirtualAddressForRasterizer(PAddr addr);
 
@@ -551,6 +638,15 @@ public:
 
     void SetDSP(AudioCore::DspInterface& dsp);
 
+    /// Sets how the memory contents are stored by the next savestate (de)serialization.
+    void SetSavestateContext(const SavestateContext& context);
+
+    /**
+     * Writes the VRAM, FCRAM and New 3DS memory to a stream as they are and records the hash of
+     * every page. This is the base that incremental savestates store their changed pages against.
+     */
+    void SaveBaseMemory(std::ostream& stream, SavestatePageHashes& page_hashes);
+
     void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
 private:
@@ -4,11 +4,13 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iterator>
 #include <mutex>
 #include <numeric>
 #include <sstream>
 #include <thread>
+#include <vector>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include "common/file_util.h"
@@ -87,7 +89,24 @@ double PerfStats::GetMeanFrametime() const {
     return sum / static_cast<double>(current_index - IgnoreFrames);
 }
 
-PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us) {
+double PerfStats::GetFrametimePercentile(double percentile) const {
+    std::scoped_lock lock{object_mutex};
+
+    if (current_index <= IgnoreFrames) {
+        return 0;
+    }
+
+    std::vector<double> frametimes(perf_history.begin() + IgnoreFrames,
+                                   perf_history.begin() + current_index);
+    const double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 *
+                        static_cast<double>(frametimes.size() - 1);
+    const auto nth = frametimes.begin() + static_cast<std::ptrdiff_t>(std::ceil(rank));
+    std::nth_element(frametimes.begin(), nth, frametimes.end());
+    return *nth;
+}
+
+PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_us,
+                                               AudioCounters audio_counters) {
     std::scoped_lock lock{object_mutex};
 
     const auto now = Clock::now();
@@ -102,9 +121,17 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
                            static_cast<double>(system_frames);
     last_stats.emulation_speed = system_us_per_second.count() / 1'000'000.0;
 
+    // The audio counters start over when the DSP is recreated
+    const auto since_reset = [](u64 count, u64 reset_count) {
+        return static_cast<u32>(count >= reset_count ? count - reset_count : count);
+    };
+    last_stats.audio_underruns = since_reset(audio_counters.underruns, reset_point_audio.underruns);
+    last_stats.audio_overruns = since_reset(audio_counters.overruns, reset_point_audio.overruns);
+
     // Reset counters
     reset_point = now;
     reset_point_system_us = current_system_time_us;
+    reset_point_audio = audio_counters;
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
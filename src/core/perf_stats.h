@@ -34,13 +34,24 @@ public:
         double frametime;
         /// Ratio of walltime / emulated time elapsed
         double emulation_speed;
+        /// Number of times the audio output ran out of samples
+        u32 audio_underruns;
+        /// Number of times samples were dropped because the audio output was full
+        u32 audio_overruns;
+    };
+
+    /// Cumulative counters of the audio output, sampled along with the other statistics
+    struct AudioCounters {
+        u64 underruns;
+        u64 overruns;
     };
 
     void BeginSystemFrame();
     void EndSystemFrame();
     void EndGameFrame();
 
-    Results GetAndResetStats(std::chrono::microseconds current_system_time_us);
+    Results GetAndResetStats(std::chrono::microseconds current_system_time_us,
+                             AudioCounters audio_counters);
 
     Results GetLastStats();
 
@@ -49,6 +60,12 @@ public:
      */
     double GetMeanFrametime() const;
 
+    /**
+     * Returns the frametime value, in milliseconds, that the given percentage (0 to 100) of the
+     * frames stored in the performance history do not exceed.
+     */
+    double GetFrametimePercentile(double percentile) const;
+
     /**
      * Gets the ratio between walltime and the emulated time of the previous system frame. This is
      * useful for scaling inputs or outputs moving between the two time domains.
@@ -70,6 +87,8 @@ private:
     Clock::time_point reset_point = Clock::now();
     /// System time when the cumulative counters were reset
     std::chrono::microseconds reset_point_system_us{0};
+    /// Audio output counters when the cumulative counters were reset
+    AudioCounters reset_point_audio{};
 
     /// Cumulative duration (excluding v-sync/frame-limiting) of frames since last reset
     Clock::duration accumulated_frametime = Clock::duration::zero();
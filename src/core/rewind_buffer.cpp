@@ -0,0 +1,227 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "core/rewind_buffer.h"
+
+namespace Core {
+
+namespace {
+/// Compression level of the snapshots, the fastest one as they are taken while the game runs
+constexpr s32 RewindCompressionLevel = 1;
+/// Approximate bookkeeping cost of a page in the pool, on top of its compressed data
+constexpr std::size_t PageOverhead = 64;
+} // Anonymous namespace
+
+RewindBuffer::RewindBuffer(std::size_t memory_budget_)
+    : memory_budget{memory_budget_}, context{RewindCompressionLevel}, worker{1, "RewindBuffer"} {}
+
+RewindBuffer::~RewindBuffer() = default;
+
+void RewindBuffer::BeginSnapshot() {
+    // The staged pages of the previous snapshot are still read until it is stored
+    WaitForWorker();
+    ReleasePages(current.pages);
+    current = {};
+    staged.clear();
+    num_copied_pages = 0;
+}
+
+void RewindBuffer::EndSnapshot(std::span<const u8> state) {
+    // The next snapshot is compared against this one
+    base_hashes.resize(staged.size());
+    for (std::size_t i = 0; i < staged.size(); i++) {
+        base_hashes[i] = staged[i].hash;
+    }
+    worker.QueueWork([this, state = std::vector<u8>(state.begin(), state.end()),
+                      num_pages = staged.size()]() mutable {
+        StoreSnapshot(std::move(state), num_pages);
+    });
+}
+
+void RewindBuffer::AbortSnapshot() {
+    staged.clear();
+    num_copied_pages = 0;
+}
+
+std::optional<std::vector<u8>> RewindBuffer::RestoreSnapshot(u32 steps) {
+    WaitForWorker();
+    if (steps == 0 || snapshots.empty()) {
+        return std::nullopt;
+    }
+    steps = std::min<u32>(steps, static_cast<u32>(snapshots.size()));
+    for (u32 i = 1; i < steps; i++) {
+        ReleaseSnapshot(snapshots.back());
+        snapshots.pop_back();
+    }
+
+    // Keep the pages of the restored snapshot alive while the state is being loaded
+    ReleasePages(current.pages);
+    current = std::move(snapshots.back());
+    snapshots.pop_back();
+    total_size -= current.state.size() + current.pages.size() * sizeof(u64);
+
+    std::vector<u8> state(current.state_size);
+    if (!context.Decompress(current.state, state)) {
+        return std::nullopt;
+    }
+    return state;
+}
+
+void RewindBuffer::Clear() {
+    WaitForWorker();
+    snapshots.clear();
+    current = {};
+    pages.clear();
+    total_size = 0;
+    num_copied_pages = 0;
+    // Release the memory of the staging buffer and the base along with the pages
+    staged = std::vector<StagedPage>{};
+    staged_pages = std::vector<u8>{};
+    base_hashes = std::vector<PageHash>{};
+    base_keys = std::vector<u64>{};
+}
+
+std::size_t RewindBuffer::GetSnapshotCount() const {
+    WaitForWorker();
+    return snapshots.size();
+}
+
+std::size_t RewindBuffer::GetSize() const {
+    WaitForWorker();
+    return GetUsedMemory();
+}
+
+u64 RewindBuffer::StorePage(std::span<const u8> page) {
+    ASSERT(page.size() == Memory::CITRA_PAGE_SIZE);
+    const u64 index = staged.size();
+    const PageHash hash =
+        Common::CityHash128(reinterpret_cast<const char*>(page.data()), page.size());
+    if (index < base_hashes.size() && base_hashes[index] == hash) {
+        staged.push_back({hash, NotCopied});
+        return index;
+    }
+
+    const std::size_t offset = num_copied_pages * Memory::CITRA_PAGE_SIZE;
+    if (staged_pages.size() < offset + Memory::CITRA_PAGE_SIZE) {
+        staged_pages.resize(offset + Memory::CITRA_PAGE_SIZE);
+    }
+    std::memcpy(staged_pages.data() + offset, page.data(), page.size());
+    staged.push_back({hash, static_cast<u32>(num_copied_pages++)});
+    return index;
+}
+
+void RewindBuffer::LoadPage(u64 key, std::span<u8> page) const {
+    if (key >= current.pages.size()) {
+        throw std::runtime_error("Rewind snapshot references an invalid memory page");
+    }
+    const auto it = pages.find(current.pages[key]);
+    if (it == pages.end() || !context.Decompress(it->second.data, page)) {
+        throw std::runtime_error("Rewind snapshot references an invalid memory page");
+    }
+}
+
+void RewindBuffer::StoreSnapshot(std::vector<u8> state, std::size_t num_pages) {
+    Snapshot snapshot;
+    snapshot.pages.reserve(num_pages);
+    std::size_t num_copied = 0;
+    for (std::size_t i = 0; i < num_pages; i++) {
+        const StagedPage& page = staged[i];
+        if (page.copy == NotCopied) {
+            snapshot.pages.push_back(base_keys[i]);
+            pages.at(base_keys[i]).references++;
+            continue;
+        }
+        snapshot.pages.push_back(AddPage(page.hash, std::span<const u8>{staged_pages}.subspan(
+                                                        page.copy * Memory::CITRA_PAGE_SIZE,
+                                                        Memory::CITRA_PAGE_SIZE)));
+        num_copied++;
+    }
+
+    // The first snapshot copies every page, later ones usually only need a fraction of that
+    const std::size_t copied_size = num_copied * Memory::CITRA_PAGE_SIZE;
+    if (staged_pages.size() > 2 * copied_size) {
+        staged_pages.resize(copied_size);
+        staged_pages.shrink_to_fit();
+    }
+
+    // The pages of the base have to stay in the pool even if the snapshot is dropped
+    AcquirePages(snapshot.pages);
+    ReleasePages(base_keys);
+    base_keys = snapshot.pages;
+
+    snapshot.state = context.Compress(state);
+    snapshot.state_size = state.size();
+    if (snapshot.state.empty()) {
+        LOG_ERROR(Core, "Failed to compress rewind snapshot");
+        ReleasePages(snapshot.pages);
+        return;
+    }
+    total_size += snapshot.state.size() + snapshot.pages.size() * sizeof(u64);
+    snapshots.push_back(std::move(snapshot));
+
+    while (GetUsedMemory() > memory_budget && snapshots.size() > 1) {
+        ReleaseSnapshot(snapshots.front());
+        snapshots.pop_front();
+    }
+}
+
+u64 RewindBuffer::AddPage(const PageHash& hash, std::span<const u8> page) {
+    // Identical pages share their hash. A different page whose hash has the same low half moves
+    // on to the next free key.
+    u64 key = Common::Uint128Low64(hash);
+    while (true) {
+        auto [it, inserted] = pages.try_emplace(key);
+        if (inserted) {
+            it->second.data = context.Compress(page);
+            it->second.hash = hash;
+            total_size += it->second.data.size() + PageOverhead;
+        } else if (it->second.hash != hash) {
+            key++;
+            continue;
+        }
+        it->second.references++;
+        return key;
+    }
+}
+
+void RewindBuffer::AcquirePages(const std::vector<u64>& keys) {
+    for (const u64 key : keys) {
+        pages.at(key).references++;
+    }
+}
+
+void RewindBuffer::ReleasePages(const std::vector<u64>& keys) {
+    for (const u64 key : keys) {
+        const auto it = pages.find(key);
+        if (it == pages.end()) {
+            LOG_ERROR(Core, "Released unknown rewind page {:016X}", key);
+            continue;
+        }
+        if (--it->second.references == 0) {
+            total_size -= it->second.data.size() + PageOverhead;
+            pages.erase(it);
+        }
+    }
+}
+
+void RewindBuffer::ReleaseSnapshot(Snapshot& snapshot) {
+    total_size -= snapshot.state.size() + snapshot.pages.size() * sizeof(u64);
+    ReleasePages(snapshot.pages);
+}
+
+std::size_t RewindBuffer::GetUsedMemory() const {
+    return total_size + staged_pages.capacity() + staged.capacity() * sizeof(StagedPage) +
+           base_hashes.capacity() * sizeof(PageHash) + base_keys.capacity() * sizeof(u64);
+}
+
+void RewindBuffer::WaitForWorker() const {
+    worker.WaitForRequests();
+}
+
+} // namespace Core
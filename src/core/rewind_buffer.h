@@ -0,0 +1,129 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "common/cityhash.h"
+#include "common/common_types.h"
+#include "common/thread_worker.h"
+#include "common/zstd_compression.h"
+#include "core/memory.h"
+
+namespace Core {
+
+/**
+ * In-memory ring of savestates used to rewind emulation. Memory pages are kept in a shared pool of
+ * individually compressed pages keyed by a 128-bit hash of their contents, so a page that did not
+ * change between snapshots is only stored once. The rest of each state is compressed separately.
+ * Once the total size exceeds the memory budget the oldest snapshots are dropped.
+ *
+ * Taking a snapshot hashes its pages and only copies the ones that changed since the previous
+ * snapshot, they are compressed on a worker thread while emulation goes on. The buffer holding the
+ * copies is reused by every snapshot and counts toward the memory budget.
+ */
+class RewindBuffer final : public Memory::SavestatePageStore {
+public:
+    explicit RewindBuffer(std::size_t memory_budget);
+    ~RewindBuffer() override;
+
+    /// Starts recording the pages stored for a new snapshot, once the previous one is stored.
+    void BeginSnapshot();
+
+    /**
+     * Adds the snapshot with the given serialized state. It is stored in the background, dropping
+     * the oldest snapshots over budget.
+     */
+    void EndSnapshot(std::span<const u8> state);
+
+    /// Discards the pages stored since BeginSnapshot, used when serialization failed.
+    void AbortSnapshot();
+
+    /**
+     * Removes the snapshot taken the given amount of snapshots ago, 1 being the newest, along with
+     * every newer snapshot and returns its decompressed state. Its pages remain available to
+     * LoadPage until the next snapshot is started or restored.
+     */
+    [[nodiscard]] std::optional<std::vector<u8>> RestoreSnapshot(u32 steps);
+
+    /// Removes all snapshots and pages and releases the staging buffer.
+    void Clear();
+
+    [[nodiscard]] std::size_t GetSnapshotCount() const;
+
+    /// Returns the amount of memory used by the snapshots, their pages and the staging buffer.
+    [[nodiscard]] std::size_t GetSize() const;
+
+    /// Adds the page to the snapshot being recorded, copying it if it changed since the previous
+    /// snapshot, and returns its index in the snapshot.
+    u64 StorePage(std::span<const u8> page) override;
+    /// Loads the page at the given index of the restored snapshot.
+    void LoadPage(u64 key, std::span<u8> page) const override;
+
+private:
+    using PageHash = Common::uint128;
+
+    struct Page {
+        std::vector<u8> data;
+        PageHash hash{};
+        u32 references{};
+    };
+
+    struct Snapshot {
+        std::vector<u8> state;
+        std::size_t state_size{};
+        std::vector<u64> pages;
+    };
+
+    /// A page of the snapshot being recorded.
+    struct StagedPage {
+        PageHash hash;
+        /// Index of the copy in staged_pages, or NotCopied if it is the page of the base snapshot
+        u32 copy;
+    };
+    static constexpr u32 NotCopied = ~0U;
+
+    /// Compresses the staged pages and the state of a snapshot, runs on the worker thread.
+    void StoreSnapshot(std::vector<u8> state, std::size_t num_pages);
+    /// Adds a page to the pool, or references the one with the same hash already there.
+    u64 AddPage(const PageHash& hash, std::span<const u8> page);
+    void AcquirePages(const std::vector<u64>& keys);
+    void ReleasePages(const std::vector<u64>& keys);
+    void ReleaseSnapshot(Snapshot& snapshot);
+    [[nodiscard]] std::size_t GetUsedMemory() const;
+    void WaitForWorker() const;
+
+    std::size_t memory_budget;
+    std::size_t total_size{};
+
+    std::deque<Snapshot> snapshots;
+    /// The last restored snapshot while it is being loaded
+    Snapshot current;
+    /// Pool of compressed pages, keyed by the low half of the hash of their contents
+    std::unordered_map<u64, Page> pages;
+
+    /// Pages of the snapshot being recorded or stored
+    std::vector<StagedPage> staged;
+    /// Copies of the pages that changed since the base snapshot
+    std::vector<u8> staged_pages;
+    std::size_t num_copied_pages{};
+
+    /**
+     * The base is the last snapshot handed to the worker, new pages are compared against it. Its
+     * hashes are used by the emulation thread, its keys by the worker, which holds a reference to
+     * them so that they outlive the snapshot.
+     */
+    std::vector<PageHash> base_hashes;
+    std::vector<u64> base_keys;
+
+    mutable Common::Compression::ZSTDContext context;
+    mutable Common::ThreadWorker worker;
+};
+
+} // namespace Core
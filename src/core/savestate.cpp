@@ -2,8 +2,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <random>
 #include <sstream>
+#include <thread>
 #include <cryptopp/hex.h>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
@@ -11,13 +19,18 @@
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
 #include "common/swap.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
 #include "core/movie.h"
+#include "core/rewind_buffer.h"
 #include "core/savestate.h"
 #include "core/savestate_data.h"
 #include "network/network.h"
+#include "video_core/gpu.h"
+#include "video_core/renderer_base.h"
 
 namespace Core {
 
@@ -29,8 +42,10 @@ struct CSTHeader {
     u64_le time;                   /// The time when this save state was created
     std::array<u8, 20> build_name; /// The build name (Canary/Nightly) with the version number
     u32_le zero = 0;               /// Should be zero, just in case.
+    u64_le state_id;               /// Random identifier of this savestate
+    u64_le base_id;                /// Identifier of the base state of an incremental state, or 0
 
-    std::array<u8, 192> reserved{}; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 176> reserved{}; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CSTHeader) == 256, "CSTHeader should be 256 bytes");
 #pragma pack(pop)
@@ -48,6 +63,23 @@ static std::string GetSaveStatePath(u64 program_id, u64 movie_id, u32 slot) {
     }
 }
 
+/// Path of the full state that the incremental states of a slot are stored relative to
+static std::string GetSaveStateBasePath(const std::string& path) {
+    return path + ".base";
+}
+
+static u64 GenerateSaveStateID() {
+    std::random_device device;
+    std::uniform_int_distribution<u64> distribution(1, std::numeric_limits<u64>::max());
+    return distribution(device);
+}
+
+/// Number of worker threads used to compress savestates, leaving one core to the emulator.
+static u32 GetCompressionThreadCount() {
+    const u32 hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? std::min(hardware_threads - 1, 4U) : 0;
+}
+
 static bool ValidateSaveState(const CSTHeader& header, SaveStateInfo& info, u64 program_id,
                               u64 movie_id) {
     const auto path = GetSaveStatePath(program_id, movie_id, info.slot);
@@ -122,22 +154,9 @@ std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id) {
     return result;
 }
 
-void System::SaveState(u32 slot) const {
-    std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
-
-    const std::string& str{sstream.str()};
-    const auto data = std::span<const u8>{reinterpret_cast<const u8*>(str.data()), str.size()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(data);
-
-    const u64 movie_id = movie.GetCurrentMovieID();
-    const auto path = GetSaveStatePath(title_id, movie_id, slot);
-    if (!FileUtil::CreateFullPath(path)) {
-        throw std::runtime_error("Could not create path " + path);
-    }
-
+/// Writes the header and the compressed contents of a savestate file, returns the state identifier
+static u64 WriteSaveStateFile(const std::string& path, u64 program_id, u64 base_id,
+                              const std::function<void(std::ostream&)>& write_contents) {
     FileUtil::IOFile file(path, "wb");
     if (!file) {
         throw std::runtime_error("Could not open file " + path);
@@ -145,7 +164,7 @@ void System::SaveState(u32 slot) const {
 
     CSTHeader header{};
     header.filetype = header_magic_bytes;
-    header.program_id = title_id;
+    header.program_id = program_id;
     std::string rev_bytes;
     CryptoPP::StringSource ss(Common::g_scm_rev, true,
                               new CryptoPP::HexDecoder(new CryptoPP::StringSink(rev_bytes)));
@@ -157,11 +176,58 @@ void System::SaveState(u32 slot) const {
     std::memset(header.build_name.data(), 0, sizeof(header.build_name));
     std::memcpy(header.build_name.data(), build_fullname.c_str(),
                 std::min(build_fullname.length(), sizeof(header.build_name) - 1));
+    header.state_id = GenerateSaveStateID();
+    header.base_id = base_id;
 
-    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
-        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
+    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header)) {
         throw std::runtime_error("Could not write to file " + path);
     }
+
+    // Write straight into the compressor instead of building the whole state in memory
+    Common::Compression::ZSTDOutputBuffer buffer{file, GetCompressionThreadCount()};
+    {
+        std::ostream stream{&buffer};
+        write_contents(stream);
+        if (!stream) {
+            throw std::runtime_error("Could not write to file " + path);
+        }
+    }
+    if (!buffer.Finish()) {
+        throw std::runtime_error("Could not write to file " + path);
+    }
+    return header.state_id;
+}
+
+void System::SaveState(u32 slot, bool incremental) {
+    const u64 movie_id = movie.GetCurrentMovieID();
+    const auto path = GetSaveStatePath(title_id, movie_id, slot);
+    if (!FileUtil::CreateFullPath(path)) {
+        throw std::runtime_error("Could not create path " + path);
+    }
+
+    Memory::SavestateContext context{};
+    if (incremental) {
+        // Incremental states only store the memory pages that changed since the base state of
+        // the slot, which holds nothing but memory. Write it when there is none for this slot yet.
+        const auto base_path = GetSaveStateBasePath(path);
+        if (!savestate_base || savestate_base->path != path || !FileUtil::Exists(base_path)) {
+            auto base = std::make_unique<SavestateBase>();
+            base->path = path;
+            base->id = WriteSaveStateFile(base_path, title_id, 0, [&](std::ostream& stream) {
+                memory->SaveBaseMemory(stream, base->page_hashes);
+            });
+            savestate_base = std::move(base);
+        }
+        context = {.incremental = true, .page_hashes = &savestate_base->page_hashes};
+    }
+
+    savestate_context = &context;
+    SCOPE_EXIT({ savestate_context = nullptr; });
+    WriteSaveStateFile(path, title_id, incremental ? savestate_base->id : 0,
+                       [this](std::ostream& stream) {
+                           oarchive oa{stream};
+                           oa&* this;
+                       });
 }
 
 void System::LoadState(u32 slot) {
@@ -172,38 +238,129 @@ void System::LoadState(u32 slot) {
     const u64 movie_id = movie.GetCurrentMovieID();
     const auto path = GetSaveStatePath(title_id, movie_id, slot);
 
-    std::vector<u8> decompressed;
-    {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
+    FileUtil::IOFile file(path, "rb");
+    if (!file) {
+        throw std::runtime_error("Could not open file at " + path);
+    }
 
-        FileUtil::IOFile file(path, "rb");
+    // load header
+    CSTHeader header;
+    if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        throw std::runtime_error("Could not read from file at " + path);
+    }
 
-        // load header
-        CSTHeader header;
-        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
-            throw std::runtime_error("Could not read from file at " + path);
-        }
+    // validate header
+    SaveStateInfo info;
+    info.slot = slot;
+    if (!ValidateSaveState(header, info, title_id, movie_id)) {
+        throw std::runtime_error("Invalid savestate");
+    }
 
-        // validate header
-        SaveStateInfo info;
-        info.slot = slot;
-        if (!ValidateSaveState(header, info, title_id, movie_id)) {
-            throw std::runtime_error("Invalid savestate");
+    // Incremental states read the memory pages they did not store from their base state while
+    // they are deserialized.
+    Memory::SavestateContext context{};
+    const auto base_path = GetSaveStateBasePath(path);
+    std::optional<FileUtil::IOFile> base_file;
+    std::optional<Common::Compression::ZSTDInputBuffer> base_buffer;
+    std::optional<std::istream> base_stream;
+    if (header.base_id != 0) {
+        base_file.emplace(base_path, "rb");
+        CSTHeader base_header;
+        if (!*base_file ||
+            base_file->ReadBytes(&base_header, sizeof(base_header)) != sizeof(base_header)) {
+            throw std::runtime_error("Could not read from file at " + base_path);
+        }
+        if (base_header.filetype != header_magic_bytes || base_header.program_id != title_id ||
+            base_header.state_id != header.base_id) {
+            throw std::runtime_error("Savestate base does not match at " + base_path);
         }
+        base_buffer.emplace(*base_file);
+        base_stream.emplace(&*base_buffer);
+        context.incremental = true;
+        context.read_base = [&](std::span<u8> data) {
+            base_stream->read(reinterpret_cast<char*>(data.data()),
+                              static_cast<std::streamsize>(data.size()));
+            if (!*base_stream) {
+                throw std::runtime_error("Could not read from file at " + base_path);
+            }
+        };
+    }
+
+    savestate_context = &context;
+    SCOPE_EXIT({ savestate_context = nullptr; });
+    Common::Compression::ZSTDInputBuffer buffer{file};
+    std::istream stream{&buffer};
+
+    // Deserialize
+    iarchive ia{stream};
+    ia&* this;
+}
 
-        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
-            throw std::runtime_error("Could not read from file at " + path);
+void System::UpdateRewindBuffer() {
+    const u32 interval = Settings::values.rewind_interval.GetValue();
+    if (interval == 0) {
+        rewind_buffer.reset();
+        return;
+    }
+    const std::size_t budget =
+        static_cast<std::size_t>(Settings::values.rewind_buffer_size.GetValue()) * 1024 * 1024;
+    if (!rewind_buffer) {
+        rewind_buffer = std::make_unique<RewindBuffer>(budget);
+        last_rewind_frame = gpu->Renderer().GetCurrentFrame();
+        return;
+    }
+
+    const s32 frame = gpu->Renderer().GetCurrentFrame();
+    if (frame >= last_rewind_frame && static_cast<u32>(frame - last_rewind_frame) < interval) {
+        return;
+    }
+    last_rewind_frame = frame;
+
+    // Memory pages are handed to the rewind buffer, only the remaining state goes through the
+    // archive.
+    const Memory::SavestateContext context{.page_store = rewind_buffer.get()};
+    savestate_context = &context;
+    SCOPE_EXIT({ savestate_context = nullptr; });
+    rewind_buffer->BeginSnapshot();
+    try {
+        std::ostringstream sstream{std::ios_base::binary};
+        {
+            oarchive oa{sstream};
+            oa&* this;
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
+        const std::string& str{sstream.str()};
+        rewind_buffer->EndSnapshot({reinterpret_cast<const u8*>(str.data()), str.size()});
+    } catch (const std::exception& e) {
+        LOG_ERROR(Core, "Error taking rewind snapshot: {}", e.what());
+        rewind_buffer->AbortSnapshot();
+    }
+}
+
+bool System::LoadStateFromMemory(u32 steps) {
+    if (Network::GetRoomMember().lock()->IsConnected()) {
+        throw std::runtime_error("Unable to rewind while connected to multiplayer");
+    }
+    if (!rewind_buffer) {
+        return false;
+    }
+    const auto state = rewind_buffer->RestoreSnapshot(steps);
+    if (!state) {
+        return false;
     }
+
+    const Memory::SavestateContext context{.page_store = rewind_buffer.get()};
+    savestate_context = &context;
+    SCOPE_EXIT({ savestate_context = nullptr; });
     std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
+        std::string{reinterpret_cast<const char*>(state->data()), state->size()},
         std::ios_base::binary};
-    decompressed.clear();
 
     // Deserialize
     iarchive ia{sstream};
     ia&* this;
+
+    last_rewind_frame = gpu->Renderer().GetCurrentFrame();
+    return true;
 }
 
 } // namespace Core
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 #include "common/common_types.h"
+#include "core/memory.h"
 
 namespace Core {
 
@@ -22,6 +23,13 @@ struct SaveStateInfo {
 
 constexpr u32 SaveStateSlotCount = 10; // Maximum count of savestate slots
 
+/// Full savestate that the incremental savestates of a slot are stored relative to.
+struct SavestateBase {
+    std::string path;
+    u64 id{};
+    Memory::SavestatePageHashes page_hashes;
+};
+
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id);
 
 } // namespace Core
@@ -130,6 +130,10 @@ void Config::ReadValues() {
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
+    ReadSetting("Core", Settings::values.parallel_cores);
+    ReadSetting("Core", Settings::values.rewind_interval);
+    ReadSetting("Core", Settings::values.rewind_buffer_size);
+    ReadSetting("Core", Settings::values.incremental_savestates);
 
     // Renderer
     ReadSetting("Renderer", Settings::values.graphics_api);
@@ -194,6 +198,8 @@ void Config::ReadValues() {
     // Data Storage
     ReadSetting("Data Storage", Settings::values.use_virtual_sd);
     ReadSetting("Data Storage", Settings::values.use_custom_storage);
+    ReadSetting("Data Storage", Settings::values.romfs_cache_size);
+    ReadSetting("Data Storage", Settings::values.romfs_read_ahead);
 
     if (Settings::values.use_custom_storage) {
         FileUtil::UpdateUserPath(FileUtil::UserPath::NANDDir,
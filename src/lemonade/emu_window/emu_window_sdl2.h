@@ -20,8 +20,11 @@ public:
     explicit EmuWindow_SDL2(Core::System& system_, bool is_secondary);
     ~EmuWindow_SDL2();
 
-    /// Initializes SDL2
-    static void InitializeSDL2();
+    /**
+     * Initializes SDL2
+     * @param headless Skips the video and game controller subsystems, which need a display
+     */
+    static void InitializeSDL2(bool headless = false);
 
     /// Presents the most recent frame from the video backend
     virtual void Present() {}
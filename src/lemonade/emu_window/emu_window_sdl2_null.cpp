@@ -0,0 +1,33 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <SDL.h>
+#include "lemonade/emu_window/emu_window_sdl2_null.h"
+#include "core/3ds.h"
+#include "core/frontend/emu_window.h"
+
+class NullContext : public Frontend::GraphicsContext {};
+
+EmuWindow_SDL2_Null::EmuWindow_SDL2_Null(Core::System& system_)
+    : EmuWindow_SDL2{system_, false} {
+    render_window = nullptr;
+    dummy_window = nullptr;
+    UpdateCurrentFramebufferLayout(Core::kScreenTopWidth,
+                                   Core::kScreenTopHeight + Core::kScreenBottomHeight);
+}
+
+EmuWindow_SDL2_Null::~EmuWindow_SDL2_Null() = default;
+
+void EmuWindow_SDL2_Null::PollEvents() {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT) {
+            RequestClose();
+        }
+    }
+}
+
+std::unique_ptr<Frontend::GraphicsContext> EmuWindow_SDL2_Null::CreateSharedContext() const {
+    return std::make_unique<NullContext>();
+}
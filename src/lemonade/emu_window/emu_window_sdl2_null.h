@@ -0,0 +1,28 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include "lemonade/emu_window/emu_window_sdl2.h"
+
+namespace Core {
+class System;
+}
+
+/**
+ * Window without any on-screen surface, used to run the software renderer headless. Frames are
+ * rendered to the screen buffers of the renderer but never presented.
+ */
+class EmuWindow_SDL2_Null : public EmuWindow_SDL2 {
+public:
+    explicit EmuWindow_SDL2_Null(Core::System& system);
+    ~EmuWindow_SDL2_Null();
+
+    /// Only handles SDL_QUIT, which SDL raises on SIGINT and SIGTERM.
+    void PollEvents() override;
+    std::unique_ptr<GraphicsContext> CreateSharedContext() const override;
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+};
@@ -2,11 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <iostream>
 #include <memory>
 #include <regex>
 #include <string>
 #include <thread>
+#include <json.hpp>
 
 // This needs to be included before getopt.h because the latter #defines symbols used by it
 #include "common/microprofile.h"
@@ -17,6 +19,7 @@
 #include "lemonade/emu_window/emu_window_sdl2_gl.h"
 #endif
 #ifdef ENABLE_SOFTWARE_RENDERER
+#include "lemonade/emu_window/emu_window_sdl2_null.h"
 #include "lemonade/emu_window/emu_window_sdl2_sw.h"
 #endif
 #ifdef ENABLE_VULKAN
@@ -31,6 +34,7 @@
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "common/string_util.h"
+#include "audio_core/sink_details.h"
 #include "core/core.h"
 #include "core/dumping/backend.h"
 #include "core/dumping/ffmpeg_backend.h"
@@ -41,8 +45,12 @@
 #include "core/movie.h"
 #include "input_common/main.h"
 #include "network/network.h"
+#include "video_core/frame_hash_log.h"
 #include "video_core/gpu.h"
 #include "video_core/renderer_base.h"
+#ifdef ENABLE_SOFTWARE_RENDERER
+#include "video_core/renderer_software/renderer_software.h"
+#endif
 
 #ifdef __unix__
 #include "common/linux/gamemode.h"
@@ -77,6 +85,10 @@ static void PrintHelp(const char* argv0) {
                  "-a, --movie-record-author=AUTHOR Sets the author of the movie to be recorded\n"
                  "-p, --movie-play=[file]    Playback the movie (game inputs) from the given file\n"
                  "-d, --dump-video=[file]    Dumps audio and video to the given video file\n"
+                 "-b, --benchmark=FRAMES Runs FRAMES frames headless and as fast as possible,\n"
+                 "                       then prints performance statistics as JSON\n"
+                 "-H, --record-frame-hashes=FILE Writes the hashes of every frame to FILE\n"
+                 "-V, --verify-frame-hashes=FILE Compares every frame with the hashes of FILE\n"
                  "-f, --fullscreen     Start in fullscreen mode\n"
                  "-h, --help           Display this help and exit\n"
                  "-v, --version        Output version information and exit\n";
@@ -86,6 +98,65 @@ static void PrintVersion() {
     std::cout << "Lemonade " << Common::g_scm_branch << " " << Common::g_scm_desc << std::endl;
 }
 
+/// Prints the performance statistics of a benchmark run as JSON to stdout
+static void PrintBenchmarkResults(Core::System& system, std::chrono::duration<double> wall_time,
+                                  const VideoCore::FrameHashLog* frame_hash_log) {
+    const auto results = system.GetAndResetPerfStats();
+    const auto& perf_stats = *system.perf_stats;
+
+    nlohmann::ordered_json json;
+    json["frames"] = system.GPU().Renderer().GetCurrentFrame();
+    json["wall_time_s"] = wall_time.count();
+    json["emulation_speed"] = results.emulation_speed;
+    json["system_fps"] = results.system_fps;
+    json["game_fps"] = results.game_fps;
+    json["audio_underruns"] = results.audio_underruns;
+    json["audio_overruns"] = results.audio_overruns;
+    json["frametime_ms"] = {
+        {"mean", perf_stats.GetMeanFrametime()},
+        {"p50", perf_stats.GetFrametimePercentile(50)},
+        {"p90", perf_stats.GetFrametimePercentile(90)},
+        {"p99", perf_stats.GetFrametimePercentile(99)},
+        {"max", perf_stats.GetFrametimePercentile(100)},
+    };
+
+    // Totals of every profiled scope over the whole run, grouped by subsystem
+    auto& profile = json["microprofile"];
+    profile = nlohmann::ordered_json::object();
+#if MICROPROFILE_ENABLED
+    {
+        std::scoped_lock lock{MicroProfileGetMutex()};
+        const MicroProfile& state = *MicroProfileGet();
+        const double ticks_to_ms = 1000.0 / static_cast<double>(MicroProfileTicksPerSecondCpu());
+        for (u32 group = 0; group < MICROPROFILE_MAX_GROUPS; group++) {
+            const auto& info = state.GroupInfo[group];
+            if (info.pName[0] != '\0') {
+                profile[info.pName]["total_ms"] =
+                    static_cast<double>(state.AggregateGroup[group]) * ticks_to_ms;
+            }
+        }
+        for (u32 timer = 0; timer < state.nTotalTimers; timer++) {
+            const auto& info = state.TimerInfo[timer];
+            profile[state.GroupInfo[info.nGroupIndex].pName]["timers"][info.pName] = {
+                {"total_ms", static_cast<double>(state.Aggregate[timer].nTicks) * ticks_to_ms},
+                {"calls", state.Aggregate[timer].nCount},
+            };
+        }
+    }
+#endif
+
+    if (frame_hash_log) {
+        const auto diverging_frame = frame_hash_log->GetFirstDivergingFrame();
+        json["frame_hashes"] = {
+            {"frames", frame_hash_log->GetFrameCount()},
+            {"first_diverging_frame",
+             diverging_frame ? nlohmann::ordered_json(*diverging_frame) : nullptr},
+        };
+    }
+
+    std::cout << json.dump(4) << std::endl;
+}
+
 static void OnStateChanged(const Network::RoomMember::State& state) {
     switch (state) {
     case Network::RoomMember::State::Idle:
@@ -195,6 +266,9 @@ int main(int argc, char** argv) {
     std::string movie_record_author;
     std::string movie_play;
     std::string dump_video;
+    u32 benchmark_frames = 0;
+    std::string record_frame_hashes;
+    std::string verify_frame_hashes;
 
     char* endarg;
 #ifdef _WIN32
@@ -223,6 +297,9 @@ int main(int argc, char** argv) {
         {"movie-record-author", required_argument, 0, 'a'},
         {"movie-play", required_argument, 0, 'p'},
         {"dump-video", required_argument, 0, 'd'},
+        {"benchmark", required_argument, 0, 'b'},
+        {"record-frame-hashes", required_argument, 0, 'H'},
+        {"verify-frame-hashes", required_argument, 0, 'V'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -230,7 +307,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:i:m:r:p:fhv", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:i:m:r:p:b:H:V:fhv", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -299,6 +376,22 @@ int main(int argc, char** argv) {
             case 'd':
                 dump_video = optarg;
                 break;
+            case 'b':
+                errno = 0;
+                benchmark_frames = strtoul(optarg, &endarg, 0);
+                if (endarg == optarg || benchmark_frames == 0)
+                    errno = EINVAL;
+                if (errno != 0) {
+                    perror("--benchmark");
+                    exit(1);
+                }
+                break;
+            case 'H':
+                record_frame_hashes = optarg;
+                break;
+            case 'V':
+                verify_frame_hashes = optarg;
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -337,6 +430,38 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!record_frame_hashes.empty() && !verify_frame_hashes.empty()) {
+        LOG_CRITICAL(Frontend, "Cannot both record and verify frame hashes");
+        return -1;
+    }
+
+    const bool hash_frames = !record_frame_hashes.empty() || !verify_frame_hashes.empty();
+    if (hash_frames) {
+#ifdef ENABLE_SOFTWARE_RENDERER
+        // Only the output of the software renderer is deterministic across hosts
+        Settings::values.graphics_api.SetValue(Settings::GraphicsAPI::Software);
+#else
+        LOG_CRITICAL(Frontend, "Frame hashing requires the software renderer");
+        return -1;
+#endif
+    }
+
+    const bool benchmark = benchmark_frames != 0;
+    if (benchmark) {
+#ifdef ENABLE_SOFTWARE_RENDERER
+        // Run headless and as fast as possible. Only the software renderer works without a
+        // graphics context, and the audio output would pace emulation.
+        Settings::values.graphics_api.SetValue(Settings::GraphicsAPI::Software);
+        Settings::values.frame_limit.SetValue(0);
+        Settings::values.output_type.SetValue(AudioCore::SinkType::Null);
+        MicroProfileSetEnableAllGroups(true);
+        MicroProfileSetAggregateFrames(0);
+#else
+        LOG_CRITICAL(Frontend, "Benchmarking requires the software renderer");
+        return -1;
+#endif
+    }
+
     auto& system = Core::System::GetInstance();
     auto& movie = system.Movie();
 
@@ -355,7 +480,7 @@ int main(int argc, char** argv) {
     // Register frontend applets
     Frontend::RegisterDefaultApplets(system);
 
-    EmuWindow_SDL2::InitializeSDL2();
+    EmuWindow_SDL2::InitializeSDL2(benchmark);
 
     const auto create_emu_window = [&](bool fullscreen,
                                        bool is_secondary) -> std::unique_ptr<EmuWindow_SDL2> {
@@ -391,7 +516,13 @@ int main(int argc, char** argv) {
         }
     };
 
+#ifdef ENABLE_SOFTWARE_RENDERER
+    const std::unique_ptr<EmuWindow_SDL2> emu_window =
+        benchmark ? std::make_unique<EmuWindow_SDL2_Null>(system)
+                  : create_emu_window(fullscreen, false);
+#else
     const auto emu_window{create_emu_window(fullscreen, false)};
+#endif
     const bool use_secondary_window{
         Settings::values.layout_option.GetValue() == Settings::LayoutOption::SeparateWindows &&
         Settings::values.graphics_api.GetValue() != Settings::GraphicsAPI::Software};
@@ -471,6 +602,22 @@ int main(int argc, char** argv) {
         }
     }
 
+    std::unique_ptr<VideoCore::FrameHashLog> frame_hash_log;
+#ifdef ENABLE_SOFTWARE_RENDERER
+    if (hash_frames) {
+        frame_hash_log = !record_frame_hashes.empty()
+                             ? std::make_unique<VideoCore::FrameHashLog>(
+                                   record_frame_hashes, VideoCore::FrameHashLog::Mode::Record)
+                             : std::make_unique<VideoCore::FrameHashLog>(
+                                   verify_frame_hashes, VideoCore::FrameHashLog::Mode::Verify);
+        if (!frame_hash_log->IsValid()) {
+            return -1;
+        }
+        static_cast<SwRenderer::RendererSoftware&>(system.GPU().Renderer())
+            .SetFrameHashLog(frame_hash_log.get());
+    }
+#endif
+
 #ifdef __unix__
     Common::Linux::StartGamemode();
 #endif
@@ -489,6 +636,10 @@ int main(int argc, char** argv) {
                       total);
         });
 
+    // Measure from the first frame, after the disk resources are loaded
+    [[maybe_unused]] const auto reset_stats = system.GetAndResetPerfStats();
+    const auto start_time = std::chrono::steady_clock::now();
+
     const auto secondary_is_open = [&secondary_window] {
         // if the secondary window isn't created, it shouldn't affect the main loop
         return secondary_window ? secondary_window->IsOpen() : true;
@@ -506,6 +657,27 @@ int main(int argc, char** argv) {
             LOG_ERROR(Frontend, "Error in main run loop: {}", result, system.GetStatusDetails());
             break;
         }
+
+        if (benchmark &&
+            static_cast<u32>(system.GPU().Renderer().GetCurrentFrame()) >= benchmark_frames) {
+            emu_window->RequestClose();
+        }
+        // Nothing is learnt from the frames after the first diverging one
+        if (frame_hash_log && frame_hash_log->GetFirstDivergingFrame()) {
+            emu_window->RequestClose();
+        }
+    }
+    if (benchmark) {
+        PrintBenchmarkResults(system, std::chrono::steady_clock::now() - start_time,
+                              frame_hash_log.get());
+    }
+    bool frame_hashes_ok = true;
+    if (frame_hash_log) {
+#ifdef ENABLE_SOFTWARE_RENDERER
+        static_cast<SwRenderer::RendererSoftware&>(system.GPU().Renderer())
+            .SetFrameHashLog(nullptr);
+#endif
+        frame_hashes_ok = frame_hash_log->Finish();
     }
     emu_window->RequestClose();
     if (secondary_window) {
@@ -531,5 +703,5 @@ int main(int argc, char** argv) {
 #endif
 
     detached_tasks.WaitForAllTasks();
-    return 0;
+    return frame_hashes_ok ? 0 : 1;
 }
@@ -688,6 +688,11 @@ void GMainWindow::InitializeHotkeys() {
         Settings::values.frame_limit.SetGlobal(!Settings::values.frame_limit.UsingGlobal());
         UpdateStatusBar();
     });
+    connect_shortcut(QStringLiteral("Rewind"), [&] {
+        if (emulation_running) {
+            system.SendSignal(Core::System::Signal::Rewind, 1);
+        }
+    });
     connect_shortcut(QStringLiteral("Toggle Texture Dumping"),
                      [&] { Settings::values.dump_textures = !Settings::values.dump_textures; });
     connect_shortcut(QStringLiteral("Toggle Custom Textures"),
@@ -2141,7 +2146,10 @@ void GMainWindow::OnSaveState() {
     QAction* action = qobject_cast<QAction*>(sender());
     ASSERT(action);
 
-    system.SendSignal(Core::System::Signal::Save, action->data().toUInt());
+    const auto signal = Settings::values.incremental_savestates.GetValue()
+                            ? Core::System::Signal::SaveIncremental
+                            : Core::System::Signal::Save;
+    system.SendSignal(signal, action->data().toUInt());
     system.frame_limiter.AdvanceFrame();
     newest_slot = action->data().toUInt();
 }
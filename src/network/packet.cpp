@@ -7,12 +7,82 @@
 #else
 #include <arpa/inet.h>
 #endif
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <mutex>
 #include <string>
+#include <utility>
+#include "enet/enet.h"
 #include "network/packet.h"
 
 namespace Network {
 
+namespace {
+
+/// Sizes of the pooled buffers. Bigger packets get a buffer of their own.
+constexpr std::array<std::size_t, 6> BufferSizes{64, 256, 1024, 4096, 16384, 65536};
+/// Maximum number of free buffers kept around for each size
+constexpr std::size_t MaxFreeBuffers = 256;
+
+class BufferPool {
+public:
+    /**
+     * Gets a buffer that can hold at least the given amount of bytes
+     * @return The buffer and its size
+     */
+    std::pair<u8*, std::size_t> Allocate(std::size_t size) {
+        const auto it = std::lower_bound(BufferSizes.begin(), BufferSizes.end(), size);
+        if (it == BufferSizes.end()) {
+            return {new u8[size], size};
+        }
+        SizeClass& size_class = classes[std::distance(BufferSizes.begin(), it)];
+        {
+            std::lock_guard lock(size_class.mutex);
+            if (!size_class.free_buffers.empty()) {
+                u8* buffer = size_class.free_buffers.back();
+                size_class.free_buffers.pop_back();
+                return {buffer, *it};
+            }
+        }
+        return {new u8[*it], *it};
+    }
+
+    void Free(u8* buffer, std::size_t size) {
+        const auto it = std::lower_bound(BufferSizes.begin(), BufferSizes.end(), size);
+        if (it != BufferSizes.end() && *it == size) {
+            SizeClass& size_class = classes[std::distance(BufferSizes.begin(), it)];
+            std::lock_guard lock(size_class.mutex);
+            if (size_class.free_buffers.size() < MaxFreeBuffers) {
+                size_class.free_buffers.push_back(buffer);
+                return;
+            }
+        }
+        delete[] buffer;
+    }
+
+private:
+    struct SizeClass {
+        std::mutex mutex;
+        std::vector<u8*> free_buffers;
+    };
+    std::array<SizeClass, BufferSizes.size()> classes;
+};
+
+BufferPool& GetBufferPool() {
+    // Never destroyed, packets may still be released during static destruction
+    static BufferPool* pool = new BufferPool;
+    return *pool;
+}
+
+void FreeENetPacketBuffer(ENetPacket* enet_packet) {
+    // The size of the buffer is stored in place of the user data
+    const auto capacity = reinterpret_cast<std::uintptr_t>(enet_packet->userData);
+    GetBufferPool().Free(enet_packet->data, static_cast<std::size_t>(capacity));
+}
+
+} // Anonymous namespace
+
 #ifndef htonll
 u64 htonll(u64 x) {
     return ((1 == htonl(1)) ? (x) : ((uint64_t)htonl((x)&0xFFFFFFFF) << 32) | htonl((x) >> 32));
@@ -25,29 +95,97 @@ u64 ntohll(u64 x) {
 }
 #endif
 
+Packet::Packet(const void* in_data, std::size_t size_in_bytes)
+    : data(static_cast<const u8*>(in_data)), data_size(in_data ? size_in_bytes : 0) {}
+
+Packet::Packet(const Packet& other) : read_pos(other.read_pos), is_valid(other.is_valid) {
+    Append(other.data, other.data_size);
+}
+
+Packet& Packet::operator=(const Packet& other) {
+    if (this != &other) {
+        Clear();
+        Append(other.data, other.data_size);
+        read_pos = other.read_pos;
+        is_valid = other.is_valid;
+    }
+    return *this;
+}
+
+Packet::Packet(Packet&& other) noexcept
+    : buffer(std::exchange(other.buffer, nullptr)), capacity(std::exchange(other.capacity, 0)),
+      data(std::exchange(other.data, nullptr)), data_size(std::exchange(other.data_size, 0)),
+      read_pos(std::exchange(other.read_pos, 0)), is_valid(std::exchange(other.is_valid, true)) {}
+
+Packet& Packet::operator=(Packet&& other) noexcept {
+    if (this != &other) {
+        ReleaseBuffer();
+        buffer = std::exchange(other.buffer, nullptr);
+        capacity = std::exchange(other.capacity, 0);
+        data = std::exchange(other.data, nullptr);
+        data_size = std::exchange(other.data_size, 0);
+        read_pos = std::exchange(other.read_pos, 0);
+        is_valid = std::exchange(other.is_valid, true);
+    }
+    return *this;
+}
+
+Packet::~Packet() {
+    ReleaseBuffer();
+}
+
+void Packet::Reserve(std::size_t size_in_bytes) {
+    // Data that is read in place has to be moved to a buffer of the packet as well
+    if (buffer && data == buffer && size_in_bytes <= capacity) {
+        return;
+    }
+    const auto [new_buffer, new_capacity] =
+        GetBufferPool().Allocate(std::max(size_in_bytes, data_size));
+    if (data_size > 0) {
+        std::memcpy(new_buffer, data, data_size);
+    }
+    ReleaseBuffer();
+    buffer = new_buffer;
+    capacity = new_capacity;
+    data = buffer;
+}
+
+void Packet::ReleaseBuffer() {
+    if (buffer) {
+        GetBufferPool().Free(buffer, capacity);
+        buffer = nullptr;
+        capacity = 0;
+    }
+}
+
 void Packet::Append(const void* in_data, std::size_t size_in_bytes) {
     if (in_data && (size_in_bytes > 0)) {
-        std::size_t start = data.size();
-        data.resize(start + size_in_bytes);
-        std::memcpy(&data[start], in_data, size_in_bytes);
+        if (!buffer || data != buffer || data_size + size_in_bytes > capacity) {
+            // Grow geometrically so that appending field by field stays cheap
+            Reserve(std::max(data_size + size_in_bytes, data_size * 2));
+        }
+        std::memcpy(buffer + data_size, in_data, size_in_bytes);
+        data_size += size_in_bytes;
     }
 }
 
 void Packet::Read(void* out_data, std::size_t size_in_bytes) {
     if (out_data && CheckSize(size_in_bytes)) {
-        std::memcpy(out_data, &data[read_pos], size_in_bytes);
+        std::memcpy(out_data, data + read_pos, size_in_bytes);
         read_pos += size_in_bytes;
     }
 }
 
 void Packet::Clear() {
-    data.clear();
+    // Keep the buffer around for the next data
+    data = buffer;
+    data_size = 0;
     read_pos = 0;
     is_valid = true;
 }
 
 const void* Packet::GetData() const {
-    return !data.empty() ? &data[0] : nullptr;
+    return data_size > 0 ? data : nullptr;
 }
 
 void Packet::IgnoreBytes(u32 length) {
@@ -55,11 +193,11 @@ void Packet::IgnoreBytes(u32 length) {
 }
 
 std::size_t Packet::GetDataSize() const {
-    return data.size();
+    return data_size;
 }
 
 bool Packet::EndOfPacket() const {
-    return read_pos >= data.size();
+    return read_pos >= data_size;
 }
 
 Packet::operator bool() const {
@@ -143,7 +281,7 @@ Packet& Packet::operator>>(char* out_data) {
 
     if ((length > 0) && CheckSize(length)) {
         // Then extract characters
-        std::memcpy(out_data, &data[read_pos], length);
+        std::memcpy(out_data, data + read_pos, length);
         out_data[length] = '\0';
 
         // Update reading position
@@ -161,7 +299,7 @@ Packet& Packet::operator>>(std::string& out_data) {
     out_data.clear();
     if ((length > 0) && CheckSize(length)) {
         // Then extract characters
-        out_data.assign(&data[read_pos], length);
+        out_data.assign(reinterpret_cast<const char*>(data + read_pos), length);
 
         // Update reading position
         read_pos += length;
@@ -255,9 +393,29 @@ Packet& Packet::operator<<(const std::string& in_data) {
 }
 
 bool Packet::CheckSize(std::size_t size) {
-    is_valid = is_valid && (read_pos + size <= data.size());
+    is_valid = is_valid && (read_pos + size <= data_size);
 
     return is_valid;
 }
 
+ENetPacket* CreateENetPacket(Packet&& packet, u32 flags) {
+    if (!packet.buffer || packet.data != packet.buffer) {
+        // Nothing to take over, the data is not owned by the packet
+        return enet_packet_create(packet.GetData(), packet.GetDataSize(), flags);
+    }
+
+    ENetPacket* enet_packet =
+        enet_packet_create(packet.buffer, packet.data_size, flags | ENET_PACKET_FLAG_NO_ALLOCATE);
+    if (!enet_packet) {
+        return nullptr;
+    }
+    enet_packet->freeCallback = FreeENetPacketBuffer;
+    enet_packet->userData = reinterpret_cast<void*>(static_cast<std::uintptr_t>(packet.capacity));
+
+    packet.buffer = nullptr;
+    packet.capacity = 0;
+    packet.Clear();
+    return enet_packet;
+}
+
 } // namespace Network
@@ -5,16 +5,42 @@
 #pragma once
 
 #include <array>
+#include <type_traits>
 #include <vector>
 #include "common/common_types.h"
 
+typedef struct _ENetPacket ENetPacket;
+
 namespace Network {
 
-/// A class that serializes data for network transfer. It also handles endianess
+/**
+ * A class that serializes data for network transfer. It also handles endianess.
+ * The data is stored in buffers taken from a pool of a few size classes, which are handed over to
+ * ENet when sending the packet and go back to the pool once ENet is done with them.
+ */
 class Packet {
 public:
     Packet() = default;
-    ~Packet() = default;
+
+    /**
+     * Creates a packet that reads the given data in place instead of copying it. The data must
+     * outlive the packet, it is only copied if something is appended to the packet.
+     * @param data          Pointer to the received bytes
+     * @param size_in_bytes Number of received bytes
+     */
+    Packet(const void* data, std::size_t size_in_bytes);
+
+    Packet(const Packet& other);
+    Packet& operator=(const Packet& other);
+    Packet(Packet&& other) noexcept;
+    Packet& operator=(Packet&& other) noexcept;
+    ~Packet();
+
+    /**
+     * Makes sure the packet can hold the given amount of bytes without growing its buffer
+     * @param size_in_bytes Total number of bytes the packet will contain
+     */
+    void Reserve(std::size_t size_in_bytes);
 
     /**
      * Append data to the end of the packet
@@ -111,17 +137,48 @@ private:
      */
     bool CheckSize(std::size_t size);
 
+    /// Returns the pooled buffer to the pool
+    void ReleaseBuffer();
+
+    friend ENetPacket* CreateENetPacket(Packet&& packet, u32 flags);
+
     // Member data
-    std::vector<char> data;   ///< Data stored in the packet
-    std::size_t read_pos = 0; ///< Current reading position in the packet
-    bool is_valid = true;     ///< Reading state of the packet
+    u8* buffer = nullptr;      ///< Pooled buffer owned by the packet, if any
+    std::size_t capacity = 0;  ///< Size of the pooled buffer
+    const u8* data = nullptr;  ///< Data stored in the packet, either the buffer or received data
+    std::size_t data_size = 0; ///< Number of bytes stored in the packet
+    std::size_t read_pos = 0;  ///< Current reading position in the packet
+    bool is_valid = true;      ///< Reading state of the packet
 };
 
+/**
+ * Creates an ENet packet that takes over the buffer of the packet instead of copying it. The
+ * buffer goes back to the pool when ENet destroys the packet.
+ * @param packet The packet to send, it is empty afterwards
+ * @param flags  ENet packet flags
+ * @return The ENet packet, or nullptr if it could not be created
+ */
+ENetPacket* CreateENetPacket(Packet&& packet, u32 flags);
+
+/// Types that are transferred as is, so that containers of them are copied at once
+template <typename T>
+constexpr bool IsRawByte =
+    std::is_same_v<T, u8> || std::is_same_v<T, s8> || std::is_same_v<T, char>;
+
 template <typename T>
 Packet& Packet::operator>>(std::vector<T>& out_data) {
     // First extract the size
     u32 size = 0;
     *this >> size;
+    if constexpr (IsRawByte<T>) {
+        if (!CheckSize(size)) {
+            out_data.clear();
+            return *this;
+        }
+        out_data.resize(size);
+        Read(out_data.data(), size);
+        return *this;
+    }
     out_data.resize(size);
 
     // Then extract the data
@@ -135,6 +192,10 @@ Packet& Packet::operator>>(std::vector<T>& out_data) {
 
 template <typename T, std::size_t S>
 Packet& Packet::operator>>(std::array<T, S>& out_data) {
+    if constexpr (IsRawByte<T>) {
+        Read(out_data.data(), S);
+        return *this;
+    }
     for (std::size_t i = 0; i < out_data.size(); ++i) {
         T character;
         *this >> character;
@@ -147,6 +208,10 @@ template <typename T>
 Packet& Packet::operator<<(const std::vector<T>& in_data) {
     // First insert the size
     *this << static_cast<u32>(in_data.size());
+    if constexpr (IsRawByte<T>) {
+        Append(in_data.data(), in_data.size());
+        return *this;
+    }
 
     // Then insert the data
     for (std::size_t i = 0; i < in_data.size(); ++i) {
@@ -157,6 +222,10 @@ Packet& Packet::operator<<(const std::vector<T>& in_data) {
 
 template <typename T, std::size_t S>
 Packet& Packet::operator<<(const std::array<T, S>& in_data) {
+    if constexpr (IsRawByte<T>) {
+        Append(in_data.data(), S);
+        return *this;
+    }
     for (std::size_t i = 0; i < in_data.size(); ++i) {
         *this << in_data[i];
     }
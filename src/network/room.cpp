@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <mutex>
 #include <random>
 #include <regex>
@@ -43,9 +44,11 @@ public:
         ENetPeer* peer; ///< The remote peer.
     };
     using MemberList = std::vector<Member>;
-    MemberList members;              ///< Information about the members of this room
-    mutable std::mutex member_mutex; ///< Mutex for locking the members list
-    /// This should be a std::shared_mutex as soon as C++17 is supported
+    /// Information about the members of this room. The list is never modified in place: the room
+    /// thread publishes a modified copy instead, so it can read the list without locking while
+    /// other threads keep using the snapshot they obtained from GetMembers.
+    std::shared_ptr<const MemberList> members = std::make_shared<const MemberList>();
+    mutable std::mutex member_mutex; ///< Mutex for publishing and acquiring the members list
 
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
@@ -60,10 +63,26 @@ public:
     /// Verification backend of the room
     std::unique_ptr<VerifyUser::Backend> verify_backend;
 
+    /// Set when the room information has to be sent to every client at the end of the iteration.
+    bool room_information_changed = false;
+
     /// Thread function that will receive and dispatch messages until the room is destroyed.
     void ServerLoop();
     void StartLoop();
 
+    /// Dispatches a single ENet event to the matching handler.
+    void HandleEvent(ENetEvent& event);
+
+    /// Returns a snapshot of the members list that can be used from any thread.
+    std::shared_ptr<const MemberList> GetMembers() const;
+
+    /**
+     * Publishes a modified copy of the members list. Must only be called from the room thread.
+     * @param func Function modifying the copy
+     */
+    template <typename Func>
+    void UpdateMembers(Func&& func);
+
     /**
      * Parses and answers a room join request from a client.
      * Validates the uniqueness of the username and assigns the MAC address
@@ -198,8 +217,8 @@ public:
                            const std::string& username, const std::string& ip);
 
     /**
-     * Sends the information about the room, along with the list of members
-     * to every connected client in the room.
+     * Creates the packet containing the information about the room, along with the list of
+     * members.
      * The packet has the structure:
      * <MessageID>ID_ROOM_INFORMATION
      * <String> room_name
@@ -213,6 +232,16 @@ public:
      * <MacAddress> mac_address of that member
      * <String> game_name of that member
      */
+    Packet MakeRoomInformationPacket() const;
+
+    /**
+     * Sends the information about the room to a single client.
+     */
+    void SendRoomInformation(ENetPeer* client);
+
+    /**
+     * Sends the information about the room to every connected client in the room.
+     */
     void BroadcastRoomInformation();
 
     /**
@@ -250,65 +279,98 @@ public:
 void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
         ENetEvent event;
-        if (enet_host_service(server, &event, 16) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameNamePacket(&event);
-                    break;
-                case IdWifiPacket:
-                    HandleWifiPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                // Moderation
-                case IdModKick:
-                    HandleModKickPacket(&event);
-                    break;
-                case IdModBan:
-                    HandleModBanPacket(&event);
-                    break;
-                case IdModUnban:
-                    HandleModUnbanPacket(&event);
-                    break;
-                case IdModGetBanList:
-                    HandleModGetBanListPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
+        // Handle every event that has already been received before sending anything, so that all
+        // replies and relayed packets of this iteration go out in a single flush.
+        int result = enet_host_service(server, &event, 16);
+        while (result > 0) {
+            HandleEvent(event);
+            result = enet_host_check_events(server, &event);
+        }
+        if (result < 0) {
+            LOG_ERROR(Network, "Failed to service the room host");
         }
+        if (room_information_changed) {
+            room_information_changed = false;
+            BroadcastRoomInformation();
+        }
+        enet_host_flush(server);
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::HandleEvent(ENetEvent& event) {
+    switch (event.type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        if (event.packet->dataLength == 0) {
+            enet_packet_destroy(event.packet);
+            break;
+        }
+        switch (event.packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(&event);
+            break;
+        case IdSetGameInfo:
+            HandleGameNamePacket(&event);
+            break;
+        case IdWifiPacket:
+            HandleWifiPacket(&event);
+            break;
+        case IdChatMessage:
+            HandleChatPacket(&event);
+            break;
+        // Moderation
+        case IdModKick:
+            HandleModKickPacket(&event);
+            break;
+        case IdModBan:
+            HandleModBanPacket(&event);
+            break;
+        case IdModUnban:
+            HandleModUnbanPacket(&event);
+            break;
+        case IdModGetBanList:
+            HandleModGetBanListPacket(&event);
+            break;
+        }
+        // Relayed packets are still referenced by the outgoing queues of their recipients, ENet
+        // destroys them once they have been sent.
+        if (event.packet->referenceCount == 0) {
+            enet_packet_destroy(event.packet);
+        }
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event.peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
+std::shared_ptr<const Room::RoomImpl::MemberList> Room::RoomImpl::GetMembers() const {
+    std::lock_guard lock(member_mutex);
+    return members;
+}
+
+template <typename Func>
+void Room::RoomImpl::UpdateMembers(Func&& func) {
+    auto new_members = std::make_shared<MemberList>(*members);
+    func(*new_members);
+    std::lock_guard lock(member_mutex);
+    members = std::move(new_members);
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
 
 void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
-    {
-        std::lock_guard lock(member_mutex);
-        if (members.size() >= room_information.member_slots) {
-            SendRoomIsFull(event->peer);
-            return;
-        }
+    if (members->size() >= room_information.member_slots) {
+        SendRoomIsFull(event->peer);
+        return;
     }
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
     std::string nickname;
     packet >> nickname;
@@ -400,13 +462,12 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
     // Notify everyone that the user has joined.
     SendStatusMessage(IdMemberJoin, member.nickname, member.user_data.username, ip);
 
-    {
-        std::lock_guard lock(member_mutex);
-        members.push_back(std::move(member));
-    }
+    UpdateMembers([&member](MemberList& list) { list.push_back(std::move(member)); });
 
-    // Notify everyone that the room information has changed.
-    BroadcastRoomInformation();
+    // The new member needs the room information before the join confirmation, everyone else is
+    // notified of the change at the end of the iteration.
+    SendRoomInformation(event->peer);
+    room_information_changed = true;
     if (HasModPermission(event->peer)) {
         SendJoinSuccessAsMod(event->peer, preferred_mac);
     } else {
@@ -420,40 +481,39 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         return;
     }
 
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
 
     std::string nickname;
     packet >> nickname;
 
-    std::string username, ip;
-    {
-        std::lock_guard lock(member_mutex);
-        const auto target_member =
-            std::find_if(members.begin(), members.end(),
-                         [&nickname](const auto& member) { return member.nickname == nickname; });
-        if (target_member == members.end()) {
-            SendModNoSuchUser(event->peer);
-            return;
-        }
+    const auto target_member =
+        std::find_if(members->begin(), members->end(),
+                     [&nickname](const auto& member) { return member.nickname == nickname; });
+    if (target_member == members->end()) {
+        SendModNoSuchUser(event->peer);
+        return;
+    }
 
-        // Notify the kicked member
-        SendUserKicked(target_member->peer);
+    // Notify the kicked member
+    ENetPeer* const target_peer = target_member->peer;
+    SendUserKicked(target_peer);
 
-        username = target_member->user_data.username;
+    const std::string username = target_member->user_data.username;
 
-        char ip_raw[256];
-        enet_address_get_host_ip(&target_member->peer->address, ip_raw, sizeof(ip_raw) - 1);
-        ip = ip_raw;
+    char ip_raw[256];
+    enet_address_get_host_ip(&target_peer->address, ip_raw, sizeof(ip_raw) - 1);
+    const std::string ip = ip_raw;
 
-        enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
-    }
+    enet_peer_disconnect_later(target_peer, 0);
+    UpdateMembers([target_peer](MemberList& list) {
+        std::erase_if(list,
+                      [target_peer](const Member& member) { return member.peer == target_peer; });
+    });
 
     // Announce the change to all clients.
     SendStatusMessage(IdMemberKicked, nickname, username, ip);
-    BroadcastRoomInformation();
+    room_information_changed = true;
 }
 
 void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
@@ -462,37 +522,35 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         return;
     }
 
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
 
     std::string nickname;
     packet >> nickname;
 
-    std::string username, ip;
-    {
-        std::lock_guard lock(member_mutex);
-        const auto target_member =
-            std::find_if(members.begin(), members.end(),
-                         [&nickname](const auto& member) { return member.nickname == nickname; });
-        if (target_member == members.end()) {
-            SendModNoSuchUser(event->peer);
-            return;
-        }
+    const auto target_member =
+        std::find_if(members->begin(), members->end(),
+                     [&nickname](const auto& member) { return member.nickname == nickname; });
+    if (target_member == members->end()) {
+        SendModNoSuchUser(event->peer);
+        return;
+    }
 
-        // Notify the banned member
-        SendUserBanned(target_member->peer);
+    // Notify the banned member
+    ENetPeer* const target_peer = target_member->peer;
+    SendUserBanned(target_peer);
 
-        nickname = target_member->nickname;
-        username = target_member->user_data.username;
+    const std::string username = target_member->user_data.username;
 
-        char ip_raw[256];
-        enet_address_get_host_ip(&target_member->peer->address, ip_raw, sizeof(ip_raw) - 1);
-        ip = ip_raw;
+    char ip_raw[256];
+    enet_address_get_host_ip(&target_peer->address, ip_raw, sizeof(ip_raw) - 1);
+    const std::string ip = ip_raw;
 
-        enet_peer_disconnect(target_member->peer, 0);
-        members.erase(target_member);
-    }
+    enet_peer_disconnect_later(target_peer, 0);
+    UpdateMembers([target_peer](MemberList& list) {
+        std::erase_if(list,
+                      [target_peer](const Member& member) { return member.peer == target_peer; });
+    });
 
     {
         std::lock_guard lock(ban_list_mutex);
@@ -514,7 +572,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
 
     // Announce the change to all clients.
     SendStatusMessage(IdMemberBanned, nickname, username, ip);
-    BroadcastRoomInformation();
+    room_information_changed = true;
 }
 
 void Room::RoomImpl::HandleModUnbanPacket(const ENetEvent* event) {
@@ -523,8 +581,7 @@ void Room::RoomImpl::HandleModUnbanPacket(const ENetEvent* event) {
         return;
     }
 
-    Packet packet;
-    packet.Append(event->packet->data, event->packet->dataLength);
+    Packet packet(event->packet->data, event->packet->dataLength);
     packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
 
     std::string address;
@@ -570,32 +627,28 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
     if (!std::regex_match(nickname, nickname_regex))
         return false;
 
-    std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
+    return std::all_of(members->begin(), members->end(),
                        [&nickname](const auto& member) { return member.nickname != nickname; });
 }
 
 bool Room::RoomImpl::IsValidMacAddress(const MacAddress& address) const {
     // A MAC address is valid if it is not already taken by anybody else in the room.
-    std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
+    return std::all_of(members->begin(), members->end(),
                        [&address](const auto& member) { return member.mac_address != address; });
 }
 
 bool Room::RoomImpl::IsValidConsoleId(const std::string& console_id_hash) const {
     // A Console ID is valid if it is not already taken by anybody else in the room.
-    std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(), [&console_id_hash](const auto& member) {
+    return std::all_of(members->begin(), members->end(), [&console_id_hash](const auto& member) {
         return member.console_id_hash != console_id_hash;
     });
 }
 
 bool Room::RoomImpl::HasModPermission(const ENetPeer* client) const {
-    std::lock_guard lock(member_mutex);
     const auto sending_member =
-        std::find_if(members.begin(), members.end(),
+        std::find_if(members->begin(), members->end(),
                      [client](const auto& member) { return member.peer == client; });
-    if (sending_member == members.end()) {
+    if (sending_member == members->end()) {
         return false;
     }
     if (room_information.enable_citra_mods &&
@@ -615,50 +668,40 @@ void Room::RoomImpl::SendNameCollision(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdNameCollision);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendMacCollision(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdMacCollision);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendConsoleIdCollision(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdConsoleIdCollision);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendWrongPassword(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdWrongPassword);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendRoomIsFull(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdRoomIsFull);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
@@ -666,70 +709,56 @@ void Room::RoomImpl::SendVersionMismatch(ENetPeer* client) {
     packet << static_cast<u8>(IdVersionMismatch);
     packet << network_version;
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendJoinSuccess(ENetPeer* client, MacAddress mac_address) {
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccess);
     packet << mac_address;
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendJoinSuccessAsMod(ENetPeer* client, MacAddress mac_address) {
     Packet packet;
     packet << static_cast<u8>(IdJoinSuccessAsMod);
     packet << mac_address;
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendUserKicked(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdHostKicked);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendUserBanned(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdHostBanned);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendModPermissionDenied(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdModPermissionDenied);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendModNoSuchUser(ENetPeer* client) {
     Packet packet;
     packet << static_cast<u8>(IdModNoSuchUser);
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
@@ -741,25 +770,21 @@ void Room::RoomImpl::SendModBanListResponse(ENetPeer* client) {
         packet << ip_ban_list;
     }
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_peer_send(client, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::SendCloseMessage() {
     Packet packet;
     packet << static_cast<u8>(IdCloseRoom);
-    std::lock_guard lock(member_mutex);
-    if (!members.empty()) {
-        ENetPacket* enet_packet =
-            enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
-        for (auto& member : members) {
+    if (!members->empty()) {
+        ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
+        for (const auto& member : *members) {
             enet_peer_send(member.peer, 0, enet_packet);
         }
     }
     enet_host_flush(server);
-    for (auto& member : members) {
+    for (const auto& member : *members) {
         enet_peer_disconnect(member.peer, 0);
     }
 }
@@ -771,15 +796,12 @@ void Room::RoomImpl::SendStatusMessage(StatusMessageTypes type, const std::strin
     packet << static_cast<u8>(type);
     packet << nickname;
     packet << username;
-    std::lock_guard lock(member_mutex);
-    if (!members.empty()) {
-        ENetPacket* enet_packet =
-            enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
-        for (auto& member : members) {
+    if (!members->empty()) {
+        ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
+        for (const auto& member : *members) {
             enet_peer_send(member.peer, 0, enet_packet);
         }
     }
-    enet_host_flush(server);
 
     const std::string display_name =
         username.empty() ? nickname : fmt::format("{} ({})", nickname, username);
@@ -803,7 +825,7 @@ void Room::RoomImpl::SendStatusMessage(StatusMessageTypes type, const std::strin
     }
 }
 
-void Room::RoomImpl::BroadcastRoomInformation() {
+Packet Room::RoomImpl::MakeRoomInformationPacket() const {
     Packet packet;
     packet << static_cast<u8>(IdRoomInformation);
     packet << room_information.name;
@@ -813,24 +835,29 @@ void Room::RoomImpl::BroadcastRoomInformation() {
     packet << room_information.preferred_game;
     packet << room_information.host_username;
 
-    packet << static_cast<u32>(members.size());
-    {
-        std::lock_guard lock(member_mutex);
-        for (const auto& member : members) {
-            packet << member.nickname;
-            packet << member.mac_address;
-            packet << member.game_info.name;
-            packet << member.game_info.id;
-            packet << member.user_data.username;
-            packet << member.user_data.display_name;
-            packet << member.user_data.avatar_url;
-        }
+    packet << static_cast<u32>(members->size());
+    for (const auto& member : *members) {
+        packet << member.nickname;
+        packet << member.mac_address;
+        packet << member.game_info.name;
+        packet << member.game_info.id;
+        packet << member.user_data.username;
+        packet << member.user_data.display_name;
+        packet << member.user_data.avatar_url;
     }
+    return packet;
+}
 
-    ENetPacket* enet_packet =
-        enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+void Room::RoomImpl::SendRoomInformation(ENetPeer* client) {
+    Packet packet = MakeRoomInformationPacket();
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
+    enet_peer_send(client, 0, enet_packet);
+}
+
+void Room::RoomImpl::BroadcastRoomInformation() {
+    Packet packet = MakeRoomInformationPacket();
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
     enet_host_broadcast(server, 0, enet_packet);
-    enet_host_flush(server);
 }
 
 MacAddress Room::RoomImpl::GenerateMacAddress() {
@@ -846,40 +873,32 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // The destination follows the message type, WifiPacket type, WifiPacket channel and
+    // WifiPacket transmitter address
+    constexpr std::size_t DestinationOffset = 3 * sizeof(u8) + sizeof(MacAddress);
+    ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < DestinationOffset + sizeof(MacAddress)) {
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
+    std::memcpy(destination_address.data(), enet_packet->data + DestinationOffset,
+                sizeof(MacAddress));
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    // The received packet is relayed as is, every recipient shares it.
+    enet_packet->flags |= ENET_PACKET_FLAG_RELIABLE;
 
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
-        for (const auto& member : members) {
+        for (const auto& member : *members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
                 enet_peer_send(member.peer, 0, enet_packet);
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
+        const auto member = std::find_if(members->begin(), members->end(),
+                                         [destination_address](const Member& member) -> bool {
+                                             return member.mac_address == destination_address;
+                                         });
+        if (member != members->end()) {
             enet_peer_send(member->peer, 0, enet_packet);
         } else {
             LOG_ERROR(Network,
@@ -887,15 +906,12 @@ void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
+    Packet in_packet(event->packet->data, event->packet->dataLength);
 
     in_packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
     std::string message;
@@ -904,9 +920,9 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
         return member.peer == event->peer;
     };
 
-    std::lock_guard lock(member_mutex);
-    const auto sending_member = std::find_if(members.begin(), members.end(), CompareNetworkAddress);
-    if (sending_member == members.end()) {
+    const auto sending_member =
+        std::find_if(members->begin(), members->end(), CompareNetworkAddress);
+    if (sending_member == members->end()) {
         return; // Received a chat message from a unknown sender
     }
 
@@ -919,10 +935,9 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
     out_packet << sending_member->user_data.username;
     out_packet << message;
 
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    ENetPacket* enet_packet = CreateENetPacket(std::move(out_packet), ENET_PACKET_FLAG_RELIABLE);
     bool sent_packet = false;
-    for (const auto& member : members) {
+    for (const auto& member : *members) {
         if (member.peer != event->peer) {
             sent_packet = true;
             enet_peer_send(member.peer, 0, enet_packet);
@@ -933,8 +948,6 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
         enet_packet_destroy(enet_packet);
     }
 
-    enet_host_flush(server);
-
     if (sending_member->user_data.username.empty()) {
         LOG_INFO(Network, "{}: {}", sending_member->nickname, message);
     } else {
@@ -944,63 +957,58 @@ void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
 }
 
 void Room::RoomImpl::HandleGameNamePacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
+    Packet in_packet(event->packet->data, event->packet->dataLength);
 
     in_packet.IgnoreBytes(sizeof(u8)); // Ignore the message type
     GameInfo game_info;
     in_packet >> game_info.name;
     in_packet >> game_info.id;
 
-    {
-        std::lock_guard lock(member_mutex);
-        auto member =
-            std::find_if(members.begin(), members.end(), [event](const Member& member) -> bool {
-                return member.peer == event->peer;
-            });
-        if (member != members.end()) {
-            member->game_info = game_info;
-
-            const std::string display_name =
-                member->user_data.username.empty()
-                    ? member->nickname
-                    : fmt::format("{} ({})", member->nickname, member->user_data.username);
-
-            if (game_info.name.empty()) {
-                LOG_INFO(Network, "{} is not playing", display_name);
-            } else {
-                LOG_INFO(Network, "{} is playing {}", display_name, game_info.name);
-            }
+    const auto member =
+        std::find_if(members->begin(), members->end(),
+                     [event](const Member& member) -> bool { return member.peer == event->peer; });
+    if (member != members->end()) {
+        const std::string display_name =
+            member->user_data.username.empty()
+                ? member->nickname
+                : fmt::format("{} ({})", member->nickname, member->user_data.username);
+
+        if (game_info.name.empty()) {
+            LOG_INFO(Network, "{} is not playing", display_name);
+        } else {
+            LOG_INFO(Network, "{} is playing {}", display_name, game_info.name);
         }
+
+        const std::ptrdiff_t index = std::distance(members->begin(), member);
+        UpdateMembers([index, &game_info](MemberList& list) { list[index].game_info = game_info; });
     }
-    BroadcastRoomInformation();
+    room_information_changed = true;
 }
 
 void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
     // Remove the client from the members list.
     std::string nickname, username, ip;
-    {
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(), [client](const Member& member) {
-            return member.peer == client;
-        });
-        if (member != members.end()) {
-            nickname = member->nickname;
-            username = member->user_data.username;
+    const auto member =
+        std::find_if(members->begin(), members->end(),
+                     [client](const Member& member) { return member.peer == client; });
+    if (member != members->end()) {
+        nickname = member->nickname;
+        username = member->user_data.username;
 
-            char ip_raw[256];
-            enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
-            ip = ip_raw;
+        char ip_raw[256];
+        enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
+        ip = ip_raw;
 
-            members.erase(member);
-        }
+        UpdateMembers([client](MemberList& list) {
+            std::erase_if(list, [client](const Member& member) { return member.peer == client; });
+        });
     }
 
     // Announce the change to all clients.
     enet_peer_disconnect(client, 0);
     if (!nickname.empty())
         SendStatusMessage(IdMemberLeave, nickname, username, ip);
-    BroadcastRoomInformation();
+    room_information_changed = true;
 }
 
 // Room
@@ -1032,7 +1040,8 @@ bool Room::Create(const std::string& name, const std::string& description,
     room_impl->room_information.name = name;
     room_impl->room_information.description = description;
     room_impl->room_information.member_slots = max_connections;
-    room_impl->room_information.port = server_port;
+    // ENet reads back the address it bound to, which has the actual port when server_port is 0
+    room_impl->room_information.port = room_impl->server->address.port;
     room_impl->room_information.preferred_game = preferred_game;
     room_impl->room_information.preferred_game_id = preferred_game_id;
     room_impl->room_information.host_username = host_username;
@@ -1066,8 +1075,9 @@ Room::BanList Room::GetBanList() const {
 
 std::vector<Room::Member> Room::GetRoomMemberList() const {
     std::vector<Room::Member> member_list;
-    std::lock_guard lock(room_impl->member_mutex);
-    for (const auto& member_impl : room_impl->members) {
+    const auto members = room_impl->GetMembers();
+    member_list.reserve(members->size());
+    for (const auto& member_impl : *members) {
         Member member;
         member.nickname = member_impl.nickname;
         member.username = member_impl.user_data.username;
@@ -1101,8 +1111,9 @@ void Room::Destroy() {
     room_impl->server = nullptr;
     {
         std::lock_guard lock(room_impl->member_mutex);
-        room_impl->members.clear();
+        room_impl->members = std::make_shared<const RoomImpl::MemberList>();
     }
+    room_impl->room_information_changed = false;
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
 }
@@ -139,7 +139,7 @@ public:
 
     /**
      * Creates the socket for this room. Will bind to default address if
-     * server is empty string.
+     * server is empty string, and to a port picked by the system if server_port is 0.
      */
     bool Create(const std::string& name, const std::string& description = "",
                 const std::string& server = "", u16 server_port = DefaultRoomPort,
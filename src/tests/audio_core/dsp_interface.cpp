@@ -0,0 +1,129 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/dsp_interface.h"
+#include "audio_core/sink_details.h"
+#include "core/core.h"
+
+namespace AudioCore {
+
+namespace {
+
+/// Exposes the output path of the DSP interface, the DSP itself does nothing.
+class TestDsp final : public DspInterface {
+public:
+    using DspInterface::DspInterface;
+    using DspInterface::OutputCallback;
+    using DspInterface::OutputFrame;
+
+    u16 RecvData(u32) override {
+        return 0;
+    }
+    bool RecvDataIsReady(u32) const override {
+        return false;
+    }
+    void SetSemaphore(u16) override {}
+    std::vector<u8> PipeRead(DspPipe, std::size_t) override {
+        return {};
+    }
+    std::size_t GetPipeReadableSize(DspPipe) const override {
+        return 0;
+    }
+    void PipeWrite(DspPipe, std::span<const u8>) override {}
+    std::array<u8, Memory::DSP_RAM_SIZE>& GetDspMemory() override {
+        return dsp_memory;
+    }
+    void SetInterruptHandler(std::function<void(Service::DSP::InterruptType, DspPipe)>) override {}
+    void LoadComponent(std::span<const u8>) override {}
+    void UnloadComponent() override {}
+
+private:
+    std::array<u8, Memory::DSP_RAM_SIZE> dsp_memory{};
+};
+
+StereoFrame16 ConstantFrame(s16 value) {
+    StereoFrame16 frame;
+    frame.fill({value, value});
+    return frame;
+}
+
+/// Returns num_frames frames of output, as the sink would ask for them.
+std::vector<s16> Callback(TestDsp& dsp, std::size_t num_frames) {
+    std::vector<s16> buffer(2 * num_frames);
+    dsp.OutputCallback(buffer.data(), num_frames);
+    return buffer;
+}
+
+/// The output thread wakes up at least every few milliseconds, this gives it plenty of time.
+void WaitForOutputThread() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DSP output counts underruns and overruns", "[audio_core]") {
+    Core::System system;
+    auto dsp = std::make_unique<TestDsp>(system);
+    dsp->SetSink(SinkType::Null, "");
+
+    // Before the first frame there is nothing to run out of
+    Callback(*dsp, 256);
+    REQUIRE(dsp->GetOutputCounters().underruns == 0);
+    REQUIRE(dsp->GetOutputCounters().overruns == 0);
+
+    // Nothing is consumed, so more frames than both rings hold overflow them
+    for (int i = 0; i < 100; i++) {
+        dsp->OutputFrame(ConstantFrame(1000));
+    }
+    WaitForOutputThread();
+    REQUIRE(dsp->GetOutputCounters().overruns > 0);
+
+    const auto queued = Callback(*dsp, 1);
+    REQUIRE(queued[0] == 1000);
+    REQUIRE(dsp->GetOutputCounters().underruns == 0);
+
+    // A dry spell counts once, no matter how many callbacks it lasts
+    Callback(*dsp, 0x4000);
+    Callback(*dsp, 256);
+    REQUIRE(dsp->GetOutputCounters().underruns == 1);
+}
+
+TEST_CASE("DSP output flushes the stretcher when stretching stops", "[audio_core]") {
+    Core::System system;
+    auto dsp = std::make_unique<TestDsp>(system);
+    dsp->SetSink(SinkType::Null, "");
+    dsp->EnableStretching(true);
+
+    // The stretcher only releases two callbacks worth of frames and keeps the rest
+    constexpr std::size_t stretched_frames = 10 * samples_per_frame;
+    Callback(*dsp, 256);
+    for (std::size_t i = 0; i < stretched_frames / samples_per_frame; i++) {
+        dsp->OutputFrame(ConstantFrame(1000));
+    }
+    WaitForOutputThread();
+
+    dsp->EnableStretching(false);
+    WaitForOutputThread();
+    dsp->OutputFrame(ConstantFrame(2000));
+    WaitForOutputThread();
+
+    // The frames held by the stretcher come out before the unstretched ones
+    const auto output = Callback(*dsp, 0x2000);
+    std::size_t first_unstretched = 0;
+    while (first_unstretched < 0x2000 && output[2 * first_unstretched] != 2000) {
+        first_unstretched++;
+    }
+    REQUIRE(first_unstretched > stretched_frames * 2 / 3);
+    REQUIRE(first_unstretched < 0x2000);
+    REQUIRE(std::all_of(output.begin() + 2 * first_unstretched, output.end(),
+                        [](s16 sample) { return sample == 2000; }));
+}
+
+} // namespace AudioCore
@@ -0,0 +1,163 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "audio_core/interpolate.h"
+
+namespace AudioCore {
+
+namespace {
+
+using Sample = std::array<s16, 2>;
+using InterpolateFunc = void (*)(AudioInterp::State&, StereoBuffer16&, float, StereoFrame16&,
+                                 std::size_t&);
+
+std::vector<Sample> RandomSamples(std::size_t count) {
+    std::mt19937 rng{4321};
+    std::uniform_int_distribution<int> distribution(-32768, 32767);
+    std::vector<Sample> samples(count);
+    for (auto& sample : samples) {
+        sample = {static_cast<s16>(distribution(rng)), static_cast<s16>(distribution(rng))};
+    }
+    return samples;
+}
+
+std::vector<Sample> Sine(std::size_t count, double cycles_per_sample) {
+    std::vector<Sample> samples(count);
+    for (std::size_t i = 0; i < count; i++) {
+        const double phase = 2 * std::numbers::pi * cycles_per_sample * static_cast<double>(i);
+        const s16 value = static_cast<s16>(std::lround(16000 * std::sin(phase)));
+        samples[i] = {value, value};
+    }
+    return samples;
+}
+
+/// Resamples the input queued in buffers of chunk samples, as a source would, until it runs out.
+std::vector<Sample> Resample(InterpolateFunc interpolate, float rate,
+                             const std::vector<Sample>& samples, std::size_t chunk) {
+    AudioInterp::State state;
+    StereoBuffer16 buffer;
+    std::vector<Sample> output;
+    std::size_t next = 0;
+
+    while (true) {
+        StereoFrame16 frame{};
+        std::size_t position = 0;
+        while (position < frame.size()) {
+            if (buffer.empty()) {
+                if (next == samples.size()) {
+                    output.insert(output.end(), frame.begin(), frame.begin() + position);
+                    return output;
+                }
+                const std::size_t count = std::min(samples.size() - next, chunk);
+                std::ranges::copy(samples.begin() + next, samples.begin() + next + count,
+                                  buffer.Assign(count).begin());
+                next += count;
+            }
+            interpolate(state, buffer, rate, frame, position);
+        }
+        output.insert(output.end(), frame.begin(), frame.end());
+    }
+}
+
+double RootMeanSquare(const std::vector<Sample>& samples, std::size_t skip) {
+    double sum = 0.0;
+    for (std::size_t i = skip; i < samples.size(); i++) {
+        sum += static_cast<double>(samples[i][0]) * samples[i][0];
+    }
+    return std::sqrt(sum / static_cast<double>(samples.size() - skip));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Polyphase interpolation passes samples through at a rate of 1", "[audio_core]") {
+    const std::vector<Sample> samples = RandomSamples(2000);
+    const std::size_t chunk = GENERATE(3, 97, 2000);
+
+    // Polyphase reads further ahead, the last positions wait for input that never comes
+    const auto output = Resample(AudioInterp::Polyphase, 1.0f, samples, chunk);
+    const auto linear = Resample(AudioInterp::Linear, 1.0f, samples, chunk);
+    REQUIRE(output.size() == linear.size() - 6);
+    REQUIRE(std::equal(output.begin(), output.end(), linear.begin()));
+}
+
+TEST_CASE("Polyphase interpolation does not depend on buffer boundaries", "[audio_core]") {
+    const std::vector<Sample> samples = RandomSamples(3000);
+    const float rate = GENERATE(0.3f, 1.37f, 2.5f, 7.0f);
+
+    // Buffers shorter than the filter leave positions waiting for more input
+    const auto whole = Resample(AudioInterp::Polyphase, rate, samples, samples.size());
+    const auto small = Resample(AudioInterp::Polyphase, rate, samples, 5);
+    const auto uneven = Resample(AudioInterp::Polyphase, rate, samples, 97);
+    REQUIRE(small == whole);
+    REQUIRE(uneven == whole);
+}
+
+TEST_CASE("Polyphase interpolation has unity gain at DC", "[audio_core]") {
+    const float rate = GENERATE(0.3f, 1.37f, 2.5f, 7.0f);
+    const std::vector<Sample> samples(4000, Sample{12345, -23456});
+
+    const auto output = Resample(AudioInterp::Polyphase, rate, samples, 97);
+    // Skip the outputs that read the silent initial history
+    const std::size_t skip = static_cast<std::size_t>(9 / rate) + 1;
+    REQUIRE(output.size() > skip);
+    for (std::size_t i = skip; i < output.size(); i++) {
+        REQUIRE(output[i] == Sample{12345, -23456});
+    }
+}
+
+TEST_CASE("Polyphase interpolation filters out aliases when decimating", "[audio_core]") {
+    // Above the Nyquist frequency of the output, the tone would fold back into it
+    const float rate = GENERATE(1.6f, 2.5f, 4.0f);
+    const double frequency = 0.4;
+    const std::vector<Sample> samples = Sine(20000, frequency);
+
+    const auto linear = Resample(AudioInterp::Linear, rate, samples, 160);
+    const auto polyphase = Resample(AudioInterp::Polyphase, rate, samples, 160);
+    REQUIRE(RootMeanSquare(polyphase, 16) * 10 < RootMeanSquare(linear, 16));
+}
+
+TEST_CASE("Interpolation benchmark", "[.][benchmark][audio_core]") {
+    const float rate = GENERATE(0.5f, 1.0f, 1.5f, 3.0f);
+    const std::vector<Sample> samples = RandomSamples(4096);
+
+    // Measures the cost of producing one frame of a source
+    const auto bench_frame = [&](InterpolateFunc interpolate) {
+        AudioInterp::State state;
+        StereoBuffer16 buffer;
+        StereoFrame16 frame{};
+        return [=, &samples]() mutable {
+            std::size_t position = 0;
+            while (position < frame.size()) {
+                if (buffer.empty()) {
+                    std::ranges::copy(samples, buffer.Assign(samples.size()).begin());
+                }
+                interpolate(state, buffer, rate, frame, position);
+            }
+            return frame;
+        };
+    };
+
+    auto none = bench_frame(AudioInterp::None);
+    auto linear = bench_frame(AudioInterp::Linear);
+    auto polyphase = bench_frame(AudioInterp::Polyphase);
+    BENCHMARK("None per frame") {
+        return none();
+    };
+    BENCHMARK("Linear per frame") {
+        return linear();
+    };
+    BENCHMARK("Polyphase per frame") {
+        return polyphase();
+    };
+}
+
+} // namespace AudioCore
@@ -0,0 +1,194 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "audio_core/codec.h"
+#include "audio_core/interpolate.h"
+#include "audio_core/sample_kernels.h"
+
+namespace AudioCore {
+
+namespace {
+
+using Sample = std::array<s16, 2>;
+
+std::mt19937 rng{1234};
+
+s16 RandomSample() {
+    return static_cast<s16>(std::uniform_int_distribution<int>(-32768, 32767)(rng));
+}
+
+std::vector<Sample> RandomSamples(std::size_t count) {
+    std::vector<Sample> samples(count);
+    for (auto& sample : samples) {
+        sample = {RandomSample(), RandomSample()};
+    }
+    return samples;
+}
+
+s16 Clamp(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+/// State of the interpolator as it was written against a std::deque.
+struct ReferenceState {
+    Sample xn1 = {}; ///< x[n-1]
+    Sample xn2 = {}; ///< x[n-2]
+    u64 fposition = 0;
+};
+
+/// The interpolator as it was written against a std::deque, kept as the reference.
+void ReferenceLinear(ReferenceState& state, std::deque<Sample>& input, float rate,
+                     StereoFrame16& output, std::size_t& outputi) {
+    constexpr u64 scale_factor = 1 << 24;
+    if (input.empty())
+        return;
+
+    input.insert(input.begin(), {state.xn2, state.xn1});
+
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    u64 fposition = state.fposition;
+    std::size_t inputi = 0;
+
+    while (outputi < output.size()) {
+        inputi = static_cast<std::size_t>(fposition / scale_factor);
+        if (inputi + 2 >= input.size()) {
+            inputi = input.size() - 2;
+            break;
+        }
+        const u64 fraction = fposition & (scale_factor - 1);
+        const Sample& x0 = input[inputi];
+        const Sample& x1 = input[inputi + 1];
+        const s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+        const s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+        output[outputi++] = {static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+                             static_cast<s16>(x0[1] + fraction * delta1 / scale_factor)};
+        fposition += step_size;
+    }
+
+    state.xn2 = input[inputi];
+    state.xn1 = input[inputi + 1];
+    state.fposition = fposition - inputi * scale_factor;
+    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Linear interpolation matches the deque implementation", "[audio_core]") {
+    const float rate = GENERATE(0.3f, 1.0f, 1.37f, 3.9f);
+    const std::vector<Sample> samples = RandomSamples(4000);
+
+    AudioInterp::State state;
+    ReferenceState reference_state;
+    StereoBuffer16 buffer;
+    std::deque<Sample> reference_buffer;
+    std::size_t next = 0;
+
+    while (next < samples.size()) {
+        StereoFrame16 frame{};
+        StereoFrame16 reference_frame{};
+        std::size_t position = 0;
+        std::size_t reference_position = 0;
+        while (position < frame.size() && next < samples.size()) {
+            if (buffer.empty()) {
+                // Buffers of uneven sizes, as applications queue them
+                const std::size_t count = std::min<std::size_t>(samples.size() - next, 97);
+                std::ranges::copy(samples.begin() + next, samples.begin() + next + count,
+                                  buffer.Assign(count).begin());
+                reference_buffer.assign(samples.begin() + next, samples.begin() + next + count);
+                next += count;
+            }
+            AudioInterp::Linear(state, buffer, rate, frame, position);
+            ReferenceLinear(reference_state, reference_buffer, rate, reference_frame,
+                            reference_position);
+            REQUIRE(position == reference_position);
+            REQUIRE(buffer.size() == reference_buffer.size());
+        }
+        REQUIRE(frame == reference_frame);
+        REQUIRE(state.history.back() == reference_state.xn1);
+        REQUIRE(state.history.end()[-2] == reference_state.xn2);
+        REQUIRE(state.fposition == static_cast<s64>(reference_state.fposition));
+    }
+}
+
+TEST_CASE("PCM decoding expands to stereo", "[audio_core]") {
+    // Odd counts cover the scalar tail of the vector loops
+    const std::size_t count = GENERATE(1, 37, 160);
+    std::vector<u8> data(count * 4);
+    std::ranges::generate(data, [] { return static_cast<u8>(rng()); });
+    StereoBuffer16 buffer;
+
+    for (const unsigned num_channels : {1u, 2u}) {
+        Codec::DecodePCM8(num_channels, data.data(), count, buffer);
+        REQUIRE(buffer.size() == count);
+        for (std::size_t i = 0; i < count; i++) {
+            const u8* sample = data.data() + i * num_channels;
+            REQUIRE(buffer[i][0] == static_cast<s16>(sample[0] << 8));
+            REQUIRE(buffer[i][1] == static_cast<s16>(sample[num_channels - 1] << 8));
+        }
+
+        Codec::DecodePCM16(num_channels, data.data(), count, buffer);
+        REQUIRE(buffer.size() == count);
+        for (std::size_t i = 0; i < count; i++) {
+            const u8* sample = data.data() + i * num_channels * 2;
+            const u8* right = sample + (num_channels - 1) * 2;
+            REQUIRE(buffer[i][0] == static_cast<s16>(sample[0] | sample[1] << 8));
+            REQUIRE(buffer[i][1] == static_cast<s16>(right[0] | right[1] << 8));
+        }
+    }
+}
+
+TEST_CASE("Mixing kernels match the scalar formulas", "[audio_core]") {
+    StereoFrame16 frame;
+    std::ranges::generate(frame, [] { return Sample{RandomSample(), RandomSample()}; });
+    QuadFrame32 quad;
+    std::ranges::generate(quad, [] {
+        std::uniform_int_distribution<s32> distribution(-100000, 100000);
+        return std::array<s32, 4>{distribution(rng), distribution(rng), distribution(rng),
+                                  distribution(rng)};
+    });
+    const float gain = GENERATE(0.0f, 0.5f, 1.0f, 0.731f);
+
+    SECTION("source into intermediate mix") {
+        const std::array<float, 4> gains = {gain, 1.0f - gain, -gain, 0.25f};
+        QuadFrame32 dest = quad;
+        Kernels::MixStereoIntoQuad(dest, frame, gains);
+        for (std::size_t i = 0; i < samples_per_frame; i++) {
+            REQUIRE(dest[i][0] == quad[i][0] + static_cast<s32>(gains[0] * frame[i][0]));
+            REQUIRE(dest[i][1] == quad[i][1] + static_cast<s32>(gains[1] * frame[i][1]));
+            REQUIRE(dest[i][2] == quad[i][2] + static_cast<s32>(gains[2] * frame[i][0]));
+            REQUIRE(dest[i][3] == quad[i][3] + static_cast<s32>(gains[3] * frame[i][1]));
+        }
+    }
+
+    SECTION("downmix to stereo") {
+        StereoFrame16 dest = frame;
+        Kernels::DownmixStereoInto(dest, quad, gain);
+        for (std::size_t i = 0; i < samples_per_frame; i++) {
+            const s16 left = Clamp(static_cast<s32>(gain * quad[i][0] + gain * quad[i][2]));
+            const s16 right = Clamp(static_cast<s32>(gain * quad[i][1] + gain * quad[i][3]));
+            REQUIRE(dest[i][0] == Clamp(frame[i][0] + left));
+            REQUIRE(dest[i][1] == Clamp(frame[i][1] + right));
+        }
+    }
+
+    SECTION("downmix to mono") {
+        StereoFrame16 dest = frame;
+        Kernels::DownmixMonoInto(dest, quad, gain);
+        for (std::size_t i = 0; i < samples_per_frame; i++) {
+            const s16 mono = Clamp(static_cast<s32>(
+                (gain * quad[i][0] + gain * quad[i][1] + gain * quad[i][2] + gain * quad[i][3]) /
+                2));
+            REQUIRE(dest[i][0] == Clamp(frame[i][0] + mono));
+            REQUIRE(dest[i][1] == Clamp(frame[i][1] + mono));
+        }
+    }
+}
+
+} // namespace AudioCore
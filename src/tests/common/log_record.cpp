@@ -0,0 +1,46 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/logging/log_record.h"
+
+namespace Common::Log::detail {
+
+namespace {
+
+template <typename... Args>
+std::string RoundTrip(fmt::string_view format, const Args&... args) {
+    std::vector<u8> record((std::size_t{0} + ... + ArgSize(args)));
+    u8* out = record.data();
+    ((out = WriteArg(out, args)), ...);
+    REQUIRE(out == record.data() + record.size());
+    return FormatRecord<Args...>(format, record.data());
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Log records keep their arguments", "[common]") {
+    const std::string owned = "owned";
+    const char* null_text = nullptr;
+    REQUIRE(RoundTrip("{} {} {}", owned, "literal", std::string_view("view")) ==
+            "owned literal view");
+    REQUIRE(RoundTrip("[{}]", null_text) == "[]");
+    REQUIRE(RoundTrip("{:08X} {} {:.2f} {}", 0xBEEFu, -5, 1.5, true) == "0000BEEF -5 1.50 true");
+    REQUIRE(RoundTrip("{}", Level::Error) == "4");
+    REQUIRE(RoundTrip("no arguments") == "no arguments");
+}
+
+TEST_CASE("Log records only defer self-contained arguments", "[common]") {
+    STATIC_REQUIRE(IsDeferrableArg<const char*>);
+    STATIC_REQUIRE(IsDeferrableArg<std::string>);
+    STATIC_REQUIRE(IsDeferrableArg<u64>);
+    STATIC_REQUIRE(IsDeferrableArg<Class>);
+    STATIC_REQUIRE(IsDeferrableArg<const void*>);
+    STATIC_REQUIRE_FALSE(IsDeferrableArg<const int*>);
+    STATIC_REQUIRE_FALSE(IsDeferrableArg<std::vector<u8>>);
+}
+
+} // namespace Common::Log::detail
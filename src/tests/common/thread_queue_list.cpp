@@ -0,0 +1,129 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <sstream>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/thread_queue_list.h"
+
+namespace {
+
+struct TestThread : Common::ThreadQueueListNode<TestThread> {
+    u32 id{};
+
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int) {
+        ar& id;
+    }
+};
+
+constexpr unsigned int NumPriorities = 64;
+using TestQueue = Common::ThreadQueueList<TestThread, NumPriorities>;
+
+} // Anonymous namespace
+
+TEST_CASE("ThreadQueueList orders by priority then insertion", "[common]") {
+    std::array<TestThread, 4> threads{};
+    TestQueue queue;
+
+    REQUIRE(queue.get_first() == nullptr);
+    queue.push_back(10, &threads[0]);
+    queue.push_back(5, &threads[1]);
+    queue.push_back(10, &threads[2]);
+    queue.push_front(10, &threads[3]);
+
+    REQUIRE(queue.contains(&threads[2]) == 10);
+    REQUIRE(queue.get_first() == &threads[1]);
+    REQUIRE(queue.pop_first_better(5) == nullptr);
+    REQUIRE(queue.pop_first_better(6) == &threads[1]);
+    REQUIRE(queue.empty(5));
+    REQUIRE(queue.pop_first() == &threads[3]);
+    REQUIRE(queue.pop_first() == &threads[0]);
+    REQUIRE(queue.pop_first() == &threads[2]);
+    REQUIRE(queue.pop_first() == nullptr);
+    REQUIRE(queue.contains(&threads[2]) == static_cast<TestQueue::Priority>(-1));
+}
+
+TEST_CASE("ThreadQueueList removes and moves queued elements", "[common]") {
+    std::array<TestThread, 3> threads{};
+    TestQueue queue;
+
+    for (auto& thread : threads) {
+        queue.push_back(63, &thread);
+    }
+    queue.remove(&threads[1]);
+    // Removing an element that is not queued is allowed
+    queue.remove(&threads[1]);
+    queue.move(&threads[2], 0);
+
+    REQUIRE(queue.pop_first() == &threads[2]);
+    REQUIRE(queue.pop_first() == &threads[0]);
+    REQUIRE(queue.get_first() == nullptr);
+    REQUIRE(queue.empty(63));
+}
+
+TEST_CASE("ThreadQueueList serialization keeps the queue order", "[common]") {
+    std::array<TestThread, 3> threads{};
+    TestQueue queue;
+    for (u32 i = 0; i < threads.size(); i++) {
+        threads[i].id = i;
+    }
+    queue.push_back(20, &threads[0]);
+    queue.push_back(3, &threads[1]);
+    queue.push_back(20, &threads[2]);
+
+    std::stringstream stream;
+    {
+        boost::archive::binary_oarchive oa{stream};
+        oa << queue;
+    }
+    TestQueue loaded;
+    {
+        boost::archive::binary_iarchive ia{stream};
+        ia >> loaded;
+    }
+
+    std::array<u32, 3> order{};
+    for (auto& id : order) {
+        TestThread* thread = loaded.pop_first();
+        REQUIRE(thread != nullptr);
+        id = thread->id;
+        delete thread;
+    }
+    REQUIRE(order == std::array<u32, 3>{1, 0, 2});
+    REQUIRE(loaded.get_first() == nullptr);
+}
+
+TEST_CASE("ThreadQueueList[Benchmark]", "[.][benchmark][common]") {
+    static constexpr std::size_t NumThreads = 64;
+
+    std::array<TestThread, NumThreads> threads{};
+    TestQueue queue;
+    for (std::size_t i = 0; i < NumThreads; i++) {
+        queue.push_back((i * 7) % 40 + 20, &threads[i]);
+    }
+
+    // Mimics a reschedule: the running thread is preempted by a better one, which is pushed back
+    // after running.
+    BENCHMARK("Preempt and requeue") {
+        TestThread* running = queue.pop_first();
+        const auto priority = (running - threads.data()) % 40 + 20;
+        TestThread* next = queue.pop_first_better(static_cast<TestQueue::Priority>(priority));
+        queue.push_front(static_cast<TestQueue::Priority>(priority), running);
+        if (next) {
+            queue.push_back(static_cast<TestQueue::Priority>(priority), next);
+        }
+        return next;
+    };
+    BENCHMARK("Remove and reinsert a waiting thread") {
+        TestThread* thread = &threads[NumThreads / 2];
+        const auto priority = queue.contains(thread);
+        queue.remove(thread);
+        queue.push_back(priority, thread);
+        return priority;
+    };
+}
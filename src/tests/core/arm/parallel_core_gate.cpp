@@ -0,0 +1,103 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/arm/parallel_core_gate.h"
+
+namespace Core {
+
+namespace {
+
+/// Stands in for a JIT, Run spins until it is halted or has executed its slice.
+struct FakeCore {
+    std::atomic_bool halt_requested{};
+    std::atomic<int> executed{};
+    int slice = 0;
+
+    /// Returns whether the slice is over.
+    bool Run(ParallelCoreGate& gate, std::atomic<int>& in_kernel, std::atomic<int>& violations,
+             u32 core_id) {
+        while (executed < slice) {
+            if (halt_requested.exchange(false)) {
+                return false;
+            }
+            if (in_kernel.load() != 0) {
+                ++violations;
+            }
+            // Every few instructions the core calls into the kernel
+            if (++executed % 16 == 0) {
+                gate.StopOthers(core_id);
+                if (in_kernel.fetch_add(1) != 0) {
+                    ++violations;
+                }
+                std::this_thread::yield();
+                in_kernel.fetch_sub(1);
+                gate.ResumeOthers(core_id);
+            }
+        }
+        return true;
+    }
+};
+
+} // Anonymous namespace
+
+TEST_CASE("ParallelCoreGate keeps guest code out of the kernel", "[core][arm]") {
+    constexpr u32 num_cores = 4;
+    std::array<FakeCore, num_cores> cores;
+    ParallelCoreGate gate{[&](u32 core_id) { cores[core_id].halt_requested = true; }};
+    std::atomic<int> in_kernel{};
+    std::atomic<int> violations{};
+
+    std::vector<std::thread> threads;
+    for (u32 core_id = 0; core_id < num_cores; ++core_id) {
+        cores[core_id].slice = 2000;
+        threads.emplace_back([&, core_id] {
+            auto& core = cores[core_id];
+            bool done = false;
+            while (!done) {
+                gate.EnterGuest(core_id);
+                done = core.Run(gate, in_kernel, violations, core_id);
+                gate.LeaveGuest(core_id);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(violations == 0);
+    for (const auto& core : cores) {
+        REQUIRE(core.executed == 2000);
+    }
+}
+
+TEST_CASE("ParallelCoreGate reports cores halted by another core", "[core][arm]") {
+    std::atomic<u32> halted_core{ParallelCoreGate::MaxCores};
+    ParallelCoreGate gate{[&](u32 core_id) { halted_core = core_id; }};
+
+    gate.EnterGuest(0);
+    gate.EnterGuest(1);
+    bool stopper_halted = true;
+    std::thread stopper{[&] {
+        gate.StopOthers(1);
+        gate.ResumeOthers(1);
+        stopper_halted = gate.LeaveGuest(1);
+    }};
+    // Core 0 only leaves its guest code once the halt arrived
+    while (halted_core != 0) {
+        std::this_thread::yield();
+    }
+    REQUIRE(gate.LeaveGuest(0));
+    stopper.join();
+    REQUIRE_FALSE(stopper_halted);
+
+    gate.EnterGuest(0);
+    REQUIRE_FALSE(gate.LeaveGuest(0));
+}
+
+} // namespace Core
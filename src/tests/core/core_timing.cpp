@@ -2,11 +2,15 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <string>
+#include <thread>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -196,4 +200,80 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
 }
 
+static void RunSlice(Core::Timing& timing, std::size_t core) {
+    const auto timer = timing.GetTimer(core);
+    timer->AddTicks(timer->GetDowncount());
+    timer->Advance();
+    timer->SetNextSlice();
+}
+
+TEST_CASE("CoreTiming[CrossThreadScheduling]", "[core]") {
+    static constexpr int NUM_THREADS = 4;
+    static constexpr int EVENTS_PER_THREAD = 1000;
+
+    Core::Timing timing(2, 100);
+    std::atomic<int> fired = 0;
+    std::array<std::uintptr_t, NUM_THREADS> last_seen{};
+    Core::TimingEventType* cb = timing.RegisterEvent(
+        "callbackCrossThread", [&](std::uintptr_t user_data, s64 cycles_late) {
+            // Events pushed by one thread with the same delay must keep their order.
+            const std::uintptr_t thread = user_data / EVENTS_PER_THREAD;
+            REQUIRE(user_data % EVENTS_PER_THREAD == last_seen[thread]);
+            last_seen[thread]++;
+            fired++;
+        });
+
+    // Enter slice 0 on both cores
+    RunSlice(timing, 0);
+    RunSlice(timing, 1);
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([&timing, cb, thread] {
+            for (int i = 0; i < EVENTS_PER_THREAD; i++) {
+                timing.ScheduleEvent(0, cb, thread * EVENTS_PER_THREAD + i, 0, true);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int slice = 0; slice < 4 && fired < NUM_THREADS * EVENTS_PER_THREAD; slice++) {
+        RunSlice(timing, 0);
+    }
+    REQUIRE(fired == NUM_THREADS * EVENTS_PER_THREAD);
+}
+
+TEST_CASE("CoreTiming[Benchmark]", "[.][benchmark][core]") {
+    static constexpr int NUM_EVENTS = 64;
+
+    Core::Timing timing(2, 100);
+    int dispatched = 0;
+    Core::TimingEventType* cb =
+        timing.RegisterEvent("callbackBench", [&](std::uintptr_t, s64) { dispatched++; });
+    RunSlice(timing, 0);
+    RunSlice(timing, 1);
+
+    const auto schedule_and_dispatch = [&](std::size_t scheduling_core) {
+        timing.SetCurrentTimer(scheduling_core);
+        for (int i = 0; i < NUM_EVENTS; i++) {
+            timing.ScheduleEvent((i * 7919) % MAX_SLICE_LENGTH + 1, cb, i, 0);
+        }
+        timing.SetCurrentTimer(0);
+
+        const int target = dispatched + NUM_EVENTS;
+        while (dispatched < target) {
+            RunSlice(timing, 0);
+        }
+    };
+
+    BENCHMARK("Schedule and dispatch on the current core") {
+        schedule_and_dispatch(0);
+    };
+    BENCHMARK("Schedule from another core and dispatch") {
+        schedule_and_dispatch(1);
+    };
+}
+
 // TODO: Add tests for multiple timers
@@ -0,0 +1,111 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <filesystem>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/layered_fs.h"
+
+namespace FileSys {
+
+namespace {
+
+/// RomFS with only a root directory, held in memory
+class EmptyRomFS : public RomFSReader {
+public:
+    EmptyRomFS() : data(0x60, 0xFF) {
+        const RomFSHeader header{
+            .header_length = sizeof(RomFSHeader),
+            .directory_hash_table = {0x28, 0xC},
+            .directory_metadata_table = {0x34, 0x18},
+            .file_hash_table = {0x4C, 0xC},
+            .file_metadata_table = {0x58, 0},
+            .file_data_offset = 0x60,
+        };
+        std::memcpy(data.data(), &header, sizeof(header));
+        // The root directory is its own parent and has no name
+        std::memset(data.data() + 0x34, 0, sizeof(u32));
+        std::memset(data.data() + 0x34 + 0x14, 0, sizeof(u32));
+    }
+
+    std::size_t GetSize() const override {
+        return data.size();
+    }
+
+    std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override {
+        length = std::min(length, data.size() - offset);
+        std::memcpy(buffer, data.data() + offset, length);
+        return length;
+    }
+
+    bool AllowsCachedReads() const override {
+        return false;
+    }
+
+    bool CacheReady(std::size_t file_offset, std::size_t length) override {
+        return false;
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+void WriteFile(const std::string& path, const std::string& contents) {
+    FileUtil::CreateFullPath(path);
+    FileUtil::IOFile file(path, "wb");
+    file.WriteBytes(contents.data(), contents.size());
+}
+
+std::vector<u8> ReadAll(LayeredFS& layered_fs) {
+    std::vector<u8> data(layered_fs.GetSize());
+    layered_fs.ReadFile(0, data.size(), data.data());
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LayeredFS metadata cache", "[core][file_sys]") {
+    const auto base = (std::filesystem::temp_directory_path() / "lemonade_layered_fs_test").string();
+    std::filesystem::remove_all(base);
+    const std::string patch_path = base + "/romfs/";
+    const std::string cache_path = base + "/cache.bin";
+    WriteFile(patch_path + "a.txt", "hello");
+    WriteFile(patch_path + "dir/b.bin", std::string(100, 'b'));
+
+    const auto romfs = std::make_shared<EmptyRomFS>();
+    LayeredFS uncached(romfs, patch_path, "", true);
+    const auto expected = ReadAll(uncached);
+
+    SECTION("is written and then loaded") {
+        LayeredFS first(romfs, patch_path, "", true, cache_path);
+        REQUIRE(FileUtil::Exists(cache_path));
+        REQUIRE(ReadAll(first) == expected);
+
+        LayeredFS second(romfs, patch_path, "", true, cache_path);
+        REQUIRE(second.GetSize() == uncached.GetSize());
+        REQUIRE(ReadAll(second) == expected);
+    }
+
+    SECTION("is rebuilt when the patch directory changes") {
+        LayeredFS first(romfs, patch_path, "", true, cache_path);
+        WriteFile(patch_path + "c.txt", "new file");
+
+        LayeredFS second(romfs, patch_path, "", true, cache_path);
+        LayeredFS reference(romfs, patch_path, "", true);
+        REQUIRE(second.GetSize() > first.GetSize());
+        REQUIRE(ReadAll(second) == ReadAll(reference));
+    }
+
+    SECTION("ignores a corrupted cache") {
+        WriteFile(cache_path, "garbage");
+        LayeredFS layered_fs(romfs, patch_path, "", true, cache_path);
+        REQUIRE(ReadAll(layered_fs) == expected);
+    }
+
+    std::filesystem::remove_all(base);
+}
+
+} // namespace FileSys
@@ -0,0 +1,183 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "common/file_util.h"
+#include "common/settings.h"
+#include "core/file_sys/romfs_reader.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr std::size_t FileOffset = 0x200;
+constexpr std::size_t CryptoOffset = 0x1000;
+constexpr std::array<u8, 16> Key{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+                                 0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+constexpr std::array<u8, 16> Ctr{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                                 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+
+std::vector<u8> MakeData(std::size_t size) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; i++) {
+        data[i] = static_cast<u8>(i * 7 + (i >> 12));
+    }
+    return data;
+}
+
+std::string WriteFile(const std::vector<u8>& data, bool encrypted,
+                      std::string_view name = "lemonade_romfs_reader_test.bin") {
+    std::vector<u8> contents(FileOffset + data.size(), 0xCC);
+    std::copy(data.begin(), data.end(), contents.begin() + FileOffset);
+    if (encrypted) {
+        CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption e(Key.data(), Key.size(), Ctr.data());
+        e.Seek(CryptoOffset);
+        e.ProcessData(contents.data() + FileOffset, contents.data() + FileOffset, data.size());
+    }
+    const auto path = (std::filesystem::temp_directory_path() / name).string();
+    FileUtil::IOFile file(path, "wb");
+    file.WriteBytes(contents.data(), contents.size());
+    return path;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DirectRomFSReader reads through the block cache", "[core][file_sys]") {
+    const auto data = MakeData(3 * 1024 * 1024 + 123);
+    const auto path = WriteFile(data, true);
+
+    Settings::values.romfs_cache_size = 1;
+    Settings::values.romfs_read_ahead = false;
+
+    auto reader = std::make_shared<DirectRomFSReader>(FileUtil::IOFile(path, "rb"), FileOffset,
+                                                      data.size(), Key, Ctr, CryptoOffset);
+
+    const auto check_read = [&](std::size_t offset, std::size_t length) {
+        std::vector<u8> buffer(length);
+        const std::size_t expected = std::min(length, data.size() - offset);
+        REQUIRE(reader->ReadFile(offset, length, buffer.data()) == expected);
+        REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected, data.begin() + offset));
+    };
+
+    SECTION("caches small reads") {
+        REQUIRE_FALSE(reader->CacheReady(0x12345, 0x100));
+        check_read(0x12345, 0x100);
+        REQUIRE(reader->CacheReady(0x12345, 0x100));
+        check_read(0x12300, 0x200);
+
+        const auto stats = reader->GetCacheStats();
+        REQUIRE(stats.misses == 1);
+        REQUIRE(stats.hits == 1);
+    }
+
+    SECTION("reads across blocks") {
+        check_read(0x7FF0, 0x20);
+        check_read(0x10, 0x30000);
+        REQUIRE(reader->GetCacheStats().misses == 7);
+    }
+
+    SECTION("truncates reads past the end") {
+        check_read(data.size() - 0x10, 0x100);
+        std::vector<u8> buffer(0x10);
+        REQUIRE(reader->ReadFile(data.size(), buffer.size(), buffer.data()) == 0);
+    }
+
+    SECTION("bypasses the cache for large reads") {
+        check_read(0x100, 512 * 1024);
+        REQUIRE(reader->GetCacheStats().bypassed == 1);
+        REQUIRE_FALSE(reader->CacheReady(0x100, 512 * 1024));
+    }
+
+    SECTION("evicts the least recently used blocks") {
+        for (std::size_t offset = 0; offset < data.size(); offset += 0x4000) {
+            check_read(offset, 0x4000);
+        }
+        REQUIRE_FALSE(reader->CacheReady(0, 0x100));
+        REQUIRE(reader->CacheReady(data.size() - 0x100, 0x100));
+    }
+
+    reader.reset();
+    std::filesystem::remove(path);
+
+    Settings::values.romfs_cache_size = 16;
+    Settings::values.romfs_read_ahead = true;
+}
+
+TEST_CASE("DirectRomFSReader reads ahead sequential reads", "[core][file_sys]") {
+    const auto data = MakeData(2 * 1024 * 1024);
+    const auto path = WriteFile(data, true);
+
+    Settings::values.romfs_cache_size = 4;
+    Settings::values.romfs_read_ahead = true;
+
+    auto reader = std::make_shared<DirectRomFSReader>(FileUtil::IOFile(path, "rb"), FileOffset,
+                                                      data.size(), Key, Ctr, CryptoOffset);
+    std::vector<u8> buffer(data.size());
+    for (std::size_t offset = 0; offset < data.size(); offset += 0x10000) {
+        REQUIRE(reader->ReadFile(offset, 0x10000, buffer.data() + offset) == 0x10000);
+    }
+    REQUIRE(buffer == data);
+
+    // The cache holds all the data, so every block is read from the file exactly once
+    const auto stats = reader->GetCacheStats();
+    REQUIRE(stats.misses + stats.read_ahead == data.size() / (32 * 1024));
+
+    reader.reset();
+    std::filesystem::remove(path);
+
+    Settings::values.romfs_cache_size = 16;
+}
+
+TEST_CASE("DirectRomFSReader instances share one block cache", "[core][file_sys]") {
+    const auto data_a = MakeData(2 * 1024 * 1024);
+    auto data_b = data_a;
+    std::ranges::reverse(data_b);
+    const auto path_a = WriteFile(data_a, true, "lemonade_romfs_reader_test_a.bin");
+    const auto path_b = WriteFile(data_b, false, "lemonade_romfs_reader_test_b.bin");
+
+    Settings::values.romfs_cache_size = 1;
+    Settings::values.romfs_read_ahead = false;
+
+    auto reader_a = std::make_shared<DirectRomFSReader>(FileUtil::IOFile(path_a, "rb"),
+                                                        FileOffset, data_a.size(), Key, Ctr,
+                                                        CryptoOffset);
+    auto reader_b =
+        std::make_shared<DirectRomFSReader>(FileUtil::IOFile(path_b, "rb"), FileOffset,
+                                            data_b.size());
+
+    // The same blocks of different readers are cached apart
+    std::vector<u8> buffer(0x100);
+    REQUIRE(reader_a->ReadFile(0x1000, buffer.size(), buffer.data()) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data_a.begin() + 0x1000));
+    REQUIRE(reader_b->ReadFile(0x1000, buffer.size(), buffer.data()) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data_b.begin() + 0x1000));
+    REQUIRE(reader_a->CacheReady(0x1000, buffer.size()));
+    REQUIRE(reader_b->CacheReady(0x1000, buffer.size()));
+
+    // Reading through one reader evicts the blocks of the other
+    for (std::size_t offset = 0; offset < data_b.size(); offset += buffer.size()) {
+        reader_b->ReadFile(offset, buffer.size(), buffer.data());
+    }
+    REQUIRE_FALSE(reader_a->CacheReady(0x1000, buffer.size()));
+
+    // The blocks of a destroyed reader are dropped, the remaining one keeps reading
+    reader_b.reset();
+    REQUIRE(reader_a->ReadFile(0x1000, buffer.size(), buffer.data()) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data_a.begin() + 0x1000));
+    REQUIRE(reader_a->GetCacheStats().misses == 2);
+
+    reader_a.reset();
+    std::filesystem::remove(path_a);
+    std::filesystem::remove(path_b);
+
+    Settings::values.romfs_cache_size = 16;
+    Settings::values.romfs_read_ahead = true;
+}
+
+} // namespace FileSys
@@ -7,6 +7,7 @@
 #include "core/core_timing.h"
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/hle_ipc.h"
@@ -402,4 +403,180 @@ TEST_CASE("HLERequestContext::WriteToOutgoingCommandBuffer", "[core][kernel]") {
     }
 }
 
+TEST_CASE("HLERequestContextPool reuses released contexts", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, Kernel::MemoryMode::Prod,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    auto [server, client] = kernel.CreateSessionPair();
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    HLERequestContextPool pool(kernel);
+
+    auto mem = std::make_shared<BufferMem>(Memory::CITRA_PAGE_SIZE);
+    MemoryRef buffer{mem};
+    std::fill(buffer.GetPtr(), buffer.GetPtr() + buffer.GetSize(), 0xAB);
+
+    VAddr target_address = 0x10000000;
+    auto result = process->vm_manager.MapBackingMemory(
+        target_address, buffer, static_cast<u32>(buffer.GetSize()), MemoryState::Private);
+    REQUIRE(result.Code() == ResultSuccess);
+
+    const u32_le input[]{
+        IPC::MakeHeader(0, 1, 2),
+        0x12345678,
+        IPC::StaticBufferDesc(buffer.GetSize(), 0),
+        target_address,
+    };
+
+    const auto handle_request = [&] {
+        auto context = pool.Acquire(server, nullptr);
+        context->PopulateFromIncomingCommandBuffer(input, process);
+        CHECK(context->CommandBuffer()[1] == 0x12345678);
+        CHECK(context->GetStaticBuffer(0) == mem->Vector());
+        const auto handled = std::make_pair(context.get(), context->GetStaticBuffer(0).data());
+        pool.Release(std::move(context));
+        return handled;
+    };
+
+    // Later requests get the same context, with the storage of its static buffer kept
+    const auto first = handle_request();
+    for (int i = 0; i < 8; i++) {
+        REQUIRE(handle_request() == first);
+    }
+
+    SECTION("does not recycle contexts that are still referenced") {
+        auto context = pool.Acquire(server, nullptr);
+        auto kept = context;
+        pool.Release(std::move(context));
+        REQUIRE(pool.Acquire(server, nullptr) != kept);
+    }
+
+    REQUIRE(process->vm_manager.UnmapRange(target_address, static_cast<u32>(buffer.GetSize())) ==
+            ResultSuccess);
+}
+
+TEST_CASE("MemorySystem::GetPlainMemoryPointer", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, Kernel::MemoryMode::Prod,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+
+    auto mem = std::make_shared<BufferMem>(2 * Memory::CITRA_PAGE_SIZE);
+    MemoryRef buffer{mem};
+    const VAddr target_address = 0x10000000;
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(target_address, buffer, static_cast<u32>(buffer.GetSize()),
+                                  MemoryState::Private)
+                .Code() == ResultSuccess);
+
+    SECTION("points into plain memory within a page") {
+        REQUIRE(memory.GetPlainMemoryPointer(*process, target_address + 0x80, 0x100) ==
+                buffer.GetPtr() + 0x80);
+        REQUIRE(memory.GetPlainMemoryPointer(*process,
+                                             target_address + Memory::CITRA_PAGE_SIZE + 0xF00,
+                                             0x100) == buffer.GetPtr() + Memory::CITRA_PAGE_SIZE +
+                                                           0xF00);
+    }
+
+    SECTION("rejects blocks crossing a page or outside of memory") {
+        REQUIRE(memory.GetPlainMemoryPointer(*process, target_address + 0xF80, 0x100) == nullptr);
+        REQUIRE(memory.GetPlainMemoryPointer(*process, target_address + buffer.GetSize(), 0x10) ==
+                nullptr);
+    }
+
+    SECTION("translates a command buffer in place") {
+        // As done for the command buffer in the TLS of a thread making a request
+        auto* cmd_buf = reinterpret_cast<u32_le*>(
+            memory.GetPlainMemoryPointer(*process, target_address + 0x80, 0x100));
+        REQUIRE(cmd_buf != nullptr);
+        auto [server, client] = kernel.CreateSessionPair();
+        Handle handle;
+        process->handle_table.Create(std::addressof(handle), MakeObject(kernel));
+        cmd_buf[0] = IPC::MakeHeader(0x1234, 1, 2);
+        cmd_buf[1] = 0xAABBCCDD;
+        cmd_buf[2] = IPC::MoveHandleDesc(1);
+        cmd_buf[3] = handle;
+
+        HLERequestContext context(kernel, std::move(server), nullptr);
+        REQUIRE(context.PopulateFromIncomingCommandBuffer(cmd_buf, process) == ResultSuccess);
+        REQUIRE(context.CommandBuffer()[1] == 0xAABBCCDD);
+        REQUIRE(process->handle_table.GetGeneric(handle) == nullptr);
+
+        context.CommandBuffer()[1] = 0x11223344;
+        REQUIRE(context.WriteToOutgoingCommandBuffer(cmd_buf, *process) == ResultSuccess);
+        u32_le response[4];
+        memory.ReadBlock(*process, target_address + 0x80, response, sizeof(response));
+        REQUIRE(response[1] == 0x11223344);
+        REQUIRE(response[2] == IPC::MoveHandleDesc(1));
+        REQUIRE(process->handle_table.GetGeneric(response[3]) != nullptr);
+    }
+
+    REQUIRE(process->vm_manager.UnmapRange(target_address, static_cast<u32>(buffer.GetSize())) ==
+            ResultSuccess);
+}
+
+namespace {
+class SessionDataHandler final : public SessionRequestHandler {
+public:
+    struct Data : SessionDataBase {
+        u32 value = 0;
+    };
+
+    void HandleSyncRequest(HLERequestContext&) override {}
+
+    Data* Get(const std::shared_ptr<ServerSession>& session) {
+        return GetSessionData<Data>(session);
+    }
+
+protected:
+    std::unique_ptr<SessionDataBase> MakeSessionData() override {
+        return std::make_unique<Data>();
+    }
+};
+} // Anonymous namespace
+
+TEST_CASE("SessionRequestHandler::GetSessionData", "[core][kernel]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, Kernel::MemoryMode::Prod,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    auto handler = std::make_shared<SessionDataHandler>();
+
+    std::vector<std::shared_ptr<ServerSession>> sessions;
+    std::vector<std::shared_ptr<ClientSession>> clients;
+    for (u32 i = 0; i < 4; i++) {
+        auto [server, client] = kernel.CreateSessionPair();
+        sessions.push_back(std::move(server));
+        clients.push_back(std::move(client));
+        handler->ClientConnected(sessions.back());
+        handler->Get(sessions.back())->value = i;
+    }
+    for (u32 i = 0; i < 4; i++) {
+        REQUIRE(handler->Get(sessions[i])->value == i);
+    }
+
+    // Disconnecting moves the last session into the freed slot, the others keep their data
+    handler->ClientDisconnected(sessions[1]);
+    REQUIRE(handler->Get(sessions[0])->value == 0);
+    REQUIRE(handler->Get(sessions[2])->value == 2);
+    REQUIRE(handler->Get(sessions[3])->value == 3);
+
+    handler->ClientDisconnected(sessions[3]);
+    handler->ClientConnected(sessions[1]);
+    REQUIRE(handler->Get(sessions[1])->value == 0);
+    REQUIRE(handler->Get(sessions[0])->value == 0);
+    REQUIRE(handler->Get(sessions[2])->value == 2);
+
+    // Disconnecting a session that is not connected leaves the others alone
+    handler->ClientDisconnected(sessions[3]);
+    REQUIRE(handler->Get(sessions[2])->value == 2);
+}
+
 } // namespace Kernel
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/process.h"
@@ -55,3 +56,107 @@ TEST_CASE("memory.IsValidVirtualAddress", "[core][memory]") {
         CHECK(memory.IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("memory.GetPhysicalPointer", "[core][memory]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+
+    const PAddr address = GENERATE(as<PAddr>{}, Memory::VRAM_PADDR, Memory::VRAM_PADDR + 0x1234,
+                                   Memory::VRAM_PADDR_END, Memory::FCRAM_PADDR,
+                                   Memory::FCRAM_PADDR + 0x56789, Memory::FCRAM_N3DS_PADDR_END,
+                                   Memory::N3DS_EXTRA_RAM_PADDR);
+    CHECK(memory.GetPhysicalPointer(address) == memory.GetPhysicalRef(address).GetPtr());
+}
+
+TEST_CASE("memory.RasterizerCachedPages", "[core][memory]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    auto page_table = std::make_shared<Memory::PageTable>();
+    page_table->Clear();
+    memory.RegisterPageTable(page_table);
+    memory.SetCurrentPageTable(page_table);
+
+    // Cached pages are resolved through the TLB, check them against the physical memory
+    const auto is_vram_at = [&](VAddr offset) {
+        return memory.GetPointer(Memory::VRAM_VADDR + offset) ==
+               memory.GetPhysicalPointer(Memory::VRAM_PADDR + offset);
+    };
+    const auto page_type = [&](const Memory::PageTable& table, VAddr vaddr) {
+        return table.attributes[vaddr >> Memory::CITRA_PAGE_BITS];
+    };
+
+    memory.MapMemoryRegion(*page_table, Memory::VRAM_VADDR, Memory::VRAM_SIZE,
+                           memory.GetPhysicalRef(Memory::VRAM_PADDR));
+    memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::VRAM_SIZE, true);
+    REQUIRE(page_type(*page_table, Memory::VRAM_VADDR) == Memory::PageType::RasterizerCachedMemory);
+
+    SECTION("repeated lookups of a page hit the same translation") {
+        for (int i = 0; i < 2; i++) {
+            CHECK(is_vram_at(0));
+            CHECK(is_vram_at(0x123));
+            CHECK(is_vram_at(Memory::CITRA_PAGE_MASK));
+        }
+    }
+
+    SECTION("neighbouring pages and pages sharing a TLB slot resolve separately") {
+        // 256 pages apart map to the same slot of the direct mapped TLB
+        constexpr VAddr same_slot = 256 * Memory::CITRA_PAGE_SIZE;
+        for (int i = 0; i < 2; i++) {
+            CHECK(is_vram_at(Memory::CITRA_PAGE_MASK));
+            CHECK(is_vram_at(Memory::CITRA_PAGE_SIZE));
+            CHECK(is_vram_at(same_slot + 0x10));
+            CHECK(is_vram_at(0x10));
+            CHECK(is_vram_at(Memory::VRAM_SIZE - 1));
+        }
+        for (VAddr offset = 0; offset < Memory::VRAM_SIZE; offset += Memory::CITRA_PAGE_SIZE) {
+            CHECK(is_vram_at(offset + 0x40));
+        }
+    }
+
+    SECTION("remapping a page is seen by later lookups") {
+        CHECK(is_vram_at(0x80));
+        memory.UnmapRegion(*page_table, Memory::VRAM_VADDR, Memory::CITRA_PAGE_SIZE);
+        CHECK(page_type(*page_table, Memory::VRAM_VADDR) == Memory::PageType::Unmapped);
+        CHECK(is_vram_at(Memory::CITRA_PAGE_SIZE + 0x80));
+
+        // The region is still cached, so the page comes back as a cached page
+        memory.MapMemoryRegion(*page_table, Memory::VRAM_VADDR, Memory::CITRA_PAGE_SIZE,
+                               memory.GetPhysicalRef(Memory::VRAM_PADDR));
+        CHECK(page_type(*page_table, Memory::VRAM_VADDR) ==
+              Memory::PageType::RasterizerCachedMemory);
+        CHECK(is_vram_at(0x80));
+
+        memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::CITRA_PAGE_SIZE, false);
+        CHECK(page_type(*page_table, Memory::VRAM_VADDR) == Memory::PageType::Memory);
+        CHECK(is_vram_at(0x80));
+        CHECK(page_type(*page_table, Memory::VRAM_VADDR + Memory::CITRA_PAGE_SIZE) ==
+              Memory::PageType::RasterizerCachedMemory);
+        CHECK(is_vram_at(Memory::CITRA_PAGE_SIZE + 0x80));
+    }
+
+    SECTION("switching page tables switches the translations") {
+        // Mapped before the region is marked cached and never registered, so it stays plain memory
+        memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::VRAM_SIZE, false);
+        auto other_table = std::make_shared<Memory::PageTable>();
+        other_table->Clear();
+        memory.MapMemoryRegion(*other_table, Memory::VRAM_VADDR, Memory::CITRA_PAGE_SIZE,
+                               memory.GetPhysicalRef(Memory::FCRAM_PADDR));
+        memory.RasterizerMarkRegionCached(Memory::VRAM_PADDR, Memory::VRAM_SIZE, true);
+        REQUIRE(page_type(*other_table, Memory::VRAM_VADDR) == Memory::PageType::Memory);
+
+        for (int i = 0; i < 2; i++) {
+            memory.SetCurrentPageTable(page_table);
+            CHECK(is_vram_at(0x20));
+            memory.SetCurrentPageTable(other_table);
+            CHECK(memory.GetPointer(Memory::VRAM_VADDR + 0x20) ==
+                  memory.GetPhysicalPointer(Memory::FCRAM_PADDR + 0x20));
+        }
+
+        // A page table that goes away takes its translations with it
+        memory.SetCurrentPageTable(page_table);
+        CHECK(is_vram_at(0x20));
+        memory.UnregisterPageTable(page_table);
+        page_table->Clear();
+        CHECK(page_type(*page_table, Memory::VRAM_VADDR) == Memory::PageType::Unmapped);
+    }
+}
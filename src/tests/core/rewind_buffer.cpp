@@ -0,0 +1,132 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/memory.h"
+#include "core/rewind_buffer.h"
+
+namespace {
+constexpr std::size_t NumPages = 16;
+
+void TakeSnapshot(Core::RewindBuffer& buffer, std::vector<u8>& memory, u8 value) {
+    memory[5 * Memory::CITRA_PAGE_SIZE] = value;
+    buffer.BeginSnapshot();
+    for (std::size_t page = 0; page < NumPages; page++) {
+        buffer.StorePage(std::span<const u8>{memory}.subspan(page * Memory::CITRA_PAGE_SIZE,
+                                                             Memory::CITRA_PAGE_SIZE));
+    }
+    const std::array<u8, 1> state{value};
+    buffer.EndSnapshot(state);
+}
+} // Anonymous namespace
+
+TEST_CASE("RewindBuffer restores snapshots newest first", "[core][rewind]") {
+    Core::RewindBuffer buffer{16 * 1024 * 1024};
+    std::vector<u8> memory(NumPages * Memory::CITRA_PAGE_SIZE);
+    for (u8 i = 1; i <= 4; i++) {
+        TakeSnapshot(buffer, memory, i);
+    }
+    REQUIRE(buffer.GetSnapshotCount() == 4);
+
+    const auto state = buffer.RestoreSnapshot(2);
+    REQUIRE(state);
+    REQUIRE(*state == std::vector<u8>{3});
+    REQUIRE(buffer.GetSnapshotCount() == 2);
+
+    REQUIRE(buffer.RestoreSnapshot(10) == std::vector<u8>{1});
+    REQUIRE(buffer.GetSnapshotCount() == 0);
+    REQUIRE(!buffer.RestoreSnapshot(1));
+}
+
+TEST_CASE("RewindBuffer deduplicates unchanged pages", "[core][rewind]") {
+    Core::RewindBuffer buffer{16 * 1024 * 1024};
+    std::vector<u8> memory(NumPages * Memory::CITRA_PAGE_SIZE);
+    memory[0] = 0xAA;
+
+    buffer.BeginSnapshot();
+    buffer.StorePage(std::span<const u8>{memory}.subspan(0, Memory::CITRA_PAGE_SIZE));
+    buffer.EndSnapshot(std::array<u8, 1>{0});
+    const std::size_t size = buffer.GetSize();
+
+    buffer.BeginSnapshot();
+    const u64 key =
+        buffer.StorePage(std::span<const u8>{memory}.subspan(0, Memory::CITRA_PAGE_SIZE));
+    buffer.EndSnapshot(std::array<u8, 1>{0});
+    // Only the serialized state and the page key are stored again
+    REQUIRE(buffer.GetSize() < size + Memory::CITRA_PAGE_SIZE / 16);
+
+    REQUIRE(buffer.RestoreSnapshot(1));
+    std::vector<u8> page(Memory::CITRA_PAGE_SIZE);
+    buffer.LoadPage(key, page);
+    REQUIRE(page[0] == 0xAA);
+}
+
+TEST_CASE("RewindBuffer restores the pages of each snapshot", "[core][rewind]") {
+    Core::RewindBuffer buffer{16 * 1024 * 1024};
+    std::vector<u8> memory(NumPages * Memory::CITRA_PAGE_SIZE);
+    for (std::size_t page = 0; page < NumPages; page++) {
+        memory[page * Memory::CITRA_PAGE_SIZE] = static_cast<u8>(page);
+    }
+    for (u8 i = 1; i <= 3; i++) {
+        TakeSnapshot(buffer, memory, i);
+    }
+
+    // The memory changes while the snapshots are stored, they keep the pages taken with them
+    memory.assign(memory.size(), 0xFF);
+    REQUIRE(buffer.RestoreSnapshot(2) == std::vector<u8>{2});
+    std::vector<u8> page(Memory::CITRA_PAGE_SIZE);
+    for (std::size_t i = 0; i < NumPages; i++) {
+        buffer.LoadPage(i, page);
+        REQUIRE(page[0] == (i == 5 ? 2 : i));
+        REQUIRE(std::all_of(page.begin() + 1, page.end(), [](u8 value) { return value == 0; }));
+    }
+    REQUIRE_THROWS(buffer.LoadPage(NumPages, page));
+}
+
+TEST_CASE("RewindBuffer drops the oldest snapshots over budget", "[core][rewind]") {
+    Core::RewindBuffer buffer{1};
+    std::vector<u8> memory(NumPages * Memory::CITRA_PAGE_SIZE);
+    for (u8 i = 1; i <= 4; i++) {
+        TakeSnapshot(buffer, memory, i);
+        REQUIRE(buffer.GetSnapshotCount() == 1);
+    }
+    REQUIRE(buffer.RestoreSnapshot(1) == std::vector<u8>{4});
+
+    buffer.Clear();
+    REQUIRE(buffer.GetSize() == 0);
+}
+
+TEST_CASE("RewindBuffer only copies the pages that changed", "[core][rewind]") {
+    Core::RewindBuffer buffer{16 * 1024 * 1024};
+    std::vector<u8> memory(NumPages * Memory::CITRA_PAGE_SIZE);
+    for (std::size_t page = 0; page < NumPages; page++) {
+        memory[page * Memory::CITRA_PAGE_SIZE] = static_cast<u8>(page);
+    }
+
+    // The copies of the first snapshot count toward the size until the next one needs less
+    TakeSnapshot(buffer, memory, 1);
+    const std::size_t first_size = buffer.GetSize();
+    REQUIRE(first_size >= NumPages * Memory::CITRA_PAGE_SIZE);
+    TakeSnapshot(buffer, memory, 2);
+    REQUIRE(buffer.GetSize() < first_size - (NumPages - 2) * Memory::CITRA_PAGE_SIZE);
+
+    // Snapshots taken after a restore still find their unchanged pages
+    REQUIRE(buffer.RestoreSnapshot(2) == std::vector<u8>{1});
+    memory[7 * Memory::CITRA_PAGE_SIZE + 1] = 0x77;
+    TakeSnapshot(buffer, memory, 3);
+    TakeSnapshot(buffer, memory, 4);
+
+    std::vector<u8> page(Memory::CITRA_PAGE_SIZE);
+    for (u8 value = 4; value >= 3; value--) {
+        REQUIRE(buffer.RestoreSnapshot(1) == std::vector<u8>{value});
+        for (std::size_t i = 0; i < NumPages; i++) {
+            buffer.LoadPage(i, page);
+            REQUIRE(page[0] == (i == 5 ? value : i));
+            REQUIRE(page[1] == (i == 7 ? 0x77 : 0));
+        }
+    }
+}
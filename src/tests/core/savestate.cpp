@@ -0,0 +1,146 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "common/archives.h"
+#include "common/file_util.h"
+#include "common/zstd_compression.h"
+#include "core/memory.h"
+
+namespace {
+
+std::vector<u8> RandomData(std::size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::vector<u8> data(size);
+    std::ranges::generate(data, [&] { return static_cast<u8>(distribution(rng)); });
+    return data;
+}
+
+/// Temporary file that is deleted when going out of scope
+struct TempFile {
+    explicit TempFile(const char* name)
+        : path{(std::filesystem::temp_directory_path() / name).string()} {}
+    ~TempFile() {
+        FileUtil::Delete(path);
+    }
+    std::string path;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("ZSTDInputBuffer reads back what ZSTDOutputBuffer wrote", "[core][savestate]") {
+    const u32 num_threads = GENERATE(0U, 2U);
+    const TempFile temp{"lemonade_zstd_stream_test"};
+    // Much larger than the stream buffers, compressible so that several blocks are written
+    std::vector<u8> data = RandomData(3 * 1024 * 1024, 1);
+    std::ranges::fill(data.begin() + 1024 * 1024, data.begin() + 2 * 1024 * 1024, u8{0x55});
+
+    {
+        FileUtil::IOFile file{temp.path, "wb"};
+        Common::Compression::ZSTDOutputBuffer buffer{file, num_threads};
+        std::ostream stream{&buffer};
+        // Small writes go through the stream buffer, large ones straight to the compressor
+        stream.write(reinterpret_cast<const char*>(data.data()), 100);
+        stream.put(static_cast<char>(data[100]));
+        stream.write(reinterpret_cast<const char*>(data.data() + 101),
+                     static_cast<std::streamsize>(data.size() - 101));
+        REQUIRE(stream);
+        REQUIRE(buffer.Finish());
+        REQUIRE(file.GetSize() < data.size());
+    }
+
+    FileUtil::IOFile file{temp.path, "rb"};
+    Common::Compression::ZSTDInputBuffer buffer{file};
+    std::istream stream{&buffer};
+    std::vector<u8> read(data.size());
+    stream.read(reinterpret_cast<char*>(read.data()), 7);
+    read[7] = static_cast<u8>(stream.get());
+    stream.read(reinterpret_cast<char*>(read.data() + 8),
+                static_cast<std::streamsize>(read.size() - 8));
+    REQUIRE(stream);
+    REQUIRE(read == data);
+    REQUIRE(stream.get() == std::istream::traits_type::eof());
+}
+
+TEST_CASE("ZSTDInputBuffer reads states compressed in a single call", "[core][savestate]") {
+    const TempFile temp{"lemonade_zstd_legacy_test"};
+    const std::vector<u8> data = RandomData(200 * 1024, 2);
+
+    {
+        const std::vector<u8> compressed = Common::Compression::CompressDataZSTDDefault(data);
+        FileUtil::IOFile file{temp.path, "wb"};
+        REQUIRE(file.WriteBytes(compressed.data(), compressed.size()) == compressed.size());
+    }
+
+    FileUtil::IOFile file{temp.path, "rb"};
+    Common::Compression::ZSTDInputBuffer buffer{file};
+    std::istream stream{&buffer};
+    std::vector<u8> read(data.size());
+    stream.read(reinterpret_cast<char*>(read.data()), static_cast<std::streamsize>(read.size()));
+    REQUIRE(stream);
+    REQUIRE(read == data);
+}
+
+TEST_CASE("Incremental savestates restore memory from their base", "[core][savestate]") {
+    constexpr std::size_t num_pages = 64;
+    const TempFile base_temp{"lemonade_savestate_base_test"};
+    const TempFile delta_temp{"lemonade_savestate_delta_test"};
+    std::vector<u8> memory = RandomData(num_pages * Memory::CITRA_PAGE_SIZE, 3);
+
+    // Full base state holding the memory as it is
+    std::vector<u64> base_hashes;
+    {
+        FileUtil::IOFile file{base_temp.path, "wb"};
+        Common::Compression::ZSTDOutputBuffer buffer{file, 0};
+        std::ostream stream{&buffer};
+        stream.write(reinterpret_cast<const char*>(memory.data()),
+                     static_cast<std::streamsize>(memory.size()));
+        base_hashes = Memory::HashSavestatePages(memory);
+        REQUIRE(buffer.Finish());
+    }
+
+    // A single byte in one page and the whole last page change afterwards
+    memory[3 * Memory::CITRA_PAGE_SIZE + 5] ^= 1;
+    const std::vector<u8> last_page = RandomData(Memory::CITRA_PAGE_SIZE, 4);
+    std::ranges::copy(last_page, memory.end() - Memory::CITRA_PAGE_SIZE);
+    {
+        FileUtil::IOFile file{delta_temp.path, "wb"};
+        Common::Compression::ZSTDOutputBuffer buffer{file, 0};
+        {
+            std::ostream stream{&buffer};
+            oarchive oa{stream};
+            Memory::SerializeChangedPages(oa, std::span{memory}, base_hashes, {});
+        }
+        REQUIRE(buffer.Finish());
+        // Random pages do not compress, only the two changed ones fit
+        REQUIRE(file.GetSize() < 3 * Memory::CITRA_PAGE_SIZE);
+    }
+
+    FileUtil::IOFile base_file{base_temp.path, "rb"};
+    Common::Compression::ZSTDInputBuffer base_buffer{base_file};
+    std::istream base_stream{&base_buffer};
+    const auto read_base = [&](std::span<u8> data) {
+        base_stream.read(reinterpret_cast<char*>(data.data()),
+                         static_cast<std::streamsize>(data.size()));
+        REQUIRE(base_stream);
+    };
+
+    FileUtil::IOFile delta_file{delta_temp.path, "rb"};
+    Common::Compression::ZSTDInputBuffer delta_buffer{delta_file};
+    std::istream delta_stream{&delta_buffer};
+    std::vector<u8> loaded(memory.size());
+    {
+        iarchive ia{delta_stream};
+        Memory::SerializeChangedPages(ia, std::span{loaded}, {}, read_base);
+    }
+    REQUIRE(loaded == memory);
+}
@@ -0,0 +1,99 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <string>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "enet/enet.h"
+#include "network/packet.h"
+
+namespace Network {
+
+TEST_CASE("Packet round trips fields", "[network]") {
+    const std::vector<u8> frame(3000, 0x5A);
+    const std::vector<std::string> names{"first", "", "third"};
+    const std::array<u8, 6> mac{0x00, 0x1F, 0x32, 0x01, 0x02, 0x03};
+
+    Packet packet;
+    packet << static_cast<u8>(5) << static_cast<u16>(0x1234) << static_cast<u32>(0xDEADBEEF)
+           << static_cast<u64>(0x0123456789ABCDEF) << std::string("nickname") << mac << frame
+           << names;
+
+    Packet copy = packet;
+    for (Packet* p : {&packet, &copy}) {
+        u8 type{};
+        u16 port{};
+        u32 version{};
+        u64 id{};
+        std::string nickname;
+        std::array<u8, 6> read_mac{};
+        std::vector<u8> read_frame;
+        std::vector<std::string> read_names;
+        *p >> type >> port >> version >> id >> nickname >> read_mac >> read_frame >> read_names;
+        REQUIRE(*p);
+        REQUIRE(p->EndOfPacket());
+        REQUIRE(type == 5);
+        REQUIRE(port == 0x1234);
+        REQUIRE(version == 0xDEADBEEF);
+        REQUIRE(id == 0x0123456789ABCDEF);
+        REQUIRE(nickname == "nickname");
+        REQUIRE(read_mac == mac);
+        REQUIRE(read_frame == frame);
+        REQUIRE(read_names == names);
+    }
+}
+
+TEST_CASE("Packet reads received data in place", "[network]") {
+    Packet source;
+    source << std::string("hello") << std::vector<u8>{1, 2, 3};
+    const std::vector<u8> received(static_cast<const u8*>(source.GetData()),
+                                   static_cast<const u8*>(source.GetData()) +
+                                       source.GetDataSize());
+
+    Packet packet(received.data(), received.size());
+    REQUIRE(packet.GetData() == received.data());
+
+    std::string text;
+    std::vector<u8> bytes;
+    packet >> text >> bytes;
+    REQUIRE(text == "hello");
+    REQUIRE(bytes == std::vector<u8>{1, 2, 3});
+
+    SECTION("appending copies the data") {
+        packet << static_cast<u8>(4);
+        REQUIRE(packet.GetData() != received.data());
+        REQUIRE(packet.GetDataSize() == received.size() + 1);
+        u8 value{};
+        packet >> value;
+        REQUIRE(value == 4);
+    }
+
+    SECTION("reading past the end invalidates the packet") {
+        std::vector<u8> too_long;
+        packet >> too_long;
+        REQUIRE_FALSE(packet);
+        REQUIRE(too_long.empty());
+    }
+}
+
+TEST_CASE("Packet hands its buffer to ENet", "[network]") {
+    Packet packet;
+    packet << std::vector<u8>(100, 0x11);
+    const void* data = packet.GetData();
+    const std::size_t size = packet.GetDataSize();
+
+    ENetPacket* enet_packet = CreateENetPacket(std::move(packet), ENET_PACKET_FLAG_RELIABLE);
+    REQUIRE(enet_packet->data == data);
+    REQUIRE(enet_packet->dataLength == size);
+    REQUIRE(packet.GetDataSize() == 0);
+    enet_packet_destroy(enet_packet);
+
+    // The buffer went back to the pool and is used by the next packet of the same size
+    Packet next;
+    next << std::vector<u8>(100, 0x22);
+    REQUIRE(next.GetData() == data);
+}
+
+} // namespace Network
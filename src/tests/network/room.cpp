@@ -0,0 +1,224 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+#include "enet/enet.h"
+#include "network/packet.h"
+#include "network/room.h"
+#include "network/verify_user.h"
+
+namespace Network {
+
+namespace {
+
+constexpr auto Timeout = std::chrono::seconds(10);
+
+/// Simulates many room members with raw ENet peers of a single host connected over loopback.
+class LoopbackClients {
+public:
+    LoopbackClients(u16 port, std::size_t count)
+        : host(enet_host_create(nullptr, count, NumChannels, 0, 0)), clients(count) {
+        ENetAddress address{};
+        enet_address_set_host(&address, "127.0.0.1");
+        address.port = port;
+        for (std::size_t i = 0; i < count; i++) {
+            clients[i].peer = enet_host_connect(host, &address, NumChannels, 0);
+            clients[i].peer->data = &clients[i];
+        }
+        Pump([this] { return connected == clients.size(); });
+    }
+
+    ~LoopbackClients() {
+        for (auto& client : clients) {
+            enet_peer_disconnect(client.peer, 0);
+        }
+        enet_host_flush(host);
+        enet_host_destroy(host);
+    }
+
+    /// Sends a join request from every client and waits until all of them are members.
+    bool Join() {
+        for (std::size_t i = 0; i < clients.size(); i++) {
+            Packet packet;
+            packet << static_cast<u8>(IdJoinRequest);
+            packet << fmt::format("client{:04}", i);
+            packet << fmt::format("console{:04}", i);
+            packet << NoPreferredMac;
+            packet << network_version;
+            packet << std::string{};
+            packet << std::string{};
+            Send(i, packet);
+        }
+        return Pump([this] { return joined == clients.size(); });
+    }
+
+    /// Sends a WifiPacket with a payload of the given size from a client.
+    void SendWifi(std::size_t index, const MacAddress& destination, std::size_t size) {
+        Packet packet;
+        packet << static_cast<u8>(IdWifiPacket);
+        packet << static_cast<u8>(1); // Data frame
+        packet << static_cast<u8>(1); // Channel
+        packet << clients[index].mac_address;
+        packet << destination;
+        packet << std::vector<u8>(size, static_cast<u8>(index));
+        Send(index, packet);
+    }
+
+    /// Services the host until the condition is met or the timeout expires.
+    bool Pump(const std::function<bool()>& condition) {
+        const auto deadline = std::chrono::steady_clock::now() + Timeout;
+        enet_host_flush(host);
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            ENetEvent event;
+            if (enet_host_service(host, &event, 1) > 0) {
+                HandleEvent(event);
+            }
+        }
+        return true;
+    }
+
+    const MacAddress& GetMacAddress(std::size_t index) const {
+        return clients[index].mac_address;
+    }
+
+    std::size_t GetWifiPacketsReceived(std::size_t index) const {
+        return clients[index].wifi_packets;
+    }
+
+    std::size_t GetTotalWifiPacketsReceived() const {
+        return total_wifi_packets;
+    }
+
+private:
+    struct Client {
+        ENetPeer* peer = nullptr;
+        MacAddress mac_address{};
+        std::size_t wifi_packets = 0;
+    };
+
+    void Send(std::size_t index, const Packet& packet) {
+        ENetPacket* enet_packet =
+            enet_packet_create(packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+        enet_peer_send(clients[index].peer, 0, enet_packet);
+    }
+
+    void HandleEvent(const ENetEvent& event) {
+        Client& client = *static_cast<Client*>(event.peer->data);
+        switch (event.type) {
+        case ENET_EVENT_TYPE_CONNECT:
+            connected++;
+            break;
+        case ENET_EVENT_TYPE_RECEIVE:
+            if (event.packet->data[0] == IdJoinSuccess) {
+                Packet packet;
+                packet.Append(event.packet->data, event.packet->dataLength);
+                packet.IgnoreBytes(sizeof(u8));
+                packet >> client.mac_address;
+                joined++;
+            } else if (event.packet->data[0] == IdWifiPacket) {
+                client.wifi_packets++;
+                total_wifi_packets++;
+            }
+            enet_packet_destroy(event.packet);
+            break;
+        case ENET_EVENT_TYPE_DISCONNECT:
+        case ENET_EVENT_TYPE_NONE:
+            break;
+        }
+    }
+
+    ENetHost* host;
+    std::vector<Client> clients;
+    std::size_t connected = 0;
+    std::size_t joined = 0;
+    std::size_t total_wifi_packets = 0;
+};
+
+/// Opens a room on a free port of the loopback interface for the duration of a test.
+class TestRoom {
+public:
+    explicit TestRoom(u32 max_members) {
+        REQUIRE(enet_initialize() == 0);
+        REQUIRE(room.Create("Test room", "", "127.0.0.1", 0, "", max_members, "", "", 0,
+                            std::make_unique<VerifyUser::NullBackend>()));
+        REQUIRE(GetPort() != 0);
+    }
+
+    ~TestRoom() {
+        room.Destroy();
+        enet_deinitialize();
+    }
+
+    u16 GetPort() const {
+        return room.GetRoomInformation().port;
+    }
+
+    Room room;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("Room relays WifiPackets", "[network]") {
+    constexpr std::size_t NumClients = 8;
+    TestRoom test_room(NumClients);
+    LoopbackClients clients(test_room.GetPort(), NumClients);
+    REQUIRE(clients.Join());
+    REQUIRE(test_room.room.GetRoomMemberList().size() == NumClients);
+
+    SECTION("broadcasts to everyone but the sender") {
+        clients.SendWifi(0, BroadcastMac, 64);
+        REQUIRE(
+            clients.Pump([&] { return clients.GetTotalWifiPacketsReceived() == NumClients - 1; }));
+        REQUIRE(clients.GetWifiPacketsReceived(0) == 0);
+        for (std::size_t i = 1; i < NumClients; i++) {
+            REQUIRE(clients.GetWifiPacketsReceived(i) == 1);
+        }
+    }
+
+    SECTION("sends to the destination only") {
+        clients.SendWifi(2, clients.GetMacAddress(5), 64);
+        // An unknown destination is dropped
+        clients.SendWifi(2, MacAddress{0x00, 0x1F, 0x32, 0xAA, 0xBB, 0xCC}, 64);
+        clients.SendWifi(3, clients.GetMacAddress(5), 64);
+        REQUIRE(clients.Pump([&] { return clients.GetWifiPacketsReceived(5) == 2; }));
+        REQUIRE(clients.GetTotalWifiPacketsReceived() == 2);
+    }
+}
+
+TEST_CASE("Room load test", "[.][benchmark][network]") {
+    constexpr std::size_t NumClients = MaxConcurrentConnections;
+    TestRoom test_room(MaxConcurrentConnections);
+    LoopbackClients clients(test_room.GetPort(), NumClients);
+    REQUIRE(clients.Join());
+
+    // Every member broadcasts a beacon sized frame, as in a local wireless session
+    BENCHMARK("Broadcast from every member") {
+        const std::size_t expected =
+            clients.GetTotalWifiPacketsReceived() + NumClients * (NumClients - 1);
+        for (std::size_t i = 0; i < NumClients; i++) {
+            clients.SendWifi(i, BroadcastMac, 200);
+        }
+        return clients.Pump([&] { return clients.GetTotalWifiPacketsReceived() == expected; });
+    };
+
+    BENCHMARK("Unicast from every member") {
+        const std::size_t expected = clients.GetTotalWifiPacketsReceived() + NumClients;
+        for (std::size_t i = 0; i < NumClients; i++) {
+            clients.SendWifi(i, clients.GetMacAddress((i + 1) % NumClients), 1000);
+        }
+        return clients.Pump([&] { return clients.GetTotalWifiPacketsReceived() == expected; });
+    };
+}
+
+} // namespace Network
@@ -0,0 +1,92 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "video_core/frame_hash_log.h"
+
+namespace VideoCore {
+
+namespace {
+
+/// Renders a frame whose screens depend on the frame number only
+std::pair<std::vector<u8>, std::vector<u8>> RenderFrame(std::size_t frame) {
+    std::vector<u8> top(400 * 240 * 4, static_cast<u8>(frame));
+    std::vector<u8> bottom(320 * 240 * 4, static_cast<u8>(frame * 3));
+    return {std::move(top), std::move(bottom)};
+}
+
+void Replay(FrameHashLog& log, std::size_t num_frames, std::size_t corrupted_frame = SIZE_MAX) {
+    for (std::size_t frame = 0; frame < num_frames; frame++) {
+        auto [top, bottom] = RenderFrame(frame);
+        if (frame == corrupted_frame) {
+            bottom[1234] ^= 1;
+        }
+        log.AddFrame(top, bottom);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("FrameHashLog serialization", "[video_core]") {
+    const std::vector<FrameHashLog::FrameHashes> frames{{1, 2}, {0xFFFFFFFFFFFFFFFF, 0}};
+    const auto parsed = FrameHashLog::Deserialize(FrameHashLog::Serialize(frames));
+    REQUIRE(parsed);
+    REQUIRE(*parsed == frames);
+
+    REQUIRE(FrameHashLog::Deserialize("0 1 2\r\n1 3 4\n")->size() == 2);
+    REQUIRE_FALSE(FrameHashLog::Deserialize("0 1\n"));
+    REQUIRE_FALSE(FrameHashLog::Deserialize("1 1 2\n"));
+    REQUIRE_FALSE(FrameHashLog::Deserialize("0 xyz 2\n"));
+}
+
+TEST_CASE("FrameHashLog replays", "[video_core]") {
+    const auto path =
+        (std::filesystem::temp_directory_path() / "lemonade_frame_hash_log_test.txt").string();
+    {
+        FrameHashLog log(path, FrameHashLog::Mode::Record);
+        Replay(log, 10);
+        REQUIRE(log.Finish());
+    }
+
+    SECTION("matching frames") {
+        FrameHashLog log(path, FrameHashLog::Mode::Verify);
+        REQUIRE(log.IsValid());
+        Replay(log, 10);
+        REQUIRE_FALSE(log.GetFirstDivergingFrame());
+        REQUIRE(log.Finish());
+    }
+
+    SECTION("shorter replay") {
+        FrameHashLog log(path, FrameHashLog::Mode::Verify);
+        Replay(log, 4);
+        REQUIRE(log.Finish());
+    }
+
+    SECTION("diverging frame") {
+        FrameHashLog log(path, FrameHashLog::Mode::Verify);
+        Replay(log, 10, 6);
+        REQUIRE(log.GetFirstDivergingFrame() == 6);
+        REQUIRE_FALSE(log.Finish());
+    }
+
+    SECTION("longer replay") {
+        FrameHashLog log(path, FrameHashLog::Mode::Verify);
+        Replay(log, 12);
+        REQUIRE(log.GetFirstDivergingFrame() == 10);
+    }
+
+    FileUtil::Delete(path);
+
+    SECTION("missing log") {
+        FrameHashLog log(path, FrameHashLog::Mode::Verify);
+        REQUIRE_FALSE(log.IsValid());
+        REQUIRE_FALSE(log.Finish());
+    }
+}
+
+} // namespace VideoCore
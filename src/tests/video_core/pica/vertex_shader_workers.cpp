@@ -0,0 +1,115 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/pica/regs_shader.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/vertex_shader_workers.h"
+#include "video_core/shader/shader.h"
+
+namespace Pica {
+
+namespace {
+
+/// Shader engine whose outputs depend on the registers left behind by previous invocations.
+class AccumulatingEngine final : public ShaderEngine {
+public:
+    void SetupBatch(ShaderSetup&, u32) override {}
+
+    void Run(const ShaderSetup&, ShaderUnit& state) const override {
+        auto& sum = state.temporary[0];
+        const auto& input = state.input[0];
+        sum = Common::MakeVec(sum.x + input.x, sum.y + input.y, sum.z + input.z, sum.w + input.w);
+        state.output[0] = sum;
+        state.output[1] = state.input[1];
+        state.output[1].w = f24::FromFloat32(static_cast<float>(state.address_registers[0]++));
+    }
+};
+
+ShaderRegs MakeConfig() {
+    ShaderRegs config;
+    std::memset(&config, 0, sizeof(config));
+    // Attributes 0 and 1 go to input registers 0 and 1, output registers 0 and 1 are read back
+    config.max_input_attribute_index.Assign(1);
+    config.input_attribute_to_register_map_low = 0x10;
+    config.output_mask.Assign(0b11);
+    return config;
+}
+
+void LoadVertex(u32 index, u32 vertex, AttributeBuffer& input) {
+    input[0] = Common::MakeVec(f24::FromFloat32(static_cast<float>(vertex)), f24::One(),
+                               f24::Zero(), f24::FromFloat32(0.5f));
+    input[1] = Common::MakeVec(f24::FromFloat32(static_cast<float>(index)), f24::Zero(),
+                               f24::FromFloat32(static_cast<float>(vertex % 7)), f24::Zero());
+}
+
+bool SameOutput(const AttributeBuffer& a, const AttributeBuffer& b) {
+    return std::memcmp(&a[0], &b[0], 2 * sizeof(a[0])) == 0;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("VertexShaderWorkers match shading the vertices one by one", "[video_core][pica]") {
+    const AccumulatingEngine engine;
+    ShaderSetup setup;
+    const ShaderRegs config = MakeConfig();
+
+    // Larger than the smallest draw that PicaCore splits across workers
+    std::vector<std::pair<u32, u32>> batch;
+    for (u32 index = 0; index < 1000; ++index) {
+        batch.emplace_back(index, (index * 37) % 251);
+    }
+
+    std::vector<AttributeBuffer> expected(batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        ShaderUnit unit;
+        AttributeBuffer input;
+        LoadVertex(batch[i].first, batch[i].second, input);
+        unit.LoadInput(config, input);
+        engine.Run(setup, unit);
+        unit.WriteOutput(config, expected[i]);
+    }
+
+    VertexShaderWorkers workers;
+    // The second draw reuses the shader units of the first one
+    for (int draw = 0; draw < 2; ++draw) {
+        std::vector<AttributeBuffer> outputs(batch.size());
+        workers.Run(engine, setup, config, batch, LoadVertex, outputs);
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            REQUIRE(SameOutput(outputs[i], expected[i]));
+        }
+    }
+}
+
+TEST_CASE("Shading vertices one by one matches VertexShaderWorkers", "[video_core][pica]") {
+    const AccumulatingEngine engine;
+    ShaderSetup setup;
+    const ShaderRegs config = MakeConfig();
+
+    std::vector<std::pair<u32, u32>> batch;
+    for (u32 index = 0; index < 500; ++index) {
+        batch.emplace_back(index, (index * 13) % 97);
+    }
+
+    // Small draws reuse a single shader unit for all of their vertices
+    ShaderUnit unit;
+    std::vector<AttributeBuffer> serial(batch.size());
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        AttributeBuffer input;
+        LoadVertex(batch[i].first, batch[i].second, input);
+        VertexShaderWorkers::RunSingle(engine, setup, config, unit, input, serial[i]);
+    }
+
+    VertexShaderWorkers workers;
+    std::vector<AttributeBuffer> parallel(batch.size());
+    workers.Run(engine, setup, config, batch, LoadVertex, parallel);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        REQUIRE(SameOutput(serial[i], parallel[i]));
+    }
+}
+
+} // namespace Pica
@@ -0,0 +1,167 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "video_core/rasterizer_cache/texture_codec.h"
+#include "video_core/rasterizer_cache/texture_codec_simd.h"
+#include "video_core/texture/etc1.h"
+
+using VideoCore::MortonFunc;
+using VideoCore::PixelFormat;
+
+namespace {
+
+constexpr u32 WIDTH = 64;
+constexpr u32 HEIGHT = 32;
+
+std::vector<u8> RandomBytes(std::size_t size) {
+    std::mt19937 rng{static_cast<u32>(size)};
+    std::uniform_int_distribution<u32> dist{0, 255};
+    std::vector<u8> bytes(size);
+    for (u8& byte : bytes) {
+        byte = static_cast<u8>(dist(rng));
+    }
+    return bytes;
+}
+
+u32 TiledSize(PixelFormat format) {
+    return WIDTH * HEIGHT * VideoCore::GetFormatBpp(format) / 8;
+}
+
+u32 LinearSize(PixelFormat format, bool converted) {
+    return WIDTH * HEIGHT * (converted ? 4 : VideoCore::GetFormatBytesPerPixel(format));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Unswizzle SIMD matches scalar", "[video_core][texture_codec]") {
+    const auto format = GENERATE(PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB5A1,
+                                 PixelFormat::RGB565, PixelFormat::RGBA4, PixelFormat::IA8,
+                                 PixelFormat::D16, PixelFormat::D24S8);
+    const bool converted = GENERATE(false, true);
+    const std::size_t index = static_cast<std::size_t>(format);
+
+    const MortonFunc simd = VideoCore::GetUnswizzleSIMD(format, converted);
+    if (!simd) {
+        SKIP("No vector kernel for this host or format");
+    }
+    const MortonFunc scalar =
+        (converted ? VideoCore::UNSWIZZLE_TABLE_CONVERTED : VideoCore::UNSWIZZLE_TABLE)[index];
+    REQUIRE(scalar);
+
+    std::vector<u8> tiled = RandomBytes(TiledSize(format));
+    std::vector<u8> expected(LinearSize(format, converted));
+    std::vector<u8> result(expected.size());
+    scalar(WIDTH, HEIGHT, 0, TiledSize(format), expected, tiled);
+    simd(WIDTH, HEIGHT, 0, TiledSize(format), result, tiled);
+    REQUIRE(expected == result);
+}
+
+TEST_CASE("Swizzle SIMD matches scalar", "[video_core][texture_codec]") {
+    const auto format = GENERATE(PixelFormat::RGBA8, PixelFormat::RGB8, PixelFormat::RGB5A1,
+                                 PixelFormat::RGB565, PixelFormat::RGBA4, PixelFormat::D16,
+                                 PixelFormat::D24S8);
+    const bool converted = GENERATE(false, true);
+    const std::size_t index = static_cast<std::size_t>(format);
+
+    // Downloads may start and end in the middle of a tile, cover that path as well.
+    const u32 tiled_size = TiledSize(format);
+    const u32 start_offset = GENERATE_COPY(0u, tiled_size / 3);
+    const u32 end_offset = GENERATE_COPY(tiled_size, tiled_size - tiled_size / 5);
+
+    const MortonFunc simd = VideoCore::GetSwizzleSIMD(format, converted);
+    if (!simd) {
+        SKIP("No vector kernel for this host or format");
+    }
+    const MortonFunc scalar =
+        (converted ? VideoCore::SWIZZLE_TABLE_CONVERTED : VideoCore::SWIZZLE_TABLE)[index];
+    REQUIRE(scalar);
+
+    std::vector<u8> linear = RandomBytes(LinearSize(format, converted));
+    std::vector<u8> expected(end_offset - start_offset);
+    std::vector<u8> result(expected.size());
+    scalar(WIDTH, HEIGHT, start_offset, end_offset, linear, expected);
+    simd(WIDTH, HEIGHT, start_offset, end_offset, linear, result);
+    REQUIRE(expected == result);
+}
+
+TEST_CASE("ETC1 block decode matches per texel sampling", "[video_core][texture_codec]") {
+    const auto format = GENERATE(PixelFormat::ETC1, PixelFormat::ETC1A4);
+    const bool has_alpha = format == PixelFormat::ETC1A4;
+    const u32 subtile_size = has_alpha ? 16 : 8;
+
+    // Repeat some of the tiles so the decoded subtile cache is exercised.
+    std::vector<u8> tiled = RandomBytes(TiledSize(format));
+    std::copy_n(tiled.begin(), tiled.size() / 4, tiled.begin() + tiled.size() / 2);
+
+    std::vector<u8> result(LinearSize(format, false));
+    VideoCore::UNSWIZZLE_TABLE[static_cast<std::size_t>(format)](WIDTH, HEIGHT, 0,
+                                                                 TiledSize(format), result, tiled);
+
+    for (u32 y = 0; y < HEIGHT; y++) {
+        for (u32 x = 0; x < WIDTH; x++) {
+            const u32 tile_index = (y / 8) * (WIDTH / 8) + x / 8;
+            const u32 subtile_index = (x % 8) / 4 + 2 * ((y % 8) / 4);
+            const u8* subtile = tiled.data() + (tile_index * 4 + subtile_index) * subtile_size;
+            const u32 texel_x = x % 4;
+            const u32 texel_y = y % 4;
+
+            u8 alpha = 255;
+            if (has_alpha) {
+                const u64 packed_alpha = VideoCore::MakeInt<u64>(subtile);
+                alpha = ((packed_alpha >> (4 * (texel_x * 4 + texel_y))) & 0xF) * 0x11;
+                subtile += sizeof(u64);
+            }
+            const auto rgb = Pica::Texture::SampleETC1Subtile(VideoCore::MakeInt<u64>(subtile),
+                                                              texel_x, texel_y);
+
+            // Tiles are stored bottom up in the linear buffer.
+            const u8* pixel = result.data() + ((HEIGHT - 1 - y) * WIDTH + x) * 4;
+            REQUIRE(pixel[0] == rgb.r());
+            REQUIRE(pixel[1] == rgb.g());
+            REQUIRE(pixel[2] == rgb.b());
+            REQUIRE(pixel[3] == alpha);
+        }
+    }
+}
+
+TEST_CASE("Texture codec benchmark", "[.][benchmark][video_core][texture_codec]") {
+    constexpr u32 width = 512;
+    constexpr u32 height = 512;
+    constexpr PixelFormat format = PixelFormat::RGBA8;
+    constexpr u32 size = width * height * 4;
+
+    std::vector<u8> tiled = RandomBytes(size);
+    std::vector<u8> linear(size);
+    const MortonFunc scalar_unswizzle = VideoCore::UNSWIZZLE_TABLE_CONVERTED[0];
+    const MortonFunc scalar_swizzle = VideoCore::SWIZZLE_TABLE_CONVERTED[0];
+    const MortonFunc simd_unswizzle = VideoCore::GetUnswizzleSIMD(format, true);
+    const MortonFunc simd_swizzle = VideoCore::GetSwizzleSIMD(format, true);
+
+    BENCHMARK("Unswizzle RGBA8 scalar") {
+        scalar_unswizzle(width, height, 0, size, linear, tiled);
+    };
+    BENCHMARK("Swizzle RGBA8 scalar") {
+        scalar_swizzle(width, height, 0, size, linear, tiled);
+    };
+    if (simd_unswizzle && simd_swizzle) {
+        BENCHMARK("Unswizzle RGBA8 SIMD") {
+            simd_unswizzle(width, height, 0, size, linear, tiled);
+        };
+        BENCHMARK("Swizzle RGBA8 SIMD") {
+            simd_swizzle(width, height, 0, size, linear, tiled);
+        };
+    }
+
+    const MortonFunc etc1_unswizzle =
+        VideoCore::UNSWIZZLE_TABLE[static_cast<std::size_t>(PixelFormat::ETC1)];
+    BENCHMARK("Unswizzle ETC1") {
+        etc1_unswizzle(width, height, 0, width * height / 2, linear, tiled);
+    };
+}
@@ -664,6 +664,45 @@ TEST_CASE("Nested Loop", "[video_core][shader][shader_jit]") {
     }
 }
 
+#if CITRA_ARCH(x86_64)
+TEST_CASE("Batch", "[video_core][shader][shader_jit]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader_test = ShaderTest({
+        // clang-format off
+        {OpCode::Id::MOV, sh_temp, sh_input},
+        {OpCode::Id::LOOP, 0},
+            {OpCode::Id::ADD, sh_temp, sh_temp, sh_input},
+        {Type::EndLoop},
+        {OpCode::Id::MOV, sh_output, sh_temp},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+    shader_test.shader_setup->uniforms.i[0] = {3, 0, 1, 0};
+
+    constexpr std::size_t batch_size = 8;
+    std::array<Pica::ShaderUnit, batch_size> batch_units;
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        const Pica::f24 input = Pica::f24::FromFloat32(static_cast<float>(i) - 2.0f);
+        batch_units[i].input[0] = Common::Vec4<Pica::f24>::AssignToAll(input);
+        batch_units[i].temporary.fill(Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::Zero()));
+    }
+    shader_test.shader_jit.RunBatch(*shader_test.shader_setup, batch_units, 0);
+
+    for (std::size_t i = 0; i < batch_size; ++i) {
+        Pica::ShaderUnit shader_unit;
+        shader_test.RunJit(shader_unit, static_cast<float>(i) - 2.0f);
+
+        REQUIRE(batch_units[i].address_registers[2] == shader_unit.address_registers[2]);
+        REQUIRE(batch_units[i].output[0].x.ToFloat32() == shader_unit.output[0].x.ToFloat32());
+        REQUIRE(batch_units[i].output[0].x.ToFloat32() ==
+                Catch::Approx((static_cast<float>(i) - 2.0f) * 5.0f));
+    }
+}
+#endif
+
 TEST_CASE("Source Swizzle", "[video_core][shader][shader_jit]") {
     const auto sh_input = SourceRegister::MakeInput(0);
     const auto sh_output = DestRegister::MakeOutput(0);
@@ -0,0 +1,126 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <string>
+#include <catch2/catch_test_macros.hpp>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+namespace Pica::Shader {
+
+namespace {
+
+constexpr u64 ProgramId = 0x0004000000123400;
+
+struct Program {
+    u64 key;
+    ProgramCode program_code;
+    SwizzleData swizzle_data;
+};
+
+Program MakeProgram(u32 seed) {
+    Program program{};
+    for (std::size_t i = 0; i < program.program_code.size(); i++) {
+        program.program_code[i] = static_cast<u32>(i * 0x9E3779B9u) ^ seed;
+    }
+    for (std::size_t i = 0; i < program.swizzle_data.size(); i++) {
+        program.swizzle_data[i] = static_cast<u32>(i) + seed;
+    }
+    program.key = Common::HashCombine(
+        Common::ComputeHash64(&program.program_code, sizeof(ProgramCode)),
+        Common::ComputeHash64(&program.swizzle_data, sizeof(SwizzleData)));
+    return program;
+}
+
+/// Points the shader directory to a temporary one for the duration of a test.
+class TemporaryShaderDir {
+public:
+    TemporaryShaderDir()
+        : previous{FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)},
+          path{std::filesystem::temp_directory_path() / "lemonade_shader_jit_disk_cache_test"} {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+        FileUtil::UpdateUserPath(FileUtil::UserPath::ShaderDir, path.string());
+    }
+
+    ~TemporaryShaderDir() {
+        // The previous path is only accepted back if it exists
+        if (FileUtil::IsDirectory(previous)) {
+            FileUtil::UpdateUserPath(FileUtil::UserPath::ShaderDir, previous);
+        }
+        std::filesystem::remove_all(path);
+    }
+
+    std::filesystem::path CacheFile() const {
+        return path / "jit" / "0004000000123400.bin";
+    }
+
+private:
+    std::string previous;
+    std::filesystem::path path;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("JitDiskCache persists the programs it is given", "[video_core][shader]") {
+    const TemporaryShaderDir shader_dir;
+    const Program first = MakeProgram(1);
+    const Program second = MakeProgram(2);
+
+    {
+        JitDiskCache cache{ProgramId};
+        REQUIRE(cache.Load().empty());
+        cache.Save(first.key, first.program_code, first.swizzle_data);
+        cache.Save(second.key, second.program_code, second.swizzle_data);
+    }
+
+    SECTION("loads them back in order") {
+        JitDiskCache cache{ProgramId};
+        const auto entries = cache.Load();
+        REQUIRE(entries.size() == 2);
+        REQUIRE(entries[0]->key == first.key);
+        REQUIRE(entries[0]->program_code == first.program_code);
+        REQUIRE(entries[0]->swizzle_data == first.swizzle_data);
+        REQUIRE(entries[1]->key == second.key);
+        REQUIRE(entries[1]->program_code == second.program_code);
+        REQUIRE(entries[1]->swizzle_data == second.swizzle_data);
+    }
+
+    SECTION("skips entries that do not match their key") {
+        {
+            JitDiskCache cache{ProgramId};
+            cache.Save(first.key + 1, first.program_code, first.swizzle_data);
+        }
+        JitDiskCache cache{ProgramId};
+        REQUIRE(cache.Load().size() == 2);
+    }
+
+    SECTION("keeps the entries before a truncated one") {
+        std::filesystem::resize_file(shader_dir.CacheFile(),
+                                     std::filesystem::file_size(shader_dir.CacheFile()) - 1);
+        {
+            JitDiskCache cache{ProgramId};
+            const auto entries = cache.Load();
+            REQUIRE(entries.size() == 1);
+            REQUIRE(entries[0]->key == first.key);
+        }
+        {
+            JitDiskCache cache{ProgramId};
+            const auto entries = cache.Load();
+            REQUIRE(entries.size() == 1);
+            REQUIRE(entries[0]->key == first.key);
+            // New entries follow the last good one
+            cache.Save(second.key, second.program_code, second.swizzle_data);
+        }
+        JitDiskCache cache{ProgramId};
+        const auto entries = cache.Load();
+        REQUIRE(entries.size() == 2);
+        REQUIRE(entries[1]->key == second.key);
+        REQUIRE(entries[1]->program_code == second.program_code);
+    }
+}
+
+} // namespace Pica::Shader
@@ -0,0 +1,146 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <charconv>
+#include <fmt/format.h>
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/frame_hash_log.h"
+
+namespace VideoCore {
+
+namespace {
+
+constexpr std::string_view Header = "# frame top_screen bottom_screen";
+
+std::optional<u64> ParseNumber(std::string_view& text, int base) {
+    while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+    }
+    u64 value{};
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+    if (error != std::errc{}) {
+        return std::nullopt;
+    }
+    text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+    return value;
+}
+
+} // Anonymous namespace
+
+FrameHashLog::FrameHashLog(std::string path_, Mode mode_) : path{std::move(path_)}, mode{mode_} {
+    if (mode != Mode::Verify) {
+        return;
+    }
+    std::string text;
+    if (FileUtil::ReadFileToString(true, path, text) == 0) {
+        LOG_ERROR(Render, "Could not read the frame hash log {}", path);
+        is_valid = false;
+        return;
+    }
+    auto parsed = Deserialize(text);
+    if (!parsed) {
+        LOG_ERROR(Render, "The frame hash log {} is malformed", path);
+        is_valid = false;
+        return;
+    }
+    expected_frames = std::move(*parsed);
+}
+
+FrameHashLog::~FrameHashLog() {
+    if (!finished) {
+        Finish();
+    }
+}
+
+bool FrameHashLog::AddFrame(std::span<const u8> top_screen, std::span<const u8> bottom_screen) {
+    return AddFrame({
+        .top = Common::ComputeHash64(top_screen.data(), top_screen.size()),
+        .bottom = Common::ComputeHash64(bottom_screen.data(), bottom_screen.size()),
+    });
+}
+
+bool FrameHashLog::AddFrame(const FrameHashes& hashes) {
+    const std::size_t frame = frames.size();
+    frames.push_back(hashes);
+    if (mode != Mode::Verify || first_diverging_frame) {
+        return !first_diverging_frame;
+    }
+    if (frame >= expected_frames.size() || expected_frames[frame] != hashes) {
+        first_diverging_frame = frame;
+        if (frame < expected_frames.size()) {
+            LOG_ERROR(Render,
+                      "Frame {} diverged: expected {:016x} {:016x}, rendered {:016x} {:016x}",
+                      frame, expected_frames[frame].top, expected_frames[frame].bottom,
+                      hashes.top, hashes.bottom);
+        } else {
+            LOG_ERROR(Render, "Frame {} is past the {} frames of the frame hash log", frame,
+                      expected_frames.size());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool FrameHashLog::Finish() {
+    finished = true;
+    if (mode == Mode::Record) {
+        const std::string text = Serialize(frames);
+        if (FileUtil::WriteStringToFile(true, path, text) != text.size()) {
+            LOG_ERROR(Render, "Could not write the frame hash log {}", path);
+            return false;
+        }
+        LOG_INFO(Render, "Wrote the hashes of {} frames to {}", frames.size(), path);
+        return true;
+    }
+
+    if (!is_valid) {
+        return false;
+    }
+    if (first_diverging_frame) {
+        LOG_ERROR(Render, "Rendering diverged from {} at frame {}", path, *first_diverging_frame);
+        return false;
+    }
+    LOG_INFO(Render, "The {} rendered frames match {}", frames.size(), path);
+    return true;
+}
+
+std::string FrameHashLog::Serialize(std::span<const FrameHashes> frames) {
+    std::string text{Header};
+    text += '\n';
+    for (std::size_t frame = 0; frame < frames.size(); frame++) {
+        text += fmt::format("{} {:016x} {:016x}\n", frame, frames[frame].top,
+                            frames[frame].bottom);
+    }
+    return text;
+}
+
+std::optional<std::vector<FrameHashLog::FrameHashes>> FrameHashLog::Deserialize(
+    std::string_view text) {
+    std::vector<FrameHashes> frames;
+    while (!text.empty()) {
+        const std::size_t line_end = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, line_end);
+        text.remove_prefix(std::min(line_end + 1, text.size()));
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        const auto frame = ParseNumber(line, 10);
+        const auto top = ParseNumber(line, 16);
+        const auto bottom = ParseNumber(line, 16);
+        if (!frame || !top || !bottom || *frame != frames.size()) {
+            return std::nullopt;
+        }
+        frames.push_back({.top = *top, .bottom = *bottom});
+    }
+    return frames;
+}
+
+} // namespace VideoCore
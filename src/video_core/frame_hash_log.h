@@ -0,0 +1,92 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+namespace VideoCore {
+
+/**
+ * Log of the hashes of every presented frame, used to check that a deterministic replay renders
+ * the same frames across builds. The log is a text file with one line per frame, holding the
+ * frame number and the CityHash of the top and bottom screens.
+ */
+class FrameHashLog {
+public:
+    enum class Mode {
+        Record, ///< Hashes are written to the log file
+        Verify, ///< Hashes are compared with the ones of the log file
+    };
+
+    struct FrameHashes {
+        u64 top;
+        u64 bottom;
+
+        bool operator==(const FrameHashes&) const = default;
+    };
+
+    /**
+     * Opens a log for recording or verifying.
+     * In Verify mode the expected hashes are loaded from the file right away, see IsValid.
+     */
+    explicit FrameHashLog(std::string path, Mode mode);
+    ~FrameHashLog();
+
+    /// Returns false if the expected hashes could not be loaded in Verify mode.
+    [[nodiscard]] bool IsValid() const {
+        return is_valid;
+    }
+
+    [[nodiscard]] Mode GetMode() const {
+        return mode;
+    }
+
+    /**
+     * Hashes the screens of the next presented frame.
+     * @return false if the frame does not match the expected one in Verify mode
+     */
+    bool AddFrame(std::span<const u8> top_screen, std::span<const u8> bottom_screen);
+
+    /// Adds the hashes of the next presented frame.
+    bool AddFrame(const FrameHashes& hashes);
+
+    /// Returns the number of frames added so far.
+    [[nodiscard]] std::size_t GetFrameCount() const {
+        return frames.size();
+    }
+
+    /// Returns the first frame that did not match the expected hashes in Verify mode, if any.
+    [[nodiscard]] std::optional<std::size_t> GetFirstDivergingFrame() const {
+        return first_diverging_frame;
+    }
+
+    /**
+     * Ends the log. In Record mode the hashes are written to the file, in Verify mode the
+     * comparison is logged.
+     * @return false if the file could not be written or if the frames diverged
+     */
+    bool Finish();
+
+    /// Formats the hashes of frames as the contents of a log file.
+    static std::string Serialize(std::span<const FrameHashes> frames);
+
+    /// Parses the contents of a log file, nullopt if they are malformed.
+    static std::optional<std::vector<FrameHashes>> Deserialize(std::string_view text);
+
+private:
+    std::string path;
+    Mode mode;
+    bool is_valid = true;
+    bool finished = false;
+    std::vector<FrameHashes> frames;
+    std::vector<FrameHashes> expected_frames;
+    std::optional<std::size_t> first_diverging_frame;
+};
+
+} // namespace VideoCore
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "common/arch.h"
 #include "common/archives.h"
 #include "common/microprofile.h"
@@ -19,6 +21,9 @@ namespace Pica {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+// Minimum amount of vertex shader invocations in a draw for it to be split across workers.
+constexpr u32 MIN_PARALLEL_VERTICES = 192;
+
 using namespace DebugUtils;
 
 union CommandHeader {
@@ -561,6 +566,18 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
+    // Large batches are shaded by the worker pool. Geometry shaders that consume raw indices and
+    // vertex shader breakpoints require the vertices to be processed one by one.
+    const bool vertex_breakpoint =
+        debug_context &&
+        debug_context->breakpoints[static_cast<int>(DebugContext::Event::VertexShaderInvocation)]
+            .enabled;
+    if (pipeline.num_vertices >= MIN_PARALLEL_VERTICES && !geometry_pipeline.NeedIndexInput() &&
+        !vertex_breakpoint) {
+        LoadVerticesParallel(loader, base_address, is_indexed);
+        return;
+    }
+
     for (u32 index = 0; index < pipeline.num_vertices; ++index) {
         // Indexed rendering doesn't use the start offset
         const u32 vertex = is_indexed
@@ -595,9 +612,8 @@ void PicaCore::LoadVertices(bool is_indexed) {
             }
 
             // Invoke the vertex shader for this vertex.
-            shader_unit.LoadInput(regs.internal.vs, input);
-            shader_engine->Run(vs_setup, shader_unit);
-            shader_unit.WriteOutput(regs.internal.vs, vs_output);
+            VertexShaderWorkers::RunSingle(*shader_engine, vs_setup, regs.internal.vs, shader_unit,
+                                           input, vs_output);
 
             // Cache the vertex when doing indexed rendering.
             if (is_indexed) {
@@ -613,6 +629,72 @@ void PicaCore::LoadVertices(bool is_indexed) {
     }
 }
 
+void PicaCore::LoadVerticesParallel(const VertexLoader& loader, PAddr base_address,
+                                    bool is_indexed) {
+    const auto& pipeline = regs.internal.pipeline;
+    const u32 num_vertices = pipeline.num_vertices;
+
+    const auto& index_info = pipeline.index_array;
+    const u8* index_address_8 = memory.GetPhysicalPointer(base_address + index_info.offset);
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+    const bool index_u16 = index_info.format != 0;
+
+    // Replay the circular vertex cache of the serial path to find out which vertices actually
+    // need to be shaded. Each submitted vertex is mapped to a slot in the batch output.
+    constexpr std::size_t VERTEX_CACHE_SIZE = 64;
+    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
+    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
+    std::array<u32, VERTEX_CACHE_SIZE> vertex_cache_slots;
+    u32 vertex_cache_pos = 0;
+
+    vs_batch.clear();
+    vs_batch_slots.resize(num_vertices);
+    for (u32 index = 0; index < num_vertices; ++index) {
+        const u32 vertex = is_indexed
+                               ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                               : (index + pipeline.vertex_offset);
+
+        bool vertex_cache_hit = false;
+        if (is_indexed) {
+            for (u32 i = 0; i < VERTEX_CACHE_SIZE; ++i) {
+                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
+                    vs_batch_slots[index] = vertex_cache_slots[i];
+                    vertex_cache_hit = true;
+                    break;
+                }
+            }
+        }
+        if (vertex_cache_hit) {
+            continue;
+        }
+
+        const u32 slot = static_cast<u32>(vs_batch.size());
+        vs_batch.emplace_back(index, vertex);
+        vs_batch_slots[index] = slot;
+
+        if (is_indexed) {
+            vertex_cache_slots[vertex_cache_pos] = slot;
+            vertex_cache_valid[vertex_cache_pos] = true;
+            vertex_cache_ids[vertex_cache_pos] = static_cast<u16>(vertex);
+            vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+        }
+    }
+
+    // Shade the batch.
+    vs_batch_outputs.resize(vs_batch.size());
+    vs_workers.Run(
+        *shader_engine, vs_setup, regs.internal.vs, vs_batch,
+        [&](u32 index, u32 vertex, AttributeBuffer& input) {
+            loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
+        },
+        vs_batch_outputs);
+
+    // Send to geometry pipeline in submission order.
+    for (u32 index = 0; index < num_vertices; ++index) {
+        geometry_pipeline.SubmitVertex(vs_batch_outputs[vs_batch_slots[index]]);
+    }
+}
+
 template <class Archive>
 void PicaCore::CommandList::serialize(Archive& ar, const u32 file_version) {
     ar& addr;
@@ -13,6 +13,7 @@
 #include "video_core/pica/regs_lcd.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
+#include "video_core/pica/vertex_shader_workers.h"
 
 namespace Memory {
 class MemorySystem;
@@ -26,6 +27,7 @@ namespace Pica {
 
 class DebugContext;
 class ShaderEngine;
+class VertexLoader;
 
 class PicaCore {
 public:
@@ -51,6 +53,8 @@ private:
 
     void LoadVertices(bool is_indexed);
 
+    void LoadVerticesParallel(const VertexLoader& loader, PAddr base_address, bool is_indexed);
+
 public:
     union Regs {
         static constexpr std::size_t NUM_REGS = 0x732;
@@ -280,6 +284,10 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+    VertexShaderWorkers vs_workers;
+    std::vector<std::pair<u32, u32>> vs_batch;
+    std::vector<u32> vs_batch_slots;
+    std::vector<AttributeBuffer> vs_batch_outputs;
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include "common/assert.h"
 #include "common/bit_set.h"
 #include "video_core/pica/regs_shader.h"
@@ -10,12 +11,21 @@
 namespace Pica {
 
 ShaderUnit::ShaderUnit(GeometryEmitter* emitter) : emitter_ptr{emitter} {
-    const Common::Vec4<f24> temp_vec{f24::Zero(), f24::Zero(), f24::Zero(), f24::One()};
-    temporary.fill(temp_vec);
+    Reset();
 }
 
 ShaderUnit::~ShaderUnit() = default;
 
+void ShaderUnit::Reset() {
+    const auto zero_vec = Common::Vec4<f24>::AssignToAll(f24::Zero());
+    const Common::Vec4<f24> temp_vec{f24::Zero(), f24::Zero(), f24::Zero(), f24::One()};
+    std::fill(std::begin(address_registers), std::end(address_registers), 0);
+    std::fill(std::begin(conditional_code), std::end(conditional_code), false);
+    input.fill(zero_vec);
+    temporary.fill(temp_vec);
+    output.fill(zero_vec);
+}
+
 void ShaderUnit::LoadInput(const ShaderRegs& config, const AttributeBuffer& buffer) {
     const u32 max_attribute = config.max_input_attribute_index;
     for (u32 attr = 0; attr <= max_attribute; ++attr) {
@@ -29,6 +29,9 @@ struct ShaderUnit {
     explicit ShaderUnit(GeometryEmitter* emitter = nullptr);
     ~ShaderUnit();
 
+    /// Returns the unit to its initial state, dropping what a previous invocation left behind.
+    void Reset();
+
     void LoadInput(const ShaderRegs& config, const AttributeBuffer& input);
 
     void WriteOutput(const ShaderRegs& config, AttributeBuffer& output);
@@ -0,0 +1,78 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <thread>
+#include "common/assert.h"
+#include "video_core/pica/vertex_shader_workers.h"
+#include "video_core/shader/shader.h"
+
+namespace Pica {
+
+// Minimum amount of vertex shader invocations handed to each worker.
+constexpr std::size_t MIN_VERTICES_PER_JOB = 64;
+
+static std::size_t GetNumVertexWorkers() {
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 2, 8);
+}
+
+VertexShaderWorkers::VertexShaderWorkers() = default;
+
+VertexShaderWorkers::~VertexShaderWorkers() = default;
+
+void VertexShaderWorkers::Run(const ShaderEngine& engine, const ShaderSetup& setup,
+                              const ShaderRegs& config, std::span<const std::pair<u32, u32>> batch,
+                              const LoadVertexFunc& load_vertex,
+                              std::span<AttributeBuffer> outputs) {
+    ASSERT(outputs.size() == batch.size());
+    if (!workers) {
+        workers = std::make_unique<Common::StatefulThreadWorker<ShaderUnits>>(
+            GetNumVertexWorkers(), "VertexShader workers", [](std::size_t) {
+                ShaderUnits shader_units;
+                return shader_units;
+            });
+    }
+
+    // The shader setup is shared read-only while each worker owns its units.
+    const std::size_t batch_size = batch.size();
+    const std::size_t max_jobs = (batch_size + MIN_VERTICES_PER_JOB - 1) / MIN_VERTICES_PER_JOB;
+    const std::size_t num_jobs = std::min(workers->NumWorkers(), max_jobs);
+    if (num_jobs == 0) {
+        return;
+    }
+    const std::size_t job_size = (batch_size + num_jobs - 1) / num_jobs;
+
+    for (std::size_t begin = 0; begin < batch_size; begin += job_size) {
+        const std::size_t end = std::min(begin + job_size, batch_size);
+        workers->QueueWork([&, begin, end](ShaderUnits* shader_units) {
+            for (std::size_t first = begin; first < end; first += UnitsPerRun) {
+                const std::size_t count = std::min(UnitsPerRun, end - first);
+                for (std::size_t i = 0; i < count; ++i) {
+                    const auto [index, vertex] = batch[first + i];
+                    AttributeBuffer input;
+                    load_vertex(index, vertex, input);
+                    (*shader_units)[i].Reset();
+                    (*shader_units)[i].LoadInput(config, input);
+                }
+                const std::span units{shader_units->data(), count};
+                engine.RunBatch(setup, units);
+                for (std::size_t i = 0; i < count; ++i) {
+                    units[i].WriteOutput(config, outputs[first + i]);
+                }
+            }
+        });
+    }
+    workers->WaitForRequests();
+}
+
+void VertexShaderWorkers::RunSingle(const ShaderEngine& engine, const ShaderSetup& setup,
+                                    const ShaderRegs& config, ShaderUnit& unit,
+                                    const AttributeBuffer& input, AttributeBuffer& output) {
+    unit.Reset();
+    unit.LoadInput(config, input);
+    engine.Run(setup, unit);
+    unit.WriteOutput(config, output);
+}
+
+} // namespace Pica
@@ -0,0 +1,58 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+#include "common/thread_worker.h"
+#include "video_core/pica/shader_unit.h"
+
+namespace Pica {
+
+struct ShaderRegs;
+struct ShaderSetup;
+class ShaderEngine;
+
+/**
+ * Shades large batches of vertices with the software vertex shader on a pool of worker threads.
+ * The pool is started by the first batch, so games drawn with hardware shaders never create it.
+ */
+class VertexShaderWorkers {
+public:
+    /// Loads the attributes of a vertex, given its position in the draw and its vertex index.
+    using LoadVertexFunc = std::function<void(u32 index, u32 vertex, AttributeBuffer& input)>;
+
+    VertexShaderWorkers();
+    ~VertexShaderWorkers();
+
+    /**
+     * Shades every vertex of the batch, given as pairs of position in the draw and vertex index,
+     * into the output at the same position. Each vertex starts from a reset shader unit, so the
+     * outputs do not depend on how the batch is split between the workers.
+     */
+    void Run(const ShaderEngine& engine, const ShaderSetup& setup, const ShaderRegs& config,
+             std::span<const std::pair<u32, u32>> batch, const LoadVertexFunc& load_vertex,
+             std::span<AttributeBuffer> outputs);
+
+    /**
+     * Shades a single vertex on the calling thread. The unit is reset first, like the ones of the
+     * workers, so that draws shaded one by one give the same outputs as batches.
+     */
+    static void RunSingle(const ShaderEngine& engine, const ShaderSetup& setup,
+                          const ShaderRegs& config, ShaderUnit& unit, const AttributeBuffer& input,
+                          AttributeBuffer& output);
+
+private:
+    /// Amount of shader units handed to the shader engine at once.
+    static constexpr std::size_t UnitsPerRun = 8;
+    using ShaderUnits = std::array<ShaderUnit, UnitsPerRun>;
+
+    std::unique_ptr<Common::StatefulThreadWorker<ShaderUnits>> workers;
+};
+
+} // namespace Pica
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <type_traits>
 #include <boost/container/small_vector.hpp>
 #include <boost/range/iterator_range.hpp>
@@ -1017,9 +1018,10 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
     }
 
     const auto upload_data = source_ptr.GetWriteBytes(load_info.end - load_info.addr);
-    DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, staging.mapped,
-                  runtime.NeedsConversion(surface.pixel_format));
+    QueueDecodeTexture(decode_workers, load_info, load_info.addr, load_info.end, upload_data,
+                       staging.mapped, runtime.NeedsConversion(surface.pixel_format));
 
+    // Hash and dump the guest data while the workers decode it into the staging buffer.
     const bool should_dump = False(surface.flags & SurfaceFlagBits::Custom) &&
                              False(surface.flags & SurfaceFlagBits::RenderTarget);
     if (dump_textures && should_dump) {
@@ -1027,6 +1029,9 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
         const u32 level = surface.LevelOf(load_info.addr);
         custom_tex_manager.DumpTexture(load_info, level, upload_data, hash);
     }
+    if (decode_workers) {
+        decode_workers->WaitForRequests();
+    }
 
     const BufferTextureCopy upload = {
         .buffer_offset = staging.offset,
@@ -1039,16 +1044,71 @@ void RasterizerCache<T>::UploadSurface(Surface& surface, SurfaceInterval interva
 
 template <class T>
 u64 RasterizerCache<T>::ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data) {
-    if (!custom_tex_manager.UseNewHash()) {
+    // Custom texture packs are keyed on the hash of the whole region, so it cannot be assembled
+    // from per page hashes. Instead remember the hash of each region and reuse it for as long
+    // as the cached pages it spans report no writes.
+    static constexpr std::size_t MAX_HASH_CACHE_ENTRIES = 4096;
+
+    const bool use_new_hash = custom_tex_manager.UseNewHash();
+    const std::array<u32, 6> key_data = {
+        load_info.addr,
+        load_info.end,
+        load_info.width,
+        load_info.height,
+        static_cast<u32>(load_info.pixel_format),
+        static_cast<u32>(load_info.is_tiled) | (static_cast<u32>(use_new_hash) << 1),
+    };
+    const u64 key = Common::ComputeHash64(key_data.data(), sizeof(key_data));
+    const u32 size = load_info.end - load_info.addr;
+
+    const auto it = hash_cache.find(key);
+    if (it != hash_cache.end() && it->second.addr == load_info.addr &&
+        it->second.end == load_info.end && !WasWrittenSince(load_info.addr, size, it->second.epoch)) {
+        return it->second.hash;
+    }
+
+    u64 hash;
+    if (!use_new_hash) {
         const u32 width = load_info.width;
         const u32 height = load_info.height;
         const u32 bpp = GetFormatBytesPerPixel(load_info.pixel_format);
         auto decoded = std::vector<u8>(width * height * bpp);
         DecodeTexture(load_info, load_info.addr, load_info.end, upload_data, decoded, false);
-        return Common::ComputeHash64(decoded.data(), decoded.size());
+        hash = Common::ComputeHash64(decoded.data(), decoded.size());
     } else {
-        return Common::ComputeHash64(upload_data.data(), upload_data.size());
+        hash = Common::ComputeHash64(upload_data.data(), upload_data.size());
+    }
+
+    if (hash_cache.size() >= MAX_HASH_CACHE_ENTRIES) {
+        hash_cache.clear();
+        page_write_epochs.clear();
+    }
+    hash_cache.insert_or_assign(key, HashEntry{load_info.addr, load_info.end, write_epoch, hash});
+    return hash;
+}
+
+template <class T>
+void RasterizerCache<T>::MarkPagesWritten(PAddr addr, u32 size) {
+    if (hash_cache.empty()) {
+        return;
+    }
+    write_epoch++;
+    const u32 page_end = (addr + size - 1) >> Memory::CITRA_PAGE_BITS;
+    for (u32 page = addr >> Memory::CITRA_PAGE_BITS; page <= page_end; page++) {
+        page_write_epochs.insert_or_assign(page, write_epoch);
+    }
+}
+
+template <class T>
+bool RasterizerCache<T>::WasWrittenSince(PAddr addr, u32 size, u64 epoch) const {
+    const u32 page_end = (addr + size - 1) >> Memory::CITRA_PAGE_BITS;
+    for (u32 page = addr >> Memory::CITRA_PAGE_BITS; page <= page_end; page++) {
+        const auto it = page_write_epochs.find(page);
+        if (it != page_write_epochs.end() && it->second > epoch) {
+            return true;
+        }
     }
+    return false;
 }
 
 template <class T>
@@ -1225,6 +1285,8 @@ void RasterizerCache<T>::ClearAll(bool flush) {
     cached_pages -= flush_interval;
     dirty_regions.clear();
     page_table.clear();
+    hash_cache.clear();
+    page_write_epochs.clear();
 }
 
 template <class T>
@@ -1286,6 +1348,7 @@ void RasterizerCache<T>::InvalidateRegion(PAddr addr, u32 size, SurfaceId region
     }
 
     const SurfaceInterval invalid_interval(addr, addr + size);
+    MarkPagesWritten(addr, size);
 
     if (region_owner_id) {
         Surface& region_owner = slot_surfaces[region_owner_id];
@@ -1430,7 +1493,9 @@ void RasterizerCache<T>::UpdatePagesCachedCount(PAddr addr, u32 size, int delta)
         if (delta > 0 && count == delta) {
             memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
         } else if (delta < 0 && count == -delta) {
+            // Writes to uncached pages are not reported, so hashes over them can't be trusted.
             memory.RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
+            MarkPagesWritten(interval_start_addr, interval_size);
         } else {
             ASSERT(count >= 0);
         }
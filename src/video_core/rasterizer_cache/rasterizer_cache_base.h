@@ -6,6 +6,7 @@
 
 #include <functional>
 #include <list>
+#include <memory>
 #include <optional>
 #include <span>
 #include <unordered_map>
@@ -13,6 +14,8 @@
 #include <boost/icl/interval_map.hpp>
 #include <tsl/robin_map.h>
 
+#include "common/thread_worker.h"
+
 #include "video_core/rasterizer_cache/framebuffer_base.h"
 #include "video_core/rasterizer_cache/sampler_params.h"
 #include "video_core/rasterizer_cache/surface_params.h"
@@ -75,6 +78,14 @@ class RasterizerCache {
     using SurfaceRect_Tuple = std::pair<SurfaceId, Common::Rectangle<u32>>;
     using PageMap = boost::icl::interval_map<u32, int>;
 
+    /// Hash of a texture region, valid as long as none of its pages are written after epoch.
+    struct HashEntry {
+        PAddr addr;
+        PAddr end;
+        u64 epoch;
+        u64 hash;
+    };
+
 public:
     explicit RasterizerCache(Memory::MemorySystem& memory, CustomTexManager& custom_tex_manager,
                              Runtime& runtime, Pica::RegsInternal& regs, RendererBase& renderer);
@@ -174,6 +185,12 @@ private:
     /// Computes the hash of the provided texture data.
     u64 ComputeHash(const SurfaceParams& load_info, std::span<u8> upload_data);
 
+    /// Records that the guest memory pages in the region may have changed.
+    void MarkPagesWritten(PAddr addr, u32 size);
+
+    /// Returns true if any guest memory page in the region changed after the provided epoch.
+    bool WasWrittenSince(PAddr addr, u32 size, u64 epoch) const;
+
     /// Update surface's texture for given region when necessary
     void ValidateSurface(SurfaceId surface, PAddr addr, u32 size);
 
@@ -214,6 +231,7 @@ private:
     Runtime& runtime;
     Pica::RegsInternal& regs;
     RendererBase& renderer;
+    std::unique_ptr<Common::ThreadWorker> decode_workers;
     std::unordered_map<TextureCubeConfig, TextureCube> texture_cube_cache;
     tsl::robin_pg_map<u64, std::vector<SurfaceId>, Common::IdentityHash<u64>> page_table;
     std::unordered_map<FramebufferParams, FramebufferId> framebuffers;
@@ -224,6 +242,9 @@ private:
     Common::SlotVector<Framebuffer> slot_framebuffers;
     SurfaceMap dirty_regions;
     PageMap cached_pages;
+    tsl::robin_map<u64, HashEntry, Common::IdentityHash<u64>> hash_cache;
+    tsl::robin_map<u32, u64, Common::IdentityHash<u32>> page_write_epochs;
+    u64 write_epoch{};
     u32 resolution_scale_factor;
     u64 frame_tick{};
     FramebufferParams fb_params;
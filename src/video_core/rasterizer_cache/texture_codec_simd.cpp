@@ -0,0 +1,445 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include "common/arch.h"
+#include "video_core/rasterizer_cache/texture_codec_simd.h"
+
+#if CITRA_ARCH(x86_64)
+#include <tmmintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+namespace VideoCore {
+
+#if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
+
+namespace {
+
+// The kernels below are written against a handful of 128-bit operations so the same
+// format code serves both SSSE3 and NEON. A vector holds four 32-bit lanes.
+#if CITRA_ARCH(x86_64)
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET __attribute__((target("ssse3")))
+#else
+#define SIMD_TARGET
+#endif
+
+using Vec = __m128i;
+
+SIMD_TARGET inline Vec Load(const u8* src) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+}
+
+SIMD_TARGET inline Vec Load64(const u8* src) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src));
+}
+
+SIMD_TARGET inline void Store(u8* dest, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), v);
+}
+
+SIMD_TARGET inline void StoreLow64(u8* dest, Vec v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), v);
+}
+
+SIMD_TARGET inline void StoreHigh64(u8* dest, Vec v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), _mm_unpackhi_epi64(v, v));
+}
+
+/// Returns the low halves of a and b concatenated.
+SIMD_TARGET inline Vec CombineLow(Vec a, Vec b) {
+    return _mm_unpacklo_epi64(a, b);
+}
+
+/// Returns the high halves of a and b concatenated.
+SIMD_TARGET inline Vec CombineHigh(Vec a, Vec b) {
+    return _mm_unpackhi_epi64(a, b);
+}
+
+SIMD_TARGET inline Vec Splat(u32 value) {
+    return _mm_set1_epi32(static_cast<s32>(value));
+}
+
+template <int shift>
+SIMD_TARGET inline Vec ShiftLeft(Vec v) {
+    return _mm_slli_epi32(v, shift);
+}
+
+template <int shift>
+SIMD_TARGET inline Vec ShiftRight(Vec v) {
+    return _mm_srli_epi32(v, shift);
+}
+
+SIMD_TARGET inline Vec And(Vec a, Vec b) {
+    return _mm_and_si128(a, b);
+}
+
+SIMD_TARGET inline Vec Or(Vec a, Vec b) {
+    return _mm_or_si128(a, b);
+}
+
+SIMD_TARGET inline Vec Negate(Vec v) {
+    return _mm_sub_epi32(_mm_setzero_si128(), v);
+}
+
+/// Gathers bytes of v by index, indices with the top bit set produce zero.
+SIMD_TARGET inline Vec ShuffleBytes(Vec v, const std::array<u8, 16>& indices) {
+    return _mm_shuffle_epi8(v, Load(indices.data()));
+}
+
+/// Zero extends the four low 16-bit lanes to 32 bits.
+SIMD_TARGET inline Vec Widen16(Vec v) {
+    return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+}
+
+/// Truncates the four 32-bit lanes to 16 bits, packed into the low half.
+SIMD_TARGET inline Vec Narrow16(Vec v) {
+    constexpr std::array<u8, 16> indices = {0,    1,    4,    5,    8,    9,    12,   13,
+                                            0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
+    return ShuffleBytes(v, indices);
+}
+
+/// Swaps the two middle 32-bit lanes.
+SIMD_TARGET inline Vec SwapMiddle(Vec v) {
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+#elif CITRA_ARCH(arm64)
+#define SIMD_TARGET
+
+using Vec = uint8x16_t;
+
+inline Vec Load(const u8* src) {
+    return vld1q_u8(src);
+}
+
+inline Vec Load64(const u8* src) {
+    return vcombine_u8(vld1_u8(src), vdup_n_u8(0));
+}
+
+inline void Store(u8* dest, Vec v) {
+    vst1q_u8(dest, v);
+}
+
+inline void StoreLow64(u8* dest, Vec v) {
+    vst1_u8(dest, vget_low_u8(v));
+}
+
+inline void StoreHigh64(u8* dest, Vec v) {
+    vst1_u8(dest, vget_high_u8(v));
+}
+
+/// Returns the low halves of a and b concatenated.
+inline Vec CombineLow(Vec a, Vec b) {
+    return vcombine_u8(vget_low_u8(a), vget_low_u8(b));
+}
+
+/// Returns the high halves of a and b concatenated.
+inline Vec CombineHigh(Vec a, Vec b) {
+    return vcombine_u8(vget_high_u8(a), vget_high_u8(b));
+}
+
+inline Vec Splat(u32 value) {
+    return vreinterpretq_u8_u32(vdupq_n_u32(value));
+}
+
+template <int shift>
+inline Vec ShiftLeft(Vec v) {
+    return vreinterpretq_u8_u32(vshlq_n_u32(vreinterpretq_u32_u8(v), shift));
+}
+
+template <int shift>
+inline Vec ShiftRight(Vec v) {
+    return vreinterpretq_u8_u32(vshrq_n_u32(vreinterpretq_u32_u8(v), shift));
+}
+
+inline Vec And(Vec a, Vec b) {
+    return vandq_u8(a, b);
+}
+
+inline Vec Or(Vec a, Vec b) {
+    return vorrq_u8(a, b);
+}
+
+inline Vec Negate(Vec v) {
+    return vreinterpretq_u8_s32(vnegq_s32(vreinterpretq_s32_u8(v)));
+}
+
+/// Gathers bytes of v by index, out of range indices produce zero.
+inline Vec ShuffleBytes(Vec v, const std::array<u8, 16>& indices) {
+    return vqtbl1q_u8(v, vld1q_u8(indices.data()));
+}
+
+/// Zero extends the four low 16-bit lanes to 32 bits.
+inline Vec Widen16(Vec v) {
+    return vreinterpretq_u8_u32(vmovl_u16(vget_low_u16(vreinterpretq_u16_u8(v))));
+}
+
+/// Truncates the four 32-bit lanes to 16 bits, packed into the low half.
+inline Vec Narrow16(Vec v) {
+    const uint16x4_t narrow = vmovn_u32(vreinterpretq_u32_u8(v));
+    return vcombine_u8(vreinterpret_u8_u16(narrow), vdup_n_u8(0));
+}
+
+/// Swaps the two middle 32-bit lanes.
+inline Vec SwapMiddle(Vec v) {
+    const uint32x4_t lanes = vreinterpretq_u32_u8(v);
+    const uint32x2_t even = vget_low_u32(vuzp1q_u32(lanes, lanes));
+    const uint32x2_t odd = vget_low_u32(vuzp2q_u32(lanes, lanes));
+    return vreinterpretq_u8_u32(vcombine_u32(even, odd));
+}
+#endif
+
+constexpr std::array<u8, 16> BYTESWAP_32 = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+constexpr std::array<u8, 16> EXPAND_RGB8 = {2, 1, 0, 0x80, 5,  4,  3, 0x80,
+                                            8, 7, 6, 0x80, 11, 10, 9, 0x80};
+constexpr std::array<u8, 16> PACK_RGB8 = {2,  1,  0,  6,    5,    4,    10,   9,
+                                          8,  14, 13, 12,   0x80, 0x80, 0x80, 0x80};
+constexpr std::array<u8, 16> EXPAND_IA8 = {1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6};
+
+SIMD_TARGET inline Vec Expand4(Vec v) {
+    return Or(ShiftLeft<4>(v), v);
+}
+
+SIMD_TARGET inline Vec Expand5(Vec v) {
+    return Or(ShiftLeft<3>(v), ShiftRight<2>(v));
+}
+
+SIMD_TARGET inline Vec Expand6(Vec v) {
+    return Or(ShiftLeft<2>(v), ShiftRight<4>(v));
+}
+
+SIMD_TARGET inline Vec MakeRGBA(Vec r, Vec g, Vec b, Vec a) {
+    return Or(Or(r, ShiftLeft<8>(g)), Or(ShiftLeft<16>(b), ShiftLeft<24>(a)));
+}
+
+/// Decodes four consecutive pixels of the source into four RGBA8 (or 32-bit depth) lanes.
+template <PixelFormat format, bool converted>
+SIMD_TARGET Vec DecodePixels(const u8* source) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        const Vec pixels = Load(source);
+        return converted ? ShuffleBytes(pixels, BYTESWAP_32) : pixels;
+    } else if constexpr (format == PixelFormat::D24S8) {
+        const Vec pixels = Load(source);
+        return Or(ShiftLeft<8>(pixels), ShiftRight<24>(pixels));
+    } else if constexpr (format == PixelFormat::RGB8) {
+        alignas(16) std::array<u8, 16> pixels{};
+        std::memcpy(pixels.data(), source, 12);
+        return Or(ShuffleBytes(Load(pixels.data()), EXPAND_RGB8), Splat(0xFF000000));
+    } else if constexpr (format == PixelFormat::IA8) {
+        return ShuffleBytes(Load64(source), EXPAND_IA8);
+    } else {
+        const Vec pixels = Widen16(Load64(source));
+        if constexpr (format == PixelFormat::RGB565) {
+            const Vec r = Expand5(ShiftRight<11>(pixels));
+            const Vec g = Expand6(And(ShiftRight<5>(pixels), Splat(0x3F)));
+            const Vec b = Expand5(And(pixels, Splat(0x1F)));
+            return MakeRGBA(r, g, b, Splat(0xFF));
+        } else if constexpr (format == PixelFormat::RGB5A1) {
+            const Vec r = Expand5(ShiftRight<11>(pixels));
+            const Vec g = Expand5(And(ShiftRight<6>(pixels), Splat(0x1F)));
+            const Vec b = Expand5(And(ShiftRight<1>(pixels), Splat(0x1F)));
+            const Vec a = Negate(And(pixels, Splat(1)));
+            return MakeRGBA(r, g, b, a);
+        } else {
+            static_assert(format == PixelFormat::RGBA4);
+            const Vec r = Expand4(ShiftRight<12>(pixels));
+            const Vec g = Expand4(And(ShiftRight<8>(pixels), Splat(0xF)));
+            const Vec b = Expand4(And(ShiftRight<4>(pixels), Splat(0xF)));
+            const Vec a = Expand4(And(pixels, Splat(0xF)));
+            return MakeRGBA(r, g, b, a);
+        }
+    }
+}
+
+/// Encodes four RGBA8 (or 32-bit depth) lanes into four consecutive pixels of the destination.
+template <PixelFormat format, bool converted>
+SIMD_TARGET void EncodePixels(Vec pixels, u8* dest) {
+    if constexpr (format == PixelFormat::RGBA8) {
+        Store(dest, converted ? ShuffleBytes(pixels, BYTESWAP_32) : pixels);
+    } else if constexpr (format == PixelFormat::D24S8) {
+        Store(dest, Or(ShiftRight<8>(pixels), ShiftLeft<24>(pixels)));
+    } else if constexpr (format == PixelFormat::RGB8) {
+        alignas(16) std::array<u8, 16> packed;
+        Store(packed.data(), ShuffleBytes(pixels, PACK_RGB8));
+        std::memcpy(dest, packed.data(), 12);
+    } else {
+        const Vec mask = Splat(0xFF);
+        const Vec r = And(pixels, mask);
+        const Vec g = And(ShiftRight<8>(pixels), mask);
+        const Vec b = And(ShiftRight<16>(pixels), mask);
+        const Vec a = ShiftRight<24>(pixels);
+        Vec packed;
+        if constexpr (format == PixelFormat::RGB565) {
+            packed = Or(Or(ShiftLeft<11>(ShiftRight<3>(r)), ShiftLeft<5>(ShiftRight<2>(g))),
+                        ShiftRight<3>(b));
+        } else if constexpr (format == PixelFormat::RGB5A1) {
+            packed = Or(Or(ShiftLeft<11>(ShiftRight<3>(r)), ShiftLeft<6>(ShiftRight<3>(g))),
+                        Or(ShiftLeft<1>(ShiftRight<3>(b)), ShiftRight<7>(a)));
+        } else {
+            static_assert(format == PixelFormat::RGBA4);
+            packed = Or(Or(ShiftLeft<12>(ShiftRight<4>(r)), ShiftLeft<8>(ShiftRight<4>(g))),
+                        Or(ShiftLeft<4>(ShiftRight<4>(b)), ShiftRight<4>(a)));
+        }
+        StoreLow64(dest, Narrow16(packed));
+    }
+}
+
+/**
+ * Vectorized equivalent of MortonCopyTile. The tile is processed in 4x2 pixel blocks:
+ * in Z-order the pixels (x, y), (x + 1, y), (x, y + 1), (x + 1, y + 1) are consecutive and
+ * followed by the same 2x2 quad at x + 2, so the two rows of a block are the low and
+ * high halves of a pair of consecutive 4 pixel vectors.
+ */
+template <bool morton_to_linear, PixelFormat format, bool converted>
+SIMD_TARGET void MortonCopyTileSIMD(u32 stride, std::span<u8> tile_buffer,
+                                    std::span<u8> linear_buffer) {
+    constexpr u32 bytes_per_pixel = GetFormatBpp(format) / 8;
+    constexpr u32 linear_bytes_per_pixel = converted ? 4 : GetFormatBytesPerPixel(format);
+    static_assert(linear_bytes_per_pixel == 4 ||
+                  (linear_bytes_per_pixel == 2 && bytes_per_pixel == 2));
+
+    for (u32 y = 0; y < 8; y += 2) {
+        u8* const row0 = linear_buffer.data() + (7 - y) * stride * linear_bytes_per_pixel;
+        u8* const row1 = linear_buffer.data() + (6 - y) * stride * linear_bytes_per_pixel;
+        for (u32 x = 0; x < 8; x += 4) {
+            u8* const tiled = tile_buffer.data() + MortonInterleave(x, y) * bytes_per_pixel;
+            u8* const linear0 = row0 + x * linear_bytes_per_pixel;
+            u8* const linear1 = row1 + x * linear_bytes_per_pixel;
+            if constexpr (linear_bytes_per_pixel == 2) {
+                if constexpr (morton_to_linear) {
+                    const Vec pixels = SwapMiddle(Load(tiled));
+                    StoreLow64(linear0, pixels);
+                    StoreHigh64(linear1, pixels);
+                } else {
+                    Store(tiled, SwapMiddle(CombineLow(Load64(linear0), Load64(linear1))));
+                }
+            } else {
+                u8* const tiled_next = tiled + 4 * bytes_per_pixel;
+                if constexpr (morton_to_linear) {
+                    const Vec first = DecodePixels<format, converted>(tiled);
+                    const Vec second = DecodePixels<format, converted>(tiled_next);
+                    Store(linear0, CombineLow(first, second));
+                    Store(linear1, CombineHigh(first, second));
+                } else {
+                    const Vec pixels0 = Load(linear0);
+                    const Vec pixels1 = Load(linear1);
+                    EncodePixels<format, converted>(CombineLow(pixels0, pixels1), tiled);
+                    EncodePixels<format, converted>(CombineHigh(pixels0, pixels1), tiled_next);
+                }
+            }
+        }
+    }
+}
+
+#undef SIMD_TARGET
+
+template <bool morton_to_linear, PixelFormat format, bool converted = false>
+constexpr MortonFunc Kernel =
+    MortonCopy<morton_to_linear, format, converted,
+               MortonCopyTileSIMD<morton_to_linear, format, converted>>;
+
+// Only formats that have a scalar counterpart in the matching table are listed here.
+constexpr std::array<MortonFunc, 18> UNSWIZZLE_TABLE_SIMD = {
+    Kernel<true, PixelFormat::RGBA8>,  // 0
+    nullptr,                           // 1
+    Kernel<true, PixelFormat::RGB5A1>, // 2
+    Kernel<true, PixelFormat::RGB565>, // 3
+    Kernel<true, PixelFormat::RGBA4>,  // 4
+    Kernel<true, PixelFormat::IA8>,    // 5
+    nullptr,                           // 6
+    nullptr,                           // 7
+    nullptr,                           // 8
+    nullptr,                           // 9
+    nullptr,                           // 10
+    nullptr,                           // 11
+    nullptr,                           // 12
+    nullptr,                           // 13
+    Kernel<true, PixelFormat::D16>,    // 14
+    nullptr,                           // 15
+    nullptr,                           // 16
+    Kernel<true, PixelFormat::D24S8>,  // 17
+};
+
+constexpr std::array<MortonFunc, 18> UNSWIZZLE_TABLE_SIMD_CONVERTED = {
+    Kernel<true, PixelFormat::RGBA8, true>,  // 0
+    Kernel<true, PixelFormat::RGB8, true>,   // 1
+    Kernel<true, PixelFormat::RGB5A1, true>, // 2
+    Kernel<true, PixelFormat::RGB565, true>, // 3
+    Kernel<true, PixelFormat::RGBA4, true>,  // 4
+};
+
+constexpr std::array<MortonFunc, 18> SWIZZLE_TABLE_SIMD = {
+    Kernel<false, PixelFormat::RGBA8>,  // 0
+    nullptr,                            // 1
+    Kernel<false, PixelFormat::RGB5A1>, // 2
+    Kernel<false, PixelFormat::RGB565>, // 3
+    Kernel<false, PixelFormat::RGBA4>,  // 4
+    nullptr,                            // 5
+    nullptr,                            // 6
+    nullptr,                            // 7
+    nullptr,                            // 8
+    nullptr,                            // 9
+    nullptr,                            // 10
+    nullptr,                            // 11
+    nullptr,                            // 12
+    nullptr,                            // 13
+    Kernel<false, PixelFormat::D16>,    // 14
+    nullptr,                            // 15
+    nullptr,                            // 16
+    Kernel<false, PixelFormat::D24S8>,  // 17
+};
+
+constexpr std::array<MortonFunc, 18> SWIZZLE_TABLE_SIMD_CONVERTED = {
+    Kernel<false, PixelFormat::RGBA8, true>,  // 0
+    Kernel<false, PixelFormat::RGB8, true>,   // 1
+    Kernel<false, PixelFormat::RGB5A1, true>, // 2
+    Kernel<false, PixelFormat::RGB565, true>, // 3
+    Kernel<false, PixelFormat::RGBA4, true>,  // 4
+};
+
+bool HostSupportsSIMD() {
+#if CITRA_ARCH(x86_64)
+    static const bool supported = Common::GetCPUCaps().ssse3;
+    return supported;
+#else
+    return true;
+#endif
+}
+
+MortonFunc LookupSIMD(const std::array<MortonFunc, 18>& table, PixelFormat format) {
+    const std::size_t index = static_cast<std::size_t>(format);
+    if (index >= table.size() || !HostSupportsSIMD()) {
+        return nullptr;
+    }
+    return table[index];
+}
+
+} // Anonymous namespace
+
+MortonFunc GetUnswizzleSIMD(PixelFormat format, bool converted) {
+    return LookupSIMD(converted ? UNSWIZZLE_TABLE_SIMD_CONVERTED : UNSWIZZLE_TABLE_SIMD, format);
+}
+
+MortonFunc GetSwizzleSIMD(PixelFormat format, bool converted) {
+    return LookupSIMD(converted ? SWIZZLE_TABLE_SIMD_CONVERTED : SWIZZLE_TABLE_SIMD, format);
+}
+
+#else
+
+MortonFunc GetUnswizzleSIMD(PixelFormat, bool) {
+    return nullptr;
+}
+
+MortonFunc GetSwizzleSIMD(PixelFormat, bool) {
+    return nullptr;
+}
+
+#endif
+
+} // namespace VideoCore
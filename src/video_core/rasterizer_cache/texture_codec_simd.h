@@ -0,0 +1,25 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "video_core/rasterizer_cache/texture_codec.h"
+
+namespace VideoCore {
+
+/**
+ * Returns a vectorized morton to linear copy for the provided format, or nullptr
+ * if the host lacks the required instruction set or the format has no vector kernel.
+ * The returned function produces output identical to the matching UNSWIZZLE_TABLE entry.
+ */
+MortonFunc GetUnswizzleSIMD(PixelFormat format, bool converted);
+
+/**
+ * Returns a vectorized linear to morton copy for the provided format, or nullptr
+ * if the host lacks the required instruction set or the format has no vector kernel.
+ * The returned function produces output identical to the matching SWIZZLE_TABLE entry.
+ */
+MortonFunc GetSwizzleSIMD(PixelFormat format, bool converted);
+
+} // namespace VideoCore
@@ -2,12 +2,34 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <thread>
+#include "common/thread_worker.h"
 #include "video_core/rasterizer_cache/surface_params.h"
 #include "video_core/rasterizer_cache/texture_codec.h"
+#include "video_core/rasterizer_cache/texture_codec_simd.h"
 #include "video_core/rasterizer_cache/utils.h"
 
 namespace VideoCore {
 
+namespace {
+
+MortonFunc GetSwizzleFunc(PixelFormat format, bool convert) {
+    if (const MortonFunc func = GetSwizzleSIMD(format, convert)) {
+        return func;
+    }
+    return (convert ? SWIZZLE_TABLE_CONVERTED : SWIZZLE_TABLE)[static_cast<u32>(format)];
+}
+
+MortonFunc GetUnswizzleFunc(PixelFormat format, bool convert) {
+    if (const MortonFunc func = GetUnswizzleSIMD(format, convert)) {
+        return func;
+    }
+    return (convert ? UNSWIZZLE_TABLE_CONVERTED : UNSWIZZLE_TABLE)[static_cast<u32>(format)];
+}
+
+} // Anonymous namespace
+
 u32 MipLevels(u32 width, u32 height, u32 max_level) {
     u32 levels = 1;
     while (width > 8 && height > 8) {
@@ -25,8 +47,7 @@ void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
     const u32 func_index = static_cast<u32>(format);
 
     if (surface_info.is_tiled) {
-        const MortonFunc SwizzleImpl =
-            (convert ? SWIZZLE_TABLE_CONVERTED : SWIZZLE_TABLE)[func_index];
+        const MortonFunc SwizzleImpl = GetSwizzleFunc(format, convert);
         if (SwizzleImpl) {
             SwizzleImpl(surface_info.width, surface_info.height, start_addr - surface_info.addr,
                         end_addr - surface_info.addr, source, dest);
@@ -52,8 +73,7 @@ void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
     const u32 func_index = static_cast<u32>(format);
 
     if (surface_info.is_tiled) {
-        const MortonFunc UnswizzleImpl =
-            (convert ? UNSWIZZLE_TABLE_CONVERTED : UNSWIZZLE_TABLE)[func_index];
+        const MortonFunc UnswizzleImpl = GetUnswizzleFunc(format, convert);
         if (UnswizzleImpl) {
             UnswizzleImpl(surface_info.width, surface_info.height, start_addr - surface_info.addr,
                           end_addr - surface_info.addr, dest, source);
@@ -73,4 +93,46 @@ void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
     UNIMPLEMENTED();
 }
 
+void QueueDecodeTexture(std::unique_ptr<Common::ThreadWorker>& workers,
+                        const SurfaceParams& surface_info, PAddr start_addr, PAddr end_addr,
+                        std::span<u8> source, std::span<u8> dest, bool convert) {
+    // Number of decoded pixels below which splitting the decode is not worth it. This is
+    // counted in pixels so that compressed formats, which are small in guest memory but
+    // expensive to expand, are split as readily as the uncompressed ones.
+    static constexpr u32 MIN_PIXELS_PER_JOB = 16 * 1024;
+
+    const MortonFunc UnswizzleImpl =
+        surface_info.is_tiled ? GetUnswizzleFunc(surface_info.pixel_format, convert) : nullptr;
+    const u32 size = end_addr - start_addr;
+    const u32 num_pixels = surface_info.PixelsInBytes(size);
+    if (!UnswizzleImpl || num_pixels < 2 * MIN_PIXELS_PER_JOB) {
+        DecodeTexture(surface_info, start_addr, end_addr, source, dest, convert);
+        return;
+    }
+
+    // Games that never decode large textures do not need the pool at all.
+    if (!workers) {
+        workers = std::make_unique<Common::ThreadWorker>(
+            std::max(std::thread::hardware_concurrency() / 2, 2U), "Texture decoders");
+    }
+
+    // Bands are made of whole rows of tiles, which map to disjoint pixels of the linear output.
+    const u32 tile_row_size = surface_info.BytesInPixels(surface_info.width * 8);
+    const u32 max_jobs = static_cast<u32>(workers->NumWorkers());
+    const u32 num_jobs = std::min(max_jobs, num_pixels / MIN_PIXELS_PER_JOB);
+    const u32 job_size = Common::AlignUp((size + num_jobs - 1) / num_jobs, tile_row_size);
+
+    const u32 width = surface_info.width;
+    const u32 height = surface_info.height;
+    for (u32 offset = 0; offset < size; offset += job_size) {
+        const u32 job_end = std::min(offset + job_size, size);
+        const u32 start_offset = start_addr - surface_info.addr + offset;
+        const u32 end_offset = start_addr - surface_info.addr + job_end;
+        const auto job_source = source.subspan(offset, job_end - offset);
+        workers->QueueWork([=] {
+            UnswizzleImpl(width, height, start_offset, end_offset, dest, job_source);
+        });
+    }
+}
+
 } // namespace VideoCore
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <memory>
 #include <span>
 #include "common/math_util.h"
+#include "common/thread_worker.h"
 #include "common/vector_math.h"
 
 namespace VideoCore {
@@ -97,4 +99,22 @@ void EncodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr en
 void DecodeTexture(const SurfaceParams& surface_info, PAddr start_addr, PAddr end_addr,
                    std::span<u8> source, std::span<u8> dest, bool convert = false);
 
+/**
+ * Decodes a linear or tiled texture to the expected linear format like DecodeTexture. Large tiled
+ * textures are split in bands of tile rows which are queued on the provided workers, the caller
+ * must wait for the workers before consuming the decoded data.
+ *
+ * @param workers The workers the decode is queued on, created by the first decode that is split.
+ * @param surface_info Structure used to query the surface information.
+ * @param start_addr The start address of the source data. Used if tiled.
+ * @param end_addr The end address of the source data. Used if tiled.
+ * @param source_tiled The source linear or tiled texture data.
+ * @param dest_linear The output buffer where the decoded linear data will be written to.
+ * @param convert Whether the pixel format needs to be converted.
+ */
+void QueueDecodeTexture(std::unique_ptr<Common::ThreadWorker>& workers,
+                        const SurfaceParams& surface_info,
+                        PAddr start_addr, PAddr end_addr, std::span<u8> source,
+                        std::span<u8> dest, bool convert = false);
+
 } // namespace VideoCore
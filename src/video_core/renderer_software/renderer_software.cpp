@@ -4,6 +4,7 @@
 
 #include "common/color.h"
 #include "core/core.h"
+#include "video_core/frame_hash_log.h"
 #include "video_core/gpu.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/renderer_software/renderer_software.h"
@@ -19,6 +20,10 @@ RendererSoftware::~RendererSoftware() = default;
 
 void RendererSoftware::SwapBuffers() {
     PrepareRenderTarget();
+    if (frame_hash_log) {
+        frame_hash_log->AddFrame(Screen(VideoCore::ScreenId::TopLeft).pixels,
+                                 Screen(VideoCore::ScreenId::Bottom).pixels);
+    }
     EndFrame();
 }
 
@@ -11,6 +11,10 @@ namespace Core {
 class System;
 }
 
+namespace VideoCore {
+class FrameHashLog;
+}
+
 namespace SwRenderer {
 
 struct ScreenInfo {
@@ -33,6 +37,11 @@ public:
         return screen_infos[static_cast<u32>(id)];
     }
 
+    /// Hashes every presented frame into the log, nullptr to stop hashing
+    void SetFrameHashLog(VideoCore::FrameHashLog* log) noexcept {
+        frame_hash_log = log;
+    }
+
     void SwapBuffers() override;
     void TryPresent(int timeout_ms, bool is_secondary) override {}
     void Sync() override {}
@@ -46,6 +55,7 @@ private:
     Pica::PicaCore& pica;
     RasterizerSoftware rasterizer;
     std::array<ScreenInfo, 3> screen_infos{};
+    VideoCore::FrameHashLog* frame_hash_log{};
 };
 
 } // namespace SwRenderer
@@ -5,11 +5,18 @@
 #include "common/arch.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
+#include <algorithm>
 #include "common/assert.h"
 #include "common/hash.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
+#include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
 #if CITRA_ARCH(arm64)
 #include "video_core/shader/shader_jit_a64_compiler.h"
 #endif
@@ -26,6 +33,10 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
     setup.entry_point = entry_point;
 
+    if (!disk_cache_loaded) {
+        LoadDiskCache();
+    }
+
     const u64 code_hash = setup.GetProgramCodeHash();
     const u64 swizzle_hash = setup.GetSwizzleDataHash();
 
@@ -33,14 +44,102 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     auto iter = cache.find(cache_key);
     if (iter != cache.end()) {
         setup.cached_shader = iter->second.get();
-    } else {
-        auto shader = std::make_unique<JitShader>();
+        return;
+    }
+
+    auto shader = TakePrecompiled(cache_key);
+    if (!shader) {
+        shader = std::make_unique<JitShader>();
         shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        if (disk_cache) {
+            disk_cache->Save(cache_key, setup.program_code, setup.swizzle_data);
+        }
+    }
+    setup.cached_shader = shader.get();
+    cache.emplace_hint(iter, cache_key, std::move(shader));
+}
+
+void JitEngine::LoadDiskCache() {
+    disk_cache_loaded = true;
+    if (!Settings::values.use_disk_shader_cache) {
+        return;
+    }
+
+    // Skip games without title id
+    u64 program_id{};
+    if (Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id) !=
+            Loader::ResultStatus::Success ||
+        program_id == 0) {
+        return;
+    }
+
+    disk_cache = std::make_unique<JitDiskCache>(program_id);
+    auto entries = disk_cache->Load();
+    if (entries.empty()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{precompile_mutex};
+        for (auto& entry : entries) {
+            if (!cache.contains(entry->key)) {
+                pending_programs.push_back(std::move(entry));
+            }
+        }
+    }
+    precompile_thread =
+        std::jthread([this](std::stop_token stop_token) { PrecompileThread(stop_token); });
+}
+
+void JitEngine::PrecompileThread(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("ShaderJitPrecompile");
+    while (!stop_token.stop_requested()) {
+        std::unique_ptr<JitDiskCache::Entry> entry;
+        {
+            std::scoped_lock lock{precompile_mutex};
+            if (pending_programs.empty()) {
+                return;
+            }
+            entry = std::move(pending_programs.front());
+            pending_programs.pop_front();
+            precompiling = entry->key;
+        }
+
+        auto shader = std::make_unique<JitShader>();
+        shader->Compile(&entry->program_code, &entry->swizzle_data);
+        {
+            std::scoped_lock lock{precompile_mutex};
+            precompiled.emplace(entry->key, std::move(shader));
+            precompiling.reset();
+        }
+        precompile_done.notify_all();
     }
 }
 
+std::unique_ptr<JitShader> JitEngine::TakePrecompiled(u64 key) {
+    std::unique_lock lock{precompile_mutex};
+    // Compiling the program a second time would not be faster than waiting for it
+    precompile_done.wait(lock, [&] { return precompiling != key; });
+
+    if (const auto it = precompiled.find(key); it != precompiled.end()) {
+        auto shader = std::move(it->second);
+        precompiled.erase(it);
+        return shader;
+    }
+
+    const auto it = std::ranges::find_if(
+        pending_programs, [key](const auto& entry) { return entry->key == key; });
+    if (it == pending_programs.end()) {
+        return nullptr;
+    }
+    const auto entry = std::move(*it);
+    pending_programs.erase(it);
+    lock.unlock();
+
+    auto shader = std::make_unique<JitShader>();
+    shader->Compile(&entry->program_code, &entry->swizzle_data);
+    return shader;
+}
+
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
@@ -52,6 +151,21 @@ void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     shader->Run(setup, state, setup.entry_point);
 }
 
+void JitEngine::RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const {
+    ASSERT(setup.cached_shader != nullptr);
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitShader* shader = static_cast<const JitShader*>(setup.cached_shader);
+#if CITRA_ARCH(x86_64)
+    shader->RunBatch(setup, states, setup.entry_point);
+#else
+    for (ShaderUnit& state : states) {
+        shader->Run(setup, state, setup.entry_point);
+    }
+#endif
+}
+
 } // namespace Pica::Shader
 
 #endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
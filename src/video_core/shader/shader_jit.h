@@ -7,10 +7,16 @@
 #include "common/arch.h"
 #if CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <unordered_map>
 #include "common/common_types.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
 
 namespace Pica::Shader {
 
@@ -23,9 +29,33 @@ public:
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states) const override;
 
 private:
+    /// Starts compiling the programs recorded in the disk cache of the running title.
+    void LoadDiskCache();
+
+    /// Compiles the recorded programs in the background, in the order they were first used.
+    void PrecompileThread(std::stop_token stop_token);
+
+    /**
+     * Returns the shader compiled in the background for the key. A recorded program the thread
+     * did not reach yet is compiled right away.
+     * @returns nullptr if the program was not recorded in the disk cache.
+     */
+    std::unique_ptr<JitShader> TakePrecompiled(u64 key);
+
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    std::unique_ptr<JitDiskCache> disk_cache;
+    bool disk_cache_loaded{};
+
+    std::mutex precompile_mutex;
+    std::condition_variable precompile_done;
+    std::deque<std::unique_ptr<JitDiskCache::Entry>> pending_programs;
+    std::unordered_map<u64, std::unique_ptr<JitShader>> precompiled;
+    /// Key of the program the precompile thread is compiling
+    std::optional<u64> precompiling;
+    std::jthread precompile_thread;
 };
 
 } // namespace Pica::Shader
@@ -0,0 +1,177 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <fmt/format.h>
+
+#include "common/common_paths.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+namespace Pica::Shader {
+
+/// Bump this when the layout of the cache file changes.
+constexpr u32 NativeVersion = 1;
+
+/// Size of the uncompressed payload of each entry.
+constexpr std::size_t PAYLOAD_SIZE = sizeof(ProgramCode) + sizeof(SwizzleData);
+
+JitDiskCache::JitDiskCache(u64 program_id_) : program_id{program_id_}, file{OpenCacheFile()} {}
+
+JitDiskCache::~JitDiskCache() = default;
+
+std::vector<std::unique_ptr<JitDiskCache::Entry>> JitDiskCache::Load() {
+    std::vector<std::unique_ptr<Entry>> entries;
+    if (!file.IsOpen()) {
+        return entries;
+    }
+
+    file.Seek(0, SEEK_SET);
+    u32 version{};
+    if (file.ReadBytes(&version, sizeof(version)) != sizeof(version) || version != NativeVersion) {
+        LOG_INFO(HW_GPU, "Shader JIT cache is outdated or corrupted - removing");
+        Invalidate();
+        return entries;
+    }
+
+    const u64 file_size = file.GetSize();
+    std::vector<u8> compressed;
+    // A short read leaves the file at its end, so truncation has to be tracked separately
+    bool truncated = false;
+    u64 valid_size = file.Tell();
+    while (file.Tell() < file_size) {
+        u64 key{};
+        u32 compressed_size{};
+        if (file.ReadBytes(&key, sizeof(key)) != sizeof(key) ||
+            file.ReadBytes(&compressed_size, sizeof(compressed_size)) != sizeof(compressed_size)) {
+            truncated = true;
+            break;
+        }
+
+        compressed.resize(compressed_size);
+        if (file.ReadBytes(compressed.data(), compressed_size) != compressed_size) {
+            truncated = true;
+            break;
+        }
+
+        const std::vector<u8> payload = Common::Compression::DecompressDataZSTD(compressed);
+        if (payload.size() != PAYLOAD_SIZE) {
+            truncated = true;
+            break;
+        }
+        valid_size = file.Tell();
+
+        auto entry = std::make_unique<Entry>();
+        entry->key = key;
+        std::memcpy(entry->program_code.data(), payload.data(), sizeof(ProgramCode));
+        std::memcpy(entry->swizzle_data.data(), payload.data() + sizeof(ProgramCode),
+                    sizeof(SwizzleData));
+
+        // Discard entries that do not match the key they were stored with.
+        const u64 code_hash = Common::ComputeHash64(&entry->program_code, sizeof(ProgramCode));
+        const u64 swizzle_hash = Common::ComputeHash64(&entry->swizzle_data, sizeof(SwizzleData));
+        if (Common::HashCombine(code_hash, swizzle_hash) != key) {
+            LOG_WARNING(HW_GPU, "Skipping shader JIT cache entry with mismatching key={:016X}",
+                        key);
+            continue;
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    // Drop the partial entry and keep the ones before it, new entries are appended after them
+    if (truncated) {
+        LOG_ERROR(HW_GPU, "Shader JIT cache for title id={:016X} is truncated at offset={}",
+                  program_id, valid_size);
+        // The short read left the file in an error state
+        file.Clear();
+        if (!file.Resize(valid_size)) {
+            LOG_ERROR(HW_GPU, "Failed to truncate shader JIT cache file={} - removing",
+                      GetCachePath());
+            Invalidate();
+        }
+    }
+
+    file.Seek(0, SEEK_END);
+    LOG_INFO(HW_GPU, "Loaded {} entries from the shader JIT cache of title id={:016X}",
+             entries.size(), program_id);
+    return entries;
+}
+
+void JitDiskCache::Save(u64 key, const ProgramCode& program_code,
+                        const SwizzleData& swizzle_data) {
+    if (!file.IsOpen()) {
+        return;
+    }
+
+    std::vector<u8> payload(PAYLOAD_SIZE);
+    std::memcpy(payload.data(), program_code.data(), sizeof(ProgramCode));
+    std::memcpy(payload.data() + sizeof(ProgramCode), swizzle_data.data(), sizeof(SwizzleData));
+    const std::vector<u8> compressed = Common::Compression::CompressDataZSTDDefault(payload);
+
+    const u32 compressed_size = static_cast<u32>(compressed.size());
+    if (file.WriteObject(key) != 1 || file.WriteObject(compressed_size) != 1 ||
+        file.WriteBytes(compressed.data(), compressed.size()) != compressed.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write shader JIT cache entry in path={}", GetCachePath());
+        return;
+    }
+    file.Flush();
+}
+
+bool JitDiskCache::EnsureDirectories() const {
+    const auto CreateDir = [](const std::string& dir) {
+        if (!FileUtil::CreateDir(dir)) {
+            LOG_ERROR(HW_GPU, "Failed to create directory={}", dir);
+            return false;
+        }
+        return true;
+    };
+
+    return CreateDir(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)) &&
+           CreateDir(GetBaseDir());
+}
+
+std::string JitDiskCache::GetBaseDir() const {
+    return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "jit";
+}
+
+std::string JitDiskCache::GetCachePath() const {
+    return FileUtil::SanitizePath(
+        fmt::format("{}{}{:016X}.bin", GetBaseDir(), DIR_SEP_CHR, program_id));
+}
+
+void JitDiskCache::Invalidate() {
+    file.Close();
+    if (!FileUtil::Delete(GetCachePath())) {
+        LOG_ERROR(HW_GPU, "Failed to invalidate shader JIT cache file={}", GetCachePath());
+    }
+    file = OpenCacheFile();
+}
+
+FileUtil::IOFile JitDiskCache::OpenCacheFile() {
+    if (!EnsureDirectories()) {
+        return {};
+    }
+
+    const auto cache_path{GetCachePath()};
+    const bool existed = FileUtil::Exists(cache_path);
+
+    FileUtil::IOFile cache_file(cache_path, existed ? "rb+" : "wb+");
+    if (!cache_file.IsOpen()) {
+        LOG_ERROR(HW_GPU, "Failed to open shader JIT cache in path={}", cache_path);
+        return {};
+    }
+    if (!existed || cache_file.GetSize() == 0) {
+        if (cache_file.WriteObject(NativeVersion) != 1) {
+            LOG_ERROR(HW_GPU, "Failed to write shader JIT cache version in path={}", cache_path);
+            return {};
+        }
+        cache_file.Flush();
+    }
+    cache_file.Seek(0, SEEK_END);
+    return cache_file;
+}
+
+} // namespace Pica::Shader
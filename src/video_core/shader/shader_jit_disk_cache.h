@@ -0,0 +1,59 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/pica/shader_setup.h"
+
+namespace Pica::Shader {
+
+/**
+ * Per-title record of the PICA programs translated by the shader JIT. Emitted host code embeds
+ * absolute addresses and is not relocatable, so the cache stores the program and swizzle data
+ * each entry was compiled from, which allows the JIT to rebuild its cache when a title boots
+ * instead of compiling each program on its first draw.
+ */
+class JitDiskCache {
+public:
+    struct Entry {
+        u64 key;
+        ProgramCode program_code;
+        SwizzleData swizzle_data;
+    };
+
+    explicit JitDiskCache(u64 program_id);
+    ~JitDiskCache();
+
+    /**
+     * Reads all valid entries of the cache file. An outdated file is removed, a truncated one is
+     * cut back to its last complete entry.
+     */
+    std::vector<std::unique_ptr<Entry>> Load();
+
+    /// Appends a newly compiled program to the cache file.
+    void Save(u64 key, const ProgramCode& program_code, const SwizzleData& swizzle_data);
+
+private:
+    bool EnsureDirectories() const;
+
+    std::string GetBaseDir() const;
+
+    std::string GetCachePath() const;
+
+    void Invalidate();
+
+    FileUtil::IOFile OpenCacheFile();
+
+private:
+    u64 program_id;
+    FileUtil::IOFile file;
+};
+
+} // namespace Pica::Shader
@@ -123,6 +123,8 @@ constexpr Reg64 COND0 = r13;
 constexpr Reg64 COND1 = r14;
 /// Pointer to the ShaderUnit instance for the current VS unit
 constexpr Reg64 STATE = r15;
+/// Pointer past the last ShaderUnit instance of the batch being run
+constexpr Reg64 BATCH_END = rbp;
 /// SIMD scratch register
 constexpr Xmm SCRATCH = xmm0;
 /// Loaded with the first swizzled source register, otherwise can be used as a scratch register
@@ -144,6 +146,7 @@ static const std::bitset<32> persistent_regs = BuildRegSet({
     // Pointers to register blocks
     UNIFORMS,
     STATE,
+    BATCH_END,
     // Cached registers
     ADDROFFS_REG_0,
     ADDROFFS_REG_1,
@@ -673,7 +676,7 @@ void JitShader::Compile_END(Instruction instr) {
     mov(dword[STATE + offsetof(ShaderUnit, address_registers[1])], ADDROFFS_REG_1.cvt32());
     mov(dword[STATE + offsetof(ShaderUnit, address_registers[2])], LOOPCOUNT_REG);
 
-    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    // Return to the batch loop
     ret();
 }
 
@@ -988,22 +991,16 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     FindReturnOffsets();
 
     // The stack pointer is 8 modulo 16 at the entry of a procedure
-    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
-    // return checks (see Compile_Return) that happen in shader main routine.
+    // We reserve 16 bytes, the second 8 bytes hold the address the shader program starts at.
     ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
-    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
 
-    mov(UNIFORMS, ABI_PARAM1);
+    // UNIFORMS aliases ABI_PARAM4 on Windows, so the start address has to be read out first.
+    mov(rax, ABI_PARAM4);
+    mov(qword[rsp + 8], rax);
     mov(STATE, ABI_PARAM2);
-
-    // Load address/loop registers
-    movsxd(ADDROFFS_REG_0, dword[STATE + offsetof(ShaderUnit, address_registers[0])]);
-    movsxd(ADDROFFS_REG_1, dword[STATE + offsetof(ShaderUnit, address_registers[1])]);
-    mov(LOOPCOUNT_REG, dword[STATE + offsetof(ShaderUnit, address_registers[2])]);
-
-    // Load conditional code
-    mov(COND0, byte[STATE + offsetof(ShaderUnit, conditional_code[0])]);
-    mov(COND1, byte[STATE + offsetof(ShaderUnit, conditional_code[1])]);
+    imul(BATCH_END, ABI_PARAM3, static_cast<u32>(sizeof(ShaderUnit)));
+    add(BATCH_END, STATE);
+    mov(UNIFORMS, ABI_PARAM1);
 
     // Used to set a register to one
     static const __m128 one = {1.f, 1.f, 1.f, 1.f};
@@ -1015,8 +1012,35 @@ void JitShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_
     mov(rax, reinterpret_cast<std::size_t>(&neg));
     movaps(NEGBIT, xword[rax]);
 
-    // Jump to start of the shader program
-    jmp(ABI_PARAM3);
+    // Each shader unit is run by calling into the program, which returns on END. The pushed return
+    // address keeps the main routine 16 byte aligned, and the dummy value below it is seen as the
+    // return offset by any return checks (see Compile_Return) that happen in the main routine.
+    sub(rsp, 8);
+    mov(qword[rsp], 0xFFFFFFFFFFFFFFFFULL);
+
+    Label l_batch_loop, l_batch_end;
+    L(l_batch_loop);
+    cmp(STATE, BATCH_END);
+    jae(l_batch_end, T_NEAR);
+
+    // Load address/loop registers
+    movsxd(ADDROFFS_REG_0, dword[STATE + offsetof(ShaderUnit, address_registers[0])]);
+    movsxd(ADDROFFS_REG_1, dword[STATE + offsetof(ShaderUnit, address_registers[1])]);
+    mov(LOOPCOUNT_REG, dword[STATE + offsetof(ShaderUnit, address_registers[2])]);
+
+    // Load conditional code
+    mov(COND0, byte[STATE + offsetof(ShaderUnit, conditional_code[0])]);
+    mov(COND1, byte[STATE + offsetof(ShaderUnit, conditional_code[1])]);
+
+    // Run the shader program for the current unit and advance to the next one
+    call(qword[rsp + 16]);
+    add(STATE, static_cast<u32>(sizeof(ShaderUnit)));
+    jmp(l_batch_loop, T_NEAR);
+
+    L(l_batch_end);
+    add(rsp, 8);
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
 
     // Compile entire program
     Compile_Block(static_cast<u32>(program_code->size()));
@@ -10,6 +10,7 @@
 #include <array>
 #include <bitset>
 #include <cstddef>
+#include <span>
 #include <vector>
 #include <nihstro/shader_bytecode.h>
 #include <xbyak/xbyak.h>
@@ -39,7 +40,16 @@ public:
     JitShader();
 
     void Run(const ShaderSetup& setup, ShaderUnit& state, u32 offset) const {
-        program(&setup.uniforms, &state, instruction_labels[offset].getAddress());
+        program(&setup.uniforms, &state, 1, instruction_labels[offset].getAddress());
+    }
+
+    /**
+     * Runs the shader over a contiguous batch of shader units. The register save and constant
+     * setup happens once for the whole batch instead of once per unit.
+     */
+    void RunBatch(const ShaderSetup& setup, std::span<ShaderUnit> states, u32 offset) const {
+        program(&setup.uniforms, states.data(), states.size(),
+                instruction_labels[offset].getAddress());
     }
 
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
@@ -135,7 +145,8 @@ private:
     u32 program_counter = 0; ///< Offset of the next instruction to decode
     u8 loop_depth = 0;       ///< Depth of the (nested) loops currently compiled
 
-    using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
+    using CompiledShader = void(const void* setup, void* states, std::size_t num_states,
+                                const u8* start_addr);
     CompiledShader* program = nullptr;
 
     Xbyak::Label log2_subroutine;
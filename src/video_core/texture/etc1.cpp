@@ -115,8 +115,72 @@ union ETC1Tile {
 
         return ret.Cast<u8>();
     }
+
+    void Decode(ETC1Texels& texels) const {
+        // Each half of the subtile has four possible colors: the base color plus or minus
+        // either of the two modifiers of its table.
+        std::array<std::array<Common::Vec3<u8>, 4>, 2> palette;
+        for (unsigned half = 0; half < 2; half++) {
+            Common::Vec3<int> base;
+            if (differential_mode) {
+                base.r() = static_cast<int>(differential.r);
+                base.g() = static_cast<int>(differential.g);
+                base.b() = static_cast<int>(differential.b);
+                if (half == 1) {
+                    base.r() += static_cast<int>(differential.dr);
+                    base.g() += static_cast<int>(differential.dg);
+                    base.b() += static_cast<int>(differential.db);
+                }
+                base.r() = Common::Color::Convert5To8(base.r());
+                base.g() = Common::Color::Convert5To8(base.g());
+                base.b() = Common::Color::Convert5To8(base.b());
+            } else if (half == 0) {
+                base.r() = Common::Color::Convert4To8(static_cast<u8>(separate.r1));
+                base.g() = Common::Color::Convert4To8(static_cast<u8>(separate.g1));
+                base.b() = Common::Color::Convert4To8(static_cast<u8>(separate.b1));
+            } else {
+                base.r() = Common::Color::Convert4To8(static_cast<u8>(separate.r2));
+                base.g() = Common::Color::Convert4To8(static_cast<u8>(separate.g2));
+                base.b() = Common::Color::Convert4To8(static_cast<u8>(separate.b2));
+            }
+
+            const unsigned table_index = half == 0 ? table_index_1.Value() : table_index_2.Value();
+            for (unsigned entry = 0; entry < 4; entry++) {
+                int modifier = etc1_modifier_table[table_index][entry & 1];
+                if (entry & 2)
+                    modifier *= -1;
+                palette[half][entry] = Common::MakeVec(std::clamp(base.r() + modifier, 0, 255),
+                                                       std::clamp(base.g() + modifier, 0, 255),
+                                                       std::clamp(base.b() + modifier, 0, 255))
+                                           .Cast<u8>();
+            }
+        }
+
+        const u32 subindexes = static_cast<u32>(table_subindexes.Value());
+        const u32 negations = static_cast<u32>(negation_flags.Value());
+        for (unsigned y = 0; y < 4; y++) {
+            for (unsigned x = 0; x < 4; x++) {
+                const unsigned texel = 4 * x + y;
+                const unsigned half = (flip ? y : x) >= 2;
+                const unsigned entry =
+                    ((subindexes >> texel) & 1) | (((negations >> texel) & 1) << 1);
+                texels[y * 4 + x] = palette[half][entry];
+            }
+        }
+    }
 };
 
+/// Small direct-mapped cache of decoded subtiles, keyed by the raw subtile data.
+struct ETC1SubtileCache {
+    static constexpr std::size_t NUM_ENTRIES = 256;
+
+    std::array<u64, NUM_ENTRIES> keys{};
+    std::array<bool, NUM_ENTRIES> valid{};
+    std::array<ETC1Texels, NUM_ENTRIES> texels;
+};
+
+thread_local ETC1SubtileCache subtile_cache;
+
 } // anonymous namespace
 
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
@@ -124,4 +188,18 @@ Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y) {
     return tile.GetRGB(x, y);
 }
 
+void DecodeETC1Subtile(u64 value, ETC1Texels& texels) {
+    const std::size_t index = (value * 0x9E3779B97F4A7C15ULL) >> 56;
+    if (subtile_cache.valid[index] && subtile_cache.keys[index] == value) {
+        texels = subtile_cache.texels[index];
+        return;
+    }
+
+    ETC1Tile tile{value};
+    tile.Decode(texels);
+    subtile_cache.keys[index] = value;
+    subtile_cache.valid[index] = true;
+    subtile_cache.texels[index] = texels;
+}
+
 } // namespace Pica::Texture
@@ -4,11 +4,21 @@
 
 #pragma once
 
+#include <array>
 #include "common/common_types.h"
 #include "common/vector_math.h"
 
 namespace Pica::Texture {
 
+/// The 16 texels of a decoded 4x4 ETC1 subtile, indexed by y * 4 + x.
+using ETC1Texels = std::array<Common::Vec3<u8>, 16>;
+
 Common::Vec3<u8> SampleETC1Subtile(u64 value, unsigned int x, unsigned int y);
 
+/**
+ * Decodes all texels of an ETC1 subtile at once. Recently decoded subtiles are remembered
+ * per thread, which speeds up atlases and flat regions that repeat the same blocks.
+ */
+void DecodeETC1Subtile(u64 value, ETC1Texels& texels);
+
 } // namespace Pica::Texture